@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Decode the state machine input journal published on openpiste/<piste>/apparatus/diag/input_journal.
+
+Usage:
+  mosquitto_sub -h <broker> -t 'openpiste/+/apparatus/diag/input_journal' -N > journal.bin
+  python3 decode_input_journal.py journal.bin          # timeline
+  python3 decode_input_journal.py journal.bin --csv    # dump as CSV
+
+Each MQTT message is one chunk; a file may hold any number of chunks in a
+row. The format is described in src/InputJournal.h.
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHIII")
+ENTRY = struct.Struct("<IIBB2x")
+
+# InputJournal::Source
+SOURCES = {1: "hit", 2: "sensor", 3: "remote", 4: "cyrano", 5: "cyrano_text",
+           6: "text", 7: "set", 8: "set_clock", 9: "set_uw2f", 10: "hit_time"}
+HIT, TEXT, CYRANO_TEXT, SET_CLOCK, SET_UW2F, HIT_TIME = 1, 6, 5, 8, 9, 10
+# InputJournal::HitTime, the HIT_TIME entries after a hit
+HIT_TIMES = ["published", "contact_l", "contact_r", "lockout"]
+
+
+def load_event_names():
+    """Main event types (top byte) from src/EventDefinitions.h."""
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "src", "EventDefinitions.h")
+    names = {}
+    try:
+        with open(path) as f:
+            for m in re.finditer(r"#define (EVENT_\w+) +0x([0-9a-fA-F]{2})000000\b", f.read()):
+                names.setdefault(int(m.group(2), 16), m.group(1))
+    except OSError:
+        pass
+    return names
+
+
+def chunks(data):
+    """Yield (first_sequence, lost, entries) per chunk; skips bytes between chunks."""
+    pos = 0
+    while True:
+        pos = data.find(b"OIJ1", pos)
+        if pos < 0 or pos + HEADER.size > len(data):
+            return
+        _, header_size, entry_size, first, count, lost = HEADER.unpack_from(data, pos)
+        end = pos + header_size + count * entry_size
+        if end > len(data):
+            sys.exit("truncated chunk at offset %d" % pos)
+        entries = [ENTRY.unpack_from(data, pos + header_size + i * entry_size)[:3]
+                   for i in range(count)]
+        yield first, lost, entries
+        pos = end
+
+
+def describe(source, value, names):
+    if source in (SET_CLOCK, SET_UW2F):
+        return "%d:%02d.%03d" % (value // 60000, value // 1000 % 60, value % 1000)
+    if source in (CYRANO_TEXT, TEXT):
+        return "%d bytes" % value
+    if source == HIT_TIME:
+        return "%u us" % value
+    name = names.get(value >> 24, "0x%02x" % (value >> 24))
+    return "%s 0x%06x" % (name, value & 0xFFFFFF)
+
+
+def decode(data):
+    """Returns a list of (sequence, time_us, source, value, text) in order."""
+    rows = []
+    expected = None
+    text = None
+    hit_time = len(HIT_TIMES)
+    for first, lost, entries in chunks(data):
+        if lost or (expected is not None and first != expected):
+            rows.append((first, None, "lost", lost or (first - expected), None))
+        expected = first + len(entries)
+        for i, (time_us, value, source) in enumerate(entries):
+            if source == CYRANO_TEXT:
+                text = [value, b"", first + i]
+                if value == 0:
+                    rows.append((first + i, time_us, "cyrano_text", 0, ""))
+                    text = None
+            elif source == TEXT and text is not None:
+                text[1] += struct.pack("<I", value)
+                if len(text[1]) >= text[0]:
+                    rows.append((text[2], time_us, "cyrano_text", text[0],
+                                 text[1][:text[0]].decode("latin-1")))
+                    text = None
+                continue
+            if source == HIT:
+                hit_time = 0
+            if source == HIT_TIME and hit_time < len(HIT_TIMES):
+                if value:
+                    # relative to the entry: how long before the state
+                    # machine took the lights in
+                    rel = ((value - time_us + 2**31) % 2**32 - 2**31) / 1e3
+                    rows.append((first + i, time_us, "hit_time", value,
+                                 "%s %+.3f ms" % (HIT_TIMES[hit_time], rel)))
+                hit_time += 1
+                continue
+            if source != CYRANO_TEXT:
+                rows.append((first + i, time_us, SOURCES.get(source, str(source)), value, None))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("journal")
+    parser.add_argument("--csv", action="store_true", help="print CSV instead of a timeline")
+    args = parser.parse_args()
+
+    with open(args.journal, "rb") as f:
+        rows = decode(f.read())
+    names = load_event_names()
+    source_ids = {v: k for k, v in SOURCES.items()}
+
+    if args.csv:
+        print("sequence,time_us,source,value,text")
+        for seq, t, source, value, text in rows:
+            print("%d,%s,%s,0x%08x,%s" % (seq, "" if t is None else t, source, value,
+                                          "" if text is None else '"%s"' % text.replace('"', '""')))
+        return
+
+    start = next((t for _, t, _, _, _ in rows if t is not None), 0)
+    for seq, t, source, value, text in rows:
+        if t is None:
+            print("%8d  ---- %d entries lost ----" % (seq, value))
+            continue
+        # times are the low 32 bits of esp_timer_get_time(); make them relative
+        rel = ((t - start) % 2**32) / 1e6
+        if text is not None:
+            detail = text
+        else:
+            detail = describe(source_ids.get(source, 0), value, names)
+        print("%8d %10.3f s  %-11s %s" % (seq, rel, source, detail))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Decode a raw ADC capture published on openpiste/<piste>/apparatus/diag/raw_capture.
+
+Usage:
+  mosquitto_sub -h <broker> -t 'openpiste/+/apparatus/diag/raw_capture' -C 1 > capture.bin
+  python3 decode_raw_capture.py capture.bin            # plot (needs matplotlib)
+  python3 decode_raw_capture.py capture.bin --csv      # dump as CSV
+
+The format is described in src/RawCapture.h.
+"""
+import argparse
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHIIIB3x")
+SAMPLE = struct.Struct("<IHBB")
+
+WEAPONS = {0: "foil", 1: "epee", 2: "sabre"}
+# ADC1 channel -> line, see src/hardwaredefinition.h
+CHANNELS = {0: "cl", 3: "bl", 4: "br", 6: "piste", 7: "cr"}
+# Direction/value bits, see src/FastGPIOSettings.h
+PINS = ["al", "bl", "cl", "ar", "br", "cr", "piste"]
+
+
+def probe_name(direction, values, channel):
+    driven = [PINS[i] for i in range(7) if not direction & (1 << i) and values & (1 << i)]
+    return "%s->%s" % ("+".join(driven) or "gnd", CHANNELS.get(channel, "ch%d" % channel))
+
+
+def decode(data):
+    magic, header_size, sample_size, count, trigger_index, trigger_us, weapon = \
+        HEADER.unpack_from(data, 0)
+    if magic != b"ORC1":
+        sys.exit("not a raw capture (magic %r)" % magic)
+    samples = []
+    for i in range(count):
+        t, raw, direction, values = SAMPLE.unpack_from(data, header_size + i * sample_size)
+        channel = raw >> 12
+        # times are the low 32 bits of esp_timer_get_time(); make them relative
+        rel = ((t - trigger_us + 2**31) % 2**32) - 2**31
+        samples.append((rel, probe_name(direction, values, channel), raw & 0x0FFF))
+    return WEAPONS.get(weapon, "unknown"), trigger_index, samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture")
+    parser.add_argument("--csv", action="store_true", help="print CSV instead of plotting")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        weapon, trigger_index, samples = decode(f.read())
+
+    if args.csv:
+        print("time_us,probe,raw")
+        for rel, name, raw in samples:
+            print("%d,%s,%d" % (rel, name, raw))
+        return
+
+    import matplotlib.pyplot as plt
+
+    traces = {}
+    for rel, name, raw in samples:
+        traces.setdefault(name, ([], []))
+        traces[name][0].append(rel / 1000.0)
+        traces[name][1].append(raw)
+    for name, (t, v) in sorted(traces.items()):
+        plt.step(t, v, where="post", label=name)
+    plt.axvline(0, color="k", linestyle="--", label="hit")
+    plt.xlabel("ms relative to hit")
+    plt.ylabel("raw ADC")
+    plt.title("%s, %d samples (trigger at #%d)" % (weapon, len(samples), trigger_index))
+    plt.legend(fontsize="small")
+    plt.show()
+
+
+if __name__ == "__main__":
+    main()
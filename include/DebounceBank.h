@@ -0,0 +1,97 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// N DebounceTimer channels stored as arrays instead of N separate objects.
+//
+// Each channel behaves like a DebounceTimer: isOK() becomes true once its
+// condition has been true for required_us without interruption. Channels are
+// identified by index (0..N-1, N <= 32); DEBOUNCE_BIT(ch) builds masks.
+//
+// The mask form of update() feeds several channels in one pass: channels
+// whose condition dropped are cleared with two mask operations, only the
+// channels whose condition holds touch their start/required arrays.
+#define DEBOUNCE_BIT(ch) (1u << (ch))
+
+template <size_t N> class DebounceBank {
+  static_assert(N <= 32, "DebounceBank holds at most 32 channels");
+
+public:
+  DebounceBank() {
+    for (size_t i = 0; i < N; i++) {
+      start_[i] = 0;
+      required_[i] = 0;
+      margin_[i] = 0;
+    }
+  }
+
+  // Update every channel in channels with its bit of conditions, at tick
+  // time now. Returns the isOK() bits of all channels.
+  uint32_t update(uint32_t channels, uint32_t conditions, int64_t now) {
+    uint32_t dropped = channels & ~conditions;
+    running_ &= ~dropped;
+    ok_ &= ~dropped;
+
+    uint32_t held = channels & conditions;
+    uint32_t starting = held & ~running_;
+    running_ |= starting;
+    for (uint32_t m = starting; m; m &= m - 1)
+      start_[__builtin_ctz(m)] = now;
+    for (uint32_t m = held; m; m &= m - 1) {
+      int ch = __builtin_ctz(m);
+      if (now - start_[ch] >= required_[ch])
+        ok_ |= DEBOUNCE_BIT(ch);
+      else
+        ok_ &= ~DEBOUNCE_BIT(ch);
+    }
+    return ok_;
+  }
+
+  // Single channel form, same semantics as DebounceTimer::update().
+  bool update(int ch, bool condition, int64_t now) {
+    return update(DEBOUNCE_BIT(ch), condition ? DEBOUNCE_BIT(ch) : 0, now) &
+           DEBOUNCE_BIT(ch);
+  }
+
+  bool isOK(int ch) const { return ok_ & DEBOUNCE_BIT(ch); }
+  uint32_t ok() const { return ok_; }
+  // Tick time of the start of the current contact, 0 if none
+  int64_t startTime(int ch) const {
+    return (running_ & DEBOUNCE_BIT(ch)) ? start_[ch] : 0;
+  }
+
+  // Stop the channel without waiting for the condition to drop. Like
+  // DebounceTimer::reset(), this also re-arms the Dos Santos margin but keeps
+  // the (possibly reduced) threshold.
+  void reset(int ch) { resetMask(DEBOUNCE_BIT(ch)); }
+  void reset(int ch, int64_t us) {
+    reset(ch);
+    required_[ch] = us;
+  }
+  void resetMask(uint32_t channels) {
+    running_ &= ~channels;
+    ok_ &= ~channels;
+    dosSantosApplied_ &= ~channels;
+  }
+
+  void setRequiredUs(int ch, int64_t us) { required_[ch] = us; }
+  void setDosSantosMarginUs(int ch, int64_t us) { margin_[ch] = us; }
+  void applyDosSantosMarginUs(int ch, int64_t now, bool Update = true) {
+    if (!(dosSantosApplied_ & DEBOUNCE_BIT(ch))) {
+      required_[ch] -= margin_[ch];
+      if (Update) {
+        update(ch, true, now);
+      }
+      dosSantosApplied_ |= DEBOUNCE_BIT(ch);
+    }
+  }
+
+private:
+  uint32_t running_ = 0; // condition currently held, start_ is valid
+  uint32_t ok_ = 0;
+  uint32_t dosSantosApplied_ = 0;
+  int64_t start_[N];
+  int64_t required_[N];
+  int64_t margin_[N];
+};
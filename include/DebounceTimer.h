@@ -1,14 +1,14 @@
 #pragma once
-#include <esp_timer.h>
 #include <stdint.h>
 
 class DebounceTimer {
 public:
   DebounceTimer() : start_time_(0), last_ok_(false) {}
 
-  // Call this every loop with your condition
-  bool update(bool condition) {
-    int64_t now = esp_timer_get_time();
+  // Call this every loop with your condition. now is the caller's tick time
+  // (esp_timer_get_time()), so every debouncer in one scan sees the same
+  // instant.
+  bool update(bool condition, int64_t now) {
     if (condition) {
       if (start_time_ == 0)
         start_time_ = now;
@@ -22,6 +22,8 @@ public:
     }
   }
   bool isOK() const { return last_ok_; }
+  // esp_timer_get_time() of the start of the current contact, 0 if none
+  int64_t startTime() const { return start_time_; }
 
   // Reset the timer
   // This is useful if you want to stop the timer without waiting for the full
@@ -37,11 +39,11 @@ public:
   }
   void setRequiredUs(int64_t us) { required_us_ = us; }
   void setDosSantosMarginUs(int64_t us) { DosSantosMargin_ = us; }
-  void applyDosSantosMarginUs(bool Update = true) {
+  void applyDosSantosMarginUs(int64_t now, bool Update = true) {
     if (!DosSantosApplied_) {
       required_us_ -= DosSantosMargin_;
       if (Update) {
-        update(true);
+        update(true, now);
       }
       DosSantosApplied_ = true;
     }
@@ -60,10 +62,8 @@ public:
   DoubleDebouncer()
       : current_state_(WAITING_ON), start_time_(0), last_ok_(false) {}
 
-  // Call this every loop with your condition
-  bool update(bool condition) {
-    int64_t now = esp_timer_get_time();
-
+  // Call this every loop with your condition and the caller's tick time
+  bool update(bool condition, int64_t now) {
     switch (current_state_) {
     case WAITING_ON:
       if (condition) {
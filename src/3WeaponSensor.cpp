@@ -1,255 +1,39 @@
 // Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
 #include "3WeaponSensor.h"
-#include "FlashWriteGuard.h"
-#include "driver/adc.h"
-#include "driver/gpio.h"
-#include "soc/sens_reg.h"
-#include "soc/sens_struct.h"
-
-#include "FastADC1.h"
-#include "TimeScoreDisplay.h"
-#include "WS2812BLedStrip.h"
-#include "adc_calibrator.h"
-#include "driver/gpio.h" // Required for gpio_pad_select_gpio()
-#include "driver/rtc_io.h"
-#include "esp_log.h"
-#include "esp_task_wdt.h"
-#include "esp_timer.h"
-#include "soc/io_mux_reg.h" // For IO_MUX register definitions
-#include <Preferences.h>
-#include <driver/rtc_io.h>
-#include <iostream>
-// ResistorDividerCalibrator calibrator;
+#include "EventDefinitions.h"
 #include "FastGPIOSettings.h"
+#include "RawCapture.h"
 #include "ResistorSetting.h"
-#include "adc_calibrator.h"
 
-// #define adc1_get_raw FastADC1::read
-
-static const char *CORE_SCORING_MACHINE_TAG = "Core Scoring machine";
-/*float MultiWeaponSensor::GetVcc() {
-  Set_IODirectionAndValue(IODirection_br_br, IOValues_br_br);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  return esp_adc_cal_raw_to_voltage(tempADValue, &adc_chars) / 1000.0f;
-}
-*/
-ResistorDividerCalibrator MyCalibrator;
-void MultiWeaponSensor::initializeResistorThresholds() {
-  // MyCalibrator.begin((adc1_channel_t)br_analog, (adc1_channel_t)cr_analog);
-  bool success = true;
-  if ((!MyCalibrator.begin((adc1_channel_t)br_analog,
-                           (adc1_channel_t)cr_analog)) &&
-      (ForceThresholdCalibration)) {
-    printf("\nCalibration will be done on the connector of the right fencer "
-           "(Left on view from the back, Green light\n");
-    printf("The calibration will be done in 2 phases.\n");
-    printf("If both are successful, the results will be stored in flash.\n");
-    printf("First phase: between the outer pins\n");
-    printf("    O          0     0     \n");
-    printf("    |                |     \n");
-    printf("    ______  100 Ω ____     \n");
-    success &= MyCalibrator.calibrate_interactively(98.0);
-    Set_IODirectionAndValue(IODirection_ar_cr, IOValues_ar_cr);
-    printf("Second phase: between the central and close pin\n");
-    printf("Connect the correct pins before continuing!\n");
-    printf("    O          0     0     \n");
-    printf("               |     |    \n");
-    printf("                100 Ω      \n");
-    if (success) {
-      success &= MyCalibrator.calibrate_r1_only(98.0);
-    }
-    // Only save result is calibration was successful
-    if (success) {
-      MyCalibrator.save_calibration_to_nvs(CALIBRATION_VERSION);
-    }
-  }
-  MyCalibrator.set_default_calibration();
-  constexpr int sdev = 7;
-  // During calibration we have measured a sdev of 6-7 ADC raw units (constant
-  // over the entire range) I'm not adding extra correction factors here. These
-  // are just the calculated thresholds for a given R If you need margin, add it
-  // either by using a different resistor value, or by adding margin in the
-  // comparison code itself, such that it is done in the right direction Values
-  // for Epee It is important to verify the real values, and compare to the
-  // programmed ones.
-
-  AxXy_160_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(160);
-  AxXy_250_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(250);
-
-  // Values for Sabre
-  AxXy_280_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(280);
-  BxCy_200_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(220);
-
-  BxCy_280_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(280);
-  // Values for Foil
-  AxXy_125_Ohm =
-      MyCalibrator.get_adc_threshold_for_resistance_Tip(125); // Hit on Guard
-  AxXy_200_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(200);
-  AxXy_300_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(
-      300); // Normally closed circuit up to 300 Ohm
-  AxXy_430_Ohm =
-      MyCalibrator.get_adc_threshold_for_resistance_Tip(430); // Colored lights
-  AxXy_450_Ohm =
-      MyCalibrator.get_adc_threshold_for_resistance_Tip(450); // Hit on Piste
-  BxCy_450_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(
-      450); // Yellow lights
-}
-
-constexpr int scanloop_us = 150;
-// #define MEASURE_TIMING
-
-#ifndef MEASURE_TIMING
-// Timer callback (runs in timer task context, not ISR)
-void scan_timer_callback(void *arg) {
-  MultiWeaponSensor &MyLocalSensor = MultiWeaponSensor::getInstance();
-  MyLocalSensor.DoFullScan();
-  vTaskDelay(0);
-}
-#else
-void scan_timer_callback(void *arg) {
-  static int64_t last_time = 0;
-  static int errorcounter = 0;
-  int64_t now = esp_timer_get_time();
-  if (last_time != 0) {
-    int64_t dt = now - last_time;
-    if (dt > scanloop_us + 50) {
-      errorcounter++;
-      if (errorcounter > 1) {
-        Serial.printf("Interval: %lld us\n", dt);
-        errorcounter = 0;
-      }
-    }
-  }
-  last_time = now;
-
-  MultiWeaponSensor &MyLocalSensor = MultiWeaponSensor::getInstance();
-  MyLocalSensor.DoFullScan();
-  vTaskDelay(0);
-}
-#endif
+// The scan itself. Setup, calibration and the scan timer are in
+// SensorPlatform.cpp; this file and foil.cpp, epee.cpp and sabre.cpp only
+// reach the hardware through FastGPIOSettings.h, FastADC1.h and
+// SensorPlatform.h.
 
 MultiWeaponSensor::MultiWeaponSensor() {
   // ctor
 
   // Init long debouncers
-  DebounceLong_b1.setRequiredUs(2500000);
-  DebounceLong_b2.setRequiredUs(2500000);
-  DebounceLong_c1.setRequiredUs(2500000);
-  DebounceLong_c2.setRequiredUs(2500000);
-  DebounceLong_al_cr.setRequiredUs(2500000);
-  DebounceLong_ar_cl.setRequiredUs(2500000);
-  DebounceLong_al_cl.setRequiredUs(2500000);
-  DebounceLong_ar_cr.setRequiredUs(2500000);
-
-  Debounce_NotConnected.setRequiredUs(120000000);
-  Debounce_AtLeastOneNotConnected.setRequiredUs(10000000);
-  gpio_pad_select_gpio(GPIO_NUM_33); // Route pin to GPIO (not peripheral)
-  gpio_set_direction(GPIO_NUM_33, GPIO_MODE_INPUT_OUTPUT);
-}
-
-void MultiWeaponSensor::begin() {
-  Preferences mypreferences;
-  {
-    FlashWriteGuard guard; // enable brownout detection while NVS may write
-    mypreferences.begin("scoringdevice", false);
-    LightsDuration = mypreferences.getInt("LIGHTS_MS", 0);
-    if (!LightsDuration) {
-      mypreferences.putInt("LIGHTS_MS", LIGHTS_DURATION_MS);
-      LightsDuration = LIGHTS_DURATION_MS;
-    }
-    ForceThresholdCalibration = mypreferences.getBool("ForceCal", false);
-    uint8_t storedweapon = mypreferences.getUChar("START_WEAPON", 99);
-    if (99 == storedweapon) {
-      mypreferences.putUChar("START_WEAPON", 0);
-      storedweapon = 0;
-    }
-    switch (storedweapon) {
-    case 0:
-      m_ActualWeapon = FOIL;
-      break;
+  m_Debounce.setRequiredUs(DB_LONG_AL_CR, 2500000);
+  m_Debounce.setRequiredUs(DB_LONG_AR_CL, 2500000);
+  m_Debounce.setRequiredUs(DB_LONG_AL_CL, 2500000);
+  m_Debounce.setRequiredUs(DB_LONG_AR_CR, 2500000);
 
-    case 1:
-      m_ActualWeapon = EPEE;
-      break;
-
-    case 2:
-      m_ActualWeapon = SABRE;
-      break;
-    default:
-      m_ActualWeapon = EPEE;
-    }
-    mypreferences.end();
-  } // guard destroyed here: brownout detection disabled again
-
-  adc1_fast_register_channel(ADC1_CHANNEL_0);
-  adc1_fast_register_channel(ADC1_CHANNEL_3);
-  adc1_fast_register_channel(ADC1_CHANNEL_4);
-  adc1_fast_register_channel(ADC1_CHANNEL_6);
-  adc1_fast_register_channel(ADC1_CHANNEL_7);
-
-  adc1_fast_begin_unsafe();
-  gpio_reset_pin(GPIO_NUM_33); // Reset function to digital
-  gpio_set_direction(GPIO_NUM_33, GPIO_MODE_OUTPUT);
-  gpio_set_level(GPIO_NUM_33, 0); // or 1, as needed
-  gpio_reset_pin(GPIO_NUM_2);     // Reset function to digital
-  gpio_set_direction(GPIO_NUM_2, GPIO_MODE_INPUT);
-
-  Set_IODirectionAndValue(IODirection_br_cr, IOValues_br_cr);
-  printf("\nI'm going to initialize the resistorThresholds\n");
-  initializeResistorThresholds();
-  printf("\nresistorThresholds initialized\n");
-  // int fast_raw = fast_adc1_get_raw(ADC1_CHANNEL_3);
-  /*int64_t t0 = esp_timer_get_time();
-  volatile int sum1 = 0;
-  int samples = 10000; // Number of samples to take
-  FullScanCounter = 1;
-  for (int i = 0; i < samples; ++i) {
-    if (FullScanCounter)
-      FullScanCounter--;
-    else
-      FullScanCounter = SABRE_SCANCOUNTER_INIT;
-    DoFoil();
-  }
-  // fast_adc1_get_raw_inline(ADC1_CHANNEL_6);
-  int64_t t1 = esp_timer_get_time();
-  printf("Total time: %lld us\n", t1 - t0);
-  printf("Total samples: %d\n", samples);
-  printf("Average time per sample: %lld us\n", (t1 - t0) / samples);*/
-  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100,
-                           &adc_chars);
-  DoReset();
-
-  // Timer config
-  const esp_timer_create_args_t scan_timer_args = {
-      .callback = &scan_timer_callback,
-      .arg = nullptr,
-      .dispatch_method =
-          ESP_TIMER_TASK, // Use ESP_TIMER_TASK for longer callbacks
-      .name = "scan_timer"};
-  esp_timer_create(&scan_timer_args, &m_scan_timer);
-  // calibrator.begin(ADC1_CHANNEL_6);
-  // calibrator.calibrate_interactively(ADC1_CHANNEL_6);
+  m_Debounce.setRequiredUs(DB_NOT_CONNECTED, 120000000);
+  m_Debounce.setRequiredUs(DB_AT_LEAST_ONE_NOT_CONNECTED, 10000000);
 }
 
-void MultiWeaponSensor::start() {
-  esp_timer_start_periodic(m_scan_timer, scanloop_us); // 250 us interval
-}
-
-adc1_channel_t ADC1_CHANNELS[] = {
-    ADC1_CHANNEL_0, ADC1_CHANNEL_1, ADC1_CHANNEL_2, ADC1_CHANNEL_3,
-    ADC1_CHANNEL_4, ADC1_CHANNEL_5, ADC1_CHANNEL_6, ADC1_CHANNEL_7};
-
 MultiWeaponSensor::~MultiWeaponSensor() {
   // dtor
 }
 
 void MultiWeaponSensor::HandleLights() {
   uint32_t temp = 0;
-  if (millis() >
+  if (m_ScanNowUs >
       ShortIndicatorsDebouncer) // this is needed to avoid too many events for
                                 // broken wires or bad mass contacts
   {
-    ShortIndicatorsDebouncer = millis() + 233;
+    ShortIndicatorsDebouncer = m_ScanNowUs + 233000;
     if (OrangeL)
       temp |= 0x20;
     if (OrangeR)
@@ -288,8 +72,18 @@ void MultiWeaponSensor::HandleLights() {
   }
 
   if (Lights != temp) { // only send on change
-    Lights = temp;
-    SensorStateChanged(EVENT_LIGHTS | temp);
+    if (temp & ~Lights & (MASK_RED | MASK_GREEN | MASK_WHITE_L | MASK_WHITE_R))
+      RawCapture::trigger(m_ActualWeapon);
+    HitEvent event = {EVENT_LIGHTS | temp, m_ScanNowUs,
+                      m_ContactStartLeftUs, m_ContactStartRightUs,
+                      m_LockoutUs};
+    // If the ring is full Lights keeps its old value, so the next scan
+    // retries instead of losing the change.
+    if (m_HitEvents.push(event)) {
+      Lights = temp;
+      if (m_HitEventTask)
+        SensorNotify(m_HitEventTask);
+    }
   }
 }
 
@@ -301,20 +95,23 @@ bool MultiWeaponSensor::OKtoReset() {
     //  sec
     switch (m_ActualWeapon) {
     case FOIL:
-      TimeToReset = millis() + LightsDuration - FOIL_LOCK_TIME;
+      TimeToReset =
+          m_ScanNowUs + (int64_t)(LightsDuration - FOIL_LOCK_TIME) * 1000;
       break;
 
     case EPEE:
-      TimeToReset = millis() + LightsDuration - EPEE_LOCK_TIME;
+      TimeToReset =
+          m_ScanNowUs + (int64_t)(LightsDuration - EPEE_LOCK_TIME) * 1000;
       break;
 
     case SABRE:
-      TimeToReset = millis() + LightsDuration - SABRE_LOCK_TIME;
+      TimeToReset =
+          m_ScanNowUs + (int64_t)(LightsDuration - SABRE_LOCK_TIME) * 1000;
       break;
     }
     return false;
   }
-  if (millis() > TimeToReset) {
+  if (m_ScanNowUs > TimeToReset) {
     if (Buzz == false) {
       return (true);
     }
@@ -322,7 +119,7 @@ bool MultiWeaponSensor::OKtoReset() {
     // BUZZPIN = false;
     Buzz = false;
     /* here comes the extra time if you want to wait longer than 2 sec */
-    TimeToReset = millis() + 500;
+    TimeToReset = m_ScanNowUs + 500000;
   }
   return (false);
 }
@@ -335,6 +132,9 @@ void MultiWeaponSensor::DoReset() {
   Green = false;
   Red = false;
   Buzz = false;
+  m_ContactStartLeftUs = 0;
+  m_ContactStartRightUs = 0;
+  m_LockoutUs = 0;
   HandleLights();
   MaybeSignalRight = false;
   MaybeSignalLeft = false;
@@ -351,26 +151,26 @@ void MultiWeaponSensor::DoReset() {
   switch (m_ActualWeapon) {
   case FOIL:
 
-    Debounce_b1.reset(FoilContactTime_us); // 14ms for foil
-    Debounce_b2.reset(FoilContactTime_us);
-    Debounce_c1.reset(Foil_LameLeak_us);
-    Debounce_c2.reset(Foil_LameLeak_us);
+    m_Debounce.reset(DB_B1, FoilContactTime_us); // 14ms for foil
+    m_Debounce.reset(DB_B2, FoilContactTime_us);
+    m_Debounce.reset(DB_C1, Foil_LameLeak_us);
+    m_Debounce.reset(DB_C2, Foil_LameLeak_us);
 
     break;
 
   case EPEE:
 
-    Debounce_c1.reset(EpeeContactTime_us); // 6 ms for epee
-    Debounce_c2.reset(EpeeContactTime_us); // 6 ms for epee
-    Debounce_c1.setDosSantosMarginUs(Epee_DosSantosCorrection_us);
-    Debounce_c2.setDosSantosMarginUs(Epee_DosSantosCorrection_us);
+    m_Debounce.reset(DB_C1, EpeeContactTime_us); // 6 ms for epee
+    m_Debounce.reset(DB_C2, EpeeContactTime_us); // 6 ms for epee
+    m_Debounce.setDosSantosMarginUs(DB_C1, Epee_DosSantosCorrection_us);
+    m_Debounce.setDosSantosMarginUs(DB_C2, Epee_DosSantosCorrection_us);
 
     break;
 
   case SABRE:
 
-    Debounce_c1.reset(SabreContactTime_us);
-    Debounce_c2.reset(SabreContactTime_us);
+    m_Debounce.reset(DB_C1, SabreContactTime_us);
+    m_Debounce.reset(DB_C2, SabreContactTime_us);
     Debounce_SabreWhite_l.setRequiredOnUs(SabreWhiteTime_us); // 2ms
     Debounce_SabreWhite_l.setRequiredOffUs(1000000);          // 1s
     Debounce_SabreWhite_l.reset();
@@ -398,19 +198,24 @@ void MultiWeaponSensor::DoReset() {
 void MultiWeaponSensor::StartLock(int TimeToLock) {
   if (!LockStarted) {
     LockStarted = true;
-    TimeOfLock = millis() + TimeToLock;
+    m_LockoutUs = m_ScanNowUs + (int64_t)TimeToLock * 1000;
   }
 }
 
 bool MultiWeaponSensor::IsLocked() {
   if (LockStarted) {
-    if (millis() > TimeOfLock)
+    if (m_ScanNowUs > m_LockoutUs)
       return true;
   }
   return false;
 }
 
-void MultiWeaponSensor::DoFullScan() {
+void MultiWeaponSensor::DoFullScan(int64_t now) {
+  // One timestamp for the whole scan: every debouncer and detector below
+  // reads m_ScanNowUs instead of the timer.
+  m_ScanNowUs = now;
+  ApplyRequests();
+
   // allow external charges to flow to gnd
   Set_IODirectionAndValue(0, 0);
 
@@ -418,10 +223,11 @@ void MultiWeaponSensor::DoFullScan() {
 
   if (m_ActualWeapon != temp) {
     m_ActualWeapon = temp;
+    SelectWeaponScan();
     bPreventBuzzer = false;
     SensorStateChanged(EVENT_WEAPON | temp);
     DoReset();
-    vTaskDelay(0);
+    SensorYield();
   }
 
   if (IsLocked()) {
@@ -433,32 +239,61 @@ void MultiWeaponSensor::DoFullScan() {
       DoReset();
     }
 
-    vTaskDelay(0);
+    SensorYield();
   } else {
     CurrentParryState = Debounce_Parry.isOK();
   }
   HandleLights();
 
-  switch (m_ActualWeapon) {
-  case FOIL:
-    DoFoil();
-    break;
+  (this->*m_DoWeaponScan)();
+}
 
-  case EPEE:
-    DoEpee();
-    break;
+// Indexed by weapon_t. Switching weapon only swaps m_DoWeaponScan, so
+// DoFullScan does not branch on the weapon.
+static const MultiWeaponSensor::WeaponScanFn WeaponScans[] = {
+    &MultiWeaponSensor::DoFoil, &MultiWeaponSensor::DoEpee,
+    &MultiWeaponSensor::DoSabre, &MultiWeaponSensor::DoIdleScan};
+static_assert(sizeof(WeaponScans) / sizeof(WeaponScans[0]) == UNKNOWN + 1,
+              "one scan function per weapon_t");
+
+// Runs on the scan task only (or in begin(), before the scan timer exists):
+// the scan function and m_Scan must not change under a running scan.
+void MultiWeaponSensor::SelectWeaponScan() {
+  if ((size_t)m_ActualWeapon < sizeof(WeaponScans) / sizeof(WeaponScans[0]))
+    m_DoWeaponScan = WeaponScans[m_ActualWeapon];
+  else
+    m_DoWeaponScan = &MultiWeaponSensor::DoIdleScan;
+  m_Scan = WeaponScanState();
+}
 
-  case SABRE:
-    DoSabre();
-    break;
+// Weapon UNKNOWN: no probes run and no lights come on. In AUTO detection
+// GetWeapon() falls back to epee, where automatic detection starts, on the
+// next scan; in MANUAL the sensor stays idle until a weapon is set.
+void MultiWeaponSensor::DoIdleScan() { m_ScanDebouncing = false; }
+
+// Weapon, detection mode and reset requested by other tasks (state machine,
+// Cyrano) since the previous scan. Running them here keeps the scan state,
+// the weapon scan function and the HitEvent ring owned by the scan task.
+void MultiWeaponSensor::ApplyRequests() {
+  uint32_t requests = m_Requests.exchange(0, std::memory_order_acquire);
+  if (!requests)
+    return;
+  if (requests & REQUEST_MODE)
+    m_DectionMode = (weapon_detection_mode_t)((requests & REQUEST_MODE_MASK) >>
+                                              REQUEST_MODE_SHIFT);
+  if (requests & REQUEST_WEAPON) {
+    m_ActualWeapon = (weapon_t)(requests & REQUEST_WEAPON_MASK);
+    SelectWeaponScan();
   }
+  if (requests & (REQUEST_WEAPON | REQUEST_RESET))
+    DoReset();
 }
 
 void MultiWeaponSensor::resetLongDebouncers() {
-  DebounceLong_al_cl.reset();
-  DebounceLong_al_cr.reset();
-  DebounceLong_ar_cl.reset();
-  DebounceLong_ar_cr.reset();
+  m_Debounce.reset(DB_LONG_AL_CL);
+  m_Debounce.reset(DB_LONG_AL_CR);
+  m_Debounce.reset(DB_LONG_AR_CL);
+  m_Debounce.reset(DB_LONG_AR_CR);
   LongHitDetector_.reset();
   DoubleHitDetector_.reset();
   printf("Long counters reset\n");
@@ -469,21 +304,23 @@ weapon_t MultiWeaponSensor::GetWeapon() {
   if (m_ActualWeapon !=
       EPEE) { // In foil or sabre: check if both sides are disconnected
     if (NotConnectedRight || NotConnectedLeft) {
-      bPreventBuzzer = Debounce_AtLeastOneNotConnected.update(true);
+      bPreventBuzzer =
+          m_Debounce.update(DB_AT_LEAST_ONE_NOT_CONNECTED, true, m_ScanNowUs);
 
       if (NotConnectedRight && NotConnectedLeft) {
-        Debounce_NotConnected.update(true);
+        m_Debounce.update(DB_NOT_CONNECTED, true, m_ScanNowUs);
 
       } else {
-        Debounce_NotConnected.reset();
+        m_Debounce.reset(DB_NOT_CONNECTED);
         bPreventBuzzer = false;
       }
-      if (Debounce_NotConnected.isOK()) // We've reached zero, so we switch back
-                                        // to default Epee
+      if (m_Debounce.isOK(
+              DB_NOT_CONNECTED)) // We've reached zero, so we switch back
+                                 // to default Epee
       {
 
         bPreventBuzzer = false;
-        Debounce_AtLeastOneNotConnected.reset();
+        m_Debounce.reset(DB_AT_LEAST_ONE_NOT_CONNECTED);
         if (m_DectionMode != MANUAL) {
           m_DetectedWeapon = EPEE;
 
@@ -494,7 +331,7 @@ weapon_t MultiWeaponSensor::GetWeapon() {
       NotConnectedRight = false;
       NotConnectedLeft = false;
       bPreventBuzzer = false;
-      Debounce_AtLeastOneNotConnected.update(false);
+      m_Debounce.update(DB_AT_LEAST_ONE_NOT_CONNECTED, false, m_ScanNowUs);
     }
   }
   if (m_DectionMode == MANUAL) {
@@ -509,9 +346,9 @@ weapon_t MultiWeaponSensor::GetWeapon() {
   case FOIL:
     // if (ax-cx) & !(ax-bx) -> switch to epee
 
-    if ((DebounceLong_al_cl.isOK()) &&
-        (DebounceLong_ar_cr.isOK())) { // certainly not foil anymore)
-      if ((Debounce_b1.isOK()) && (Debounce_b2.isOK())) {
+    if ((m_Debounce.isOK(DB_LONG_AL_CL)) &&
+        (m_Debounce.isOK(DB_LONG_AR_CR))) { // certainly not foil anymore)
+      if ((m_Debounce.isOK(DB_B1)) && (m_Debounce.isOK(DB_B2))) {
         m_DetectedWeapon = EPEE;
         bPreventBuzzer = false;
         resetLongDebouncers();
@@ -519,8 +356,9 @@ weapon_t MultiWeaponSensor::GetWeapon() {
     }
     // if (bx-cy) && (ax-bx) -> switch to sabre
     else {
-      if ((DebounceLong_al_cr.isOK()) && (DebounceLong_ar_cl.isOK())) {
-        if ((!Debounce_b1.isOK()) && (!Debounce_b2.isOK())) {
+      if ((m_Debounce.isOK(DB_LONG_AL_CR)) &&
+          (m_Debounce.isOK(DB_LONG_AR_CL))) {
+        if ((!m_Debounce.isOK(DB_B1)) && (!m_Debounce.isOK(DB_B2))) {
           m_DetectedWeapon = SABRE;
           resetLongDebouncers();
           bPreventBuzzer = false;
@@ -536,18 +374,18 @@ weapon_t MultiWeaponSensor::GetWeapon() {
     // if (ax-cy) & !(ax-bx) -> switch to foil
     // if (ax-cy) & (ax-by) -> switch to sabre
     // keep epee
-    if ((DebounceLong_al_cr.isOK()) &&
-        (DebounceLong_ar_cl.isOK())) { // certainly not epee anymore)
+    if ((m_Debounce.isOK(DB_LONG_AL_CR)) &&
+        (m_Debounce.isOK(DB_LONG_AR_CL))) { // certainly not epee anymore)
       if ((OrangeR) && (OrangeL)) {
         m_DetectedWeapon = SABRE;
         bPreventBuzzer = false;
-        Debounce_NotConnected.reset();
+        m_Debounce.reset(DB_NOT_CONNECTED);
         resetLongDebouncers();
 
       } else {
         m_DetectedWeapon = FOIL;
         bPreventBuzzer = false;
-        Debounce_NotConnected.reset();
+        m_Debounce.reset(DB_NOT_CONNECTED);
         resetLongDebouncers();
       }
 
@@ -562,14 +400,16 @@ weapon_t MultiWeaponSensor::GetWeapon() {
     // keep sabre
     {
 
-      if ((DebounceLong_ar_cl.isOK()) && (DebounceLong_al_cr.isOK())) {
+      if ((m_Debounce.isOK(DB_LONG_AR_CL)) &&
+          (m_Debounce.isOK(DB_LONG_AL_CR))) {
         if (WhiteR && WhiteL) {
           m_DetectedWeapon = FOIL;
           bPreventBuzzer = false;
           resetLongDebouncers();
         }
       }
-      if ((DebounceLong_ar_cr.isOK()) && (DebounceLong_al_cl.isOK())) {
+      if ((m_Debounce.isOK(DB_LONG_AR_CR)) &&
+          (m_Debounce.isOK(DB_LONG_AL_CL))) {
         if (WhiteR && WhiteL) {
           m_DetectedWeapon = EPEE;
           bPreventBuzzer = false;
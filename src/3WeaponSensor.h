@@ -1,16 +1,19 @@
 // Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
 #ifndef WEAPONSENSOR_H
 #define WEAPONSENSOR_H
+#include "DebounceBank.h"
 #include "DebounceTimer.h"
 #include "DoubleHitDetector.h"
 #include "LongHitDetector.h"
+#include "ScanTimingStats.h"
+#include "SensorPlatform.h"
 #include "Singleton.h"
+#include "SpscRing.h"
 #include "SubjectObserverTemplate.h"
 #include "TimingConstants.h"
-#include "esp_adc_cal.h"
 #include "hardwaredefinition.h"
 #include "weaponenum.h"
-#include <Arduino.h>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
@@ -20,12 +23,16 @@
 // enum weapon_t {FOIL, EPEE, SABRE, UNKNOWN};
 enum weapon_detection_mode_t { MANUAL, AUTO, HYBRID };
 
-typedef struct MeasurementCtlStruct {
-  uint8_t IODirection;
-  uint8_t IOValues;
-  uint8_t ADChannel;
-  int ADThreashold;
-} MeasurementCtl;
+// A change of the sensor lights, handed from the sensor (esp_timer task) to the
+// state machine through a lock-free ring. Times are esp_timer_get_time() in µs,
+// 0 when not applicable.
+struct HitEvent {
+  uint32_t event;           // EVENT_LIGHTS | lights bitmask
+  int64_t time_us;          // when the sensor published this lights state
+  int64_t contact_left_us;  // start of the contact that gave the left hit
+  int64_t contact_right_us; // start of the contact that gave the right hit
+  int64_t lockout_us;       // first hit + weapon lock time
+};
 
 class MultiWeaponSensor : public Subject<MultiWeaponSensor>,
                           public SingletonMixin<MultiWeaponSensor> {
@@ -44,9 +51,10 @@ public:
   /** Set m_ActualWeapon
    * \param val New value to set
    */
+  // Takes effect at the start of the next scan: the scan task switches the
+  // weapon and resets, so it stays the only task that pushes HitEvents.
   void SetActualWeapon(weapon_t val) {
-    m_ActualWeapon = val;
-    DoReset();
+    PostRequest(REQUEST_WEAPON | val, REQUEST_WEAPON | REQUEST_WEAPON_MASK);
   }
   /** Access m_DetectedWeapon
    * \return The current value of m_DetectedWeapon
@@ -56,8 +64,10 @@ public:
   void DoSabre();
   void DoEpee(void);
   void DoFoil(void);
+  void DoIdleScan();
   void Skip_phase();
-  void DoFullScan();
+  void DoFullScan(int64_t now);
+  typedef void (MultiWeaponSensor::*WeaponScanFn)();
   bool Wait_For_Next_Timer_Tick();
   uint32_t get_Lights() { return Lights; };
   void BlockAllNewHits() {
@@ -68,8 +78,11 @@ public:
     SignalLeft = false;
     SignalRight = false;
   };
+  // Like SetActualWeapon(): applied by the scan task, in the same scan as a
+  // weapon posted just before it.
   void Setweapon_detection_mode(weapon_detection_mode_t mode) {
-    m_DectionMode = mode;
+    PostRequest(REQUEST_MODE | mode << REQUEST_MODE_SHIFT,
+                REQUEST_MODE | REQUEST_MODE_MASK);
   };
 
   // Attach observers to long-hit events (EVENT_LONGHIT | LONGHIT_* flags)
@@ -78,12 +91,50 @@ public:
   // Attach observers to double-hit events (EVENT_DOUBLEHIT | DOUBLEHIT_* flags)
   DoubleHitDetector &getDoubleHitDetector() { return DoubleHitDetector_; }
 
+  // Lights changes, in order. Single consumer: the state machine task.
+  bool PopHitEvent(HitEvent &event) { return m_HitEvents.pop(event); }
+  uint32_t GetDroppedHitEvents() const { return m_HitEvents.dropped(); }
+  // Task notified (xTaskNotifyGive) after each pushed lights change
+  void SetHitEventTask(TaskHandle_t task) { m_HitEventTask = task; }
+
+  // Always-on scan loop timing (callback interval, DoFullScan duration)
+  ScanTimingStats &getScanTimingStats() { return ScanTimingStats_; }
+  // true if the last scan ran the DEBOUNCING branch of the weapon state machine
+  bool IsScanDebouncing() const { return m_ScanDebouncing; }
+
 protected:
 private:
   friend class SingletonMixin<MultiWeaponSensor>;
+
+  // State of the weapon scan routines (DoFoil/DoEpee/DoSabre). Only the
+  // active weapon uses it; it is cleared when the weapon changes.
+  enum ScanState : uint8_t { SCAN_IDLE, SCAN_DEBOUNCING };
+  struct WeaponScanState {
+    ScanState state = SCAN_IDLE;
+    uint8_t subsample = 0;    // rotation of the optional checks while idle
+    bool lastValid_l = false; // foil: previous scan's lame contact
+    bool lastValid_r = false;
+    int ADCL_0 = 0; // epee: previous raw sample, for 2-sample averaging
+    int ADCR_0 = 0;
+  };
+  void SelectWeaponScan();
+  // Requests from other tasks, applied by the scan task in ApplyRequests()
+  static constexpr uint32_t REQUEST_WEAPON_MASK = 0x0f; // weapon_t
+  static constexpr uint32_t REQUEST_MODE_SHIFT = 4;
+  static constexpr uint32_t REQUEST_MODE_MASK = 0xf0; // detection mode
+  static constexpr uint32_t REQUEST_WEAPON = 0x100;
+  static constexpr uint32_t REQUEST_MODE = 0x200;
+  static constexpr uint32_t REQUEST_RESET = 0x400;
+  void PostRequest(uint32_t request, uint32_t replaces) {
+    uint32_t old = m_Requests.load(std::memory_order_relaxed);
+    while (!m_Requests.compare_exchange_weak(old, (old & ~replaces) | request,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    }
+  }
+  void ApplyRequests();
   /** Default constructor */
   MultiWeaponSensor();
-  esp_timer_handle_t m_scan_timer{nullptr};
   bool Do_Common_Start();
   // void Skip_phase();
   void HandleLights();
@@ -111,42 +162,35 @@ private:
   bool NotConnectedRight;
   bool bAutoDetect;
   bool bPreventBuzzer = false;
-  // below are the counters used for "debouncing"
-  // "normal" counters are used for contact duration of hits
-
-  DebounceTimer Debounce_b1;
-  DebounceTimer Debounce_b2;
-  DebounceTimer Debounce_c1;
-  DebounceTimer Debounce_c2;
+  // below are the counters used for "debouncing", all in one DebounceBank
+  // (one DebounceTimer per channel, stored as arrays)
+  enum DebounceChannel : uint8_t {
+    // "normal" counters are used for contact duration of hits
+    DB_B1,
+    DB_B2,
+    DB_C1,
+    DB_C2,
+    // "long" debouncers are used for automatic weapon detection
+    // used to switch to Sabre mode when in Foil
+    // or to switch to foil or Sabre when in Epee mode
+    // These are checks from left to right or inverse
+    DB_LONG_AL_CR,
+    DB_LONG_AR_CL,
+    // used to switch to Epee mode when in Foil or Sabre
+    // These are check from left to left and right to right
+    DB_LONG_AL_CL,
+    DB_LONG_AR_CR,
+    // counters introduced for automatic switch to epee if no foil or sabre
+    // connected
+    DB_NOT_CONNECTED,
+    DB_AT_LEAST_ONE_NOT_CONNECTED,
+    DB_NUM_CHANNELS
+  };
+  DebounceBank<DB_NUM_CHANNELS> m_Debounce;
 
   DoubleDebouncer Debounce_SabreWhite_l;
   DoubleDebouncer Debounce_SabreWhite_r;
 
-  // below const values are used to make timing calibration possible without
-  // having constants in the code
-
-  // "long" debouncers are used for automatic weapon detection
-  DebounceTimer DebounceLong_b1;
-  DebounceTimer DebounceLong_b2;
-  DebounceTimer DebounceLong_c1;
-  DebounceTimer DebounceLong_c2;
-
-  // used to switch to Sabre mode when in Foil
-  // or to switch to foil or Sabre when in Epee mode
-  // These are checks from left to right or inverse
-  DebounceTimer DebounceLong_al_cr;
-  DebounceTimer DebounceLong_ar_cl;
-
-  // used to switch to Epee mode when in Foil or Sabre
-  // These are check from left to left and right to right
-  DebounceTimer DebounceLong_al_cl;
-  DebounceTimer DebounceLong_ar_cr;
-
-  // counters introduced for automatic switch to epee if no foil or sabre
-  // connected
-  DebounceTimer Debounce_NotConnected;
-  DebounceTimer Debounce_AtLeastOneNotConnected;
-
   uint32_t Lights;
 
   int BlockCounter;
@@ -170,20 +214,32 @@ private:
 
   LongHitDetector LongHitDetector_;
   DoubleHitDetector DoubleHitDetector_;
+  ScanTimingStats ScanTimingStats_;
+  bool m_ScanDebouncing = false;
+  WeaponScanFn m_DoWeaponScan = &MultiWeaponSensor::DoEpee;
+  WeaponScanState m_Scan;
 
   DoubleDebouncer Debounce_Parry;
   DoubleDebouncer WO_Debounce_Parry;
   bool CurrentParryState = false;
   bool previousParryState = false;
 
-  int TimeOfLock;
+  // esp_timer_get_time() captured once at the start of DoFullScan(); all
+  // debouncers, detectors and lock/reset deadlines of that scan use it.
+  ScanTimestamp m_ScanNowUs{};
+  int64_t m_LockoutUs = 0;
+  int64_t m_ContactStartLeftUs = 0;
+  int64_t m_ContactStartRightUs = 0;
+  // Single producer: only the scan task (DoFullScan and what it calls) pushes
+  SpscRing<HitEvent, 32> m_HitEvents;
+  std::atomic<uint32_t> m_Requests{0};
+  TaskHandle_t m_HitEventTask = nullptr;
   bool LockStarted;
-  int TimeToReset;
+  int64_t TimeToReset; // µs, m_ScanNowUs time base
   int LightsDuration = LIGHTS_DURATION_MS;
 
-  uint32_t ShortIndicatorsDebouncer = 0;
+  int64_t ShortIndicatorsDebouncer = 0; // µs, m_ScanNowUs time base
 
-  esp_adc_cal_characteristics_t adc_chars;
   int CorrectVccCounter = 10;
   bool PowerProblem = false;
   bool ForceThresholdCalibration = false;
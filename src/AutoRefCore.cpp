@@ -0,0 +1,401 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "AutoRefCore.h"
+#include "EventDefinitions.h"
+
+void AutoRefCore::onEvent(uint32_t event, uint32_t now,
+                          const AutoRefMatchInfo &match, AutoRefActions &out) {
+  uint32_t mainType = event & MAIN_TYPE_MASK;
+  if (!m_enabled) {
+    if (mainType == EVENT_LONGHIT)
+      handleLongPress(event, now, out);
+    // Single double-hits ignored when AutoRef is disabled.
+    return;
+  }
+  if (mainType == EVENT_LIGHTS) {
+    uint32_t lights = event & DATA_24BIT_MASK;
+    processLights(lights, now, match, out);
+  } else if (mainType == EVENT_LONGHIT) {
+    handleLongPress(event, now, out);
+  } else if (mainType == EVENT_DOUBLEHIT) {
+    handleDoubleHit(event, out);
+  } else if (mainType == AUTOREF_TIMER_ZERO) {
+    handleTimerZero(event, now, out);
+  } else if (mainType == AUTOREF_BLACK_CARD) {
+    m_state = AR_MATCH_OVER;
+  } else if (mainType == EVENT_UW2F_TIMER) {
+    if (m_state != AR_MATCH_OVER)
+      handleUW2FTimerZero(now, out);
+  }
+}
+
+void AutoRefCore::processLights(uint32_t lights, uint32_t now,
+                                const AutoRefMatchInfo &match,
+                                AutoRefActions &out) {
+  switch (m_state) {
+  case AR_ARMED:
+    processArmed(lights);
+    break;
+  case AR_WAITING_FOR_LIGHTS_OFF:
+    processWaitingForLightsOff(lights, now, match, out);
+    break;
+  case AR_AWAITING_CONFIRMATION:
+    processConfirmation(lights, now, out);
+    break;
+  case AR_AWARDING:
+    m_peakLights |= lights;
+    break;
+  default:
+    break;
+  }
+  m_prevLights = lights;
+}
+
+void AutoRefCore::processArmed(uint32_t lights) {
+  bool redOn = lights & MASK_RED;
+  bool greenOn = lights & MASK_GREEN;
+  bool whiteL = lights & MASK_WHITE_L;
+  bool whiteR = lights & MASK_WHITE_R;
+  if (!redOn && !greenOn && !whiteL && !whiteR)
+    return;
+  // Any light turned on — start accumulating
+  m_peakLights = lights;
+  m_state = AR_WAITING_FOR_LIGHTS_OFF;
+}
+
+void AutoRefCore::processWaitingForLightsOff(uint32_t lights, uint32_t now,
+                                             const AutoRefMatchInfo &match,
+                                             AutoRefActions &out) {
+  // Accumulate all lights seen while weapons are in contact
+  m_peakLights |= lights;
+  // Wait until all lights are off before taking a decision
+  if (lights == 0) {
+    processDecision(m_peakLights, now, match, out);
+  }
+}
+
+void AutoRefCore::processDecision(uint32_t peakLights, uint32_t now,
+                                  const AutoRefMatchInfo &match,
+                                  AutoRefActions &out) {
+  bool redOn = peakLights & MASK_RED;
+  bool greenOn = peakLights & MASK_GREEN;
+  bool whiteL = peakLights & MASK_WHITE_L;
+  bool whiteR = peakLights & MASK_WHITE_R;
+
+  switch (match.weapon) {
+  case EPEE: {
+    bool isDouble = redOn && greenOn;
+    bool inOvertime = match.timerState == ADDITIONAL_MINUTE;
+    int maxScore = getMaxScore(match);
+    bool bothAtMaxMinusOne = ((int)match.scoreLeft >= maxScore - 1) &&
+                             ((int)match.scoreRight >= maxScore - 1);
+    if (isDouble && (inOvertime || bothAtMaxMinusOne)) {
+      // Double hit in overtime or at match-point tie: no scoring, treat as
+      // off-target
+      m_isOffTargetContinue = true;
+      continueMatch(now);
+    } else if (redOn || greenOn) {
+      award(redOn ? 1 : 0, greenOn ? 1 : 0, now, out);
+    } else {
+      m_state = AR_ARMED; // no valid hit
+    }
+    break;
+  }
+
+  case FOIL:
+    if (!redOn && !greenOn) {
+      // Off-target only — no point, but still trigger EGPA and restart timer
+      m_isOffTargetContinue = true;
+      continueMatch(now);
+    } else if ((redOn && greenOn) || (redOn && whiteR) || (greenOn && whiteL)) {
+      // Double valid, or valid+off-target mix → need confirmation
+      m_state = AR_AWAITING_CONFIRMATION;
+      m_stateEnteredAt = now;
+      out.add(AR_ACTION_ANIMATION, EVENT_WS2812_CONFIRMATION_WAIT);
+    } else if (redOn) {
+      award(1, 0, now, out);
+    } else {
+      award(0, 1, now, out);
+    }
+    break;
+
+  case SABRE:
+    // White is irrelevant on sabre
+    if (redOn && greenOn) {
+      m_state = AR_AWAITING_CONFIRMATION;
+      m_stateEnteredAt = now;
+      out.add(AR_ACTION_ANIMATION, EVENT_WS2812_CONFIRMATION_WAIT);
+    } else if (redOn) {
+      award(1, 0, now, out);
+    } else if (greenOn) {
+      award(0, 1, now, out);
+    } else {
+      m_state = AR_ARMED;
+    }
+    break;
+
+  default:
+    m_state = AR_ARMED;
+    break;
+  }
+}
+
+void AutoRefCore::processConfirmation(uint32_t lights, uint32_t now,
+                                      AutoRefActions &out) {
+  // Any light from either side confirms — including white/off-target
+  // The confirming side is determined by which side newly lit up
+  // Whether a point is awarded depends on what that side had in the original
+  // action (m_peakLights)
+  uint32_t risingEdge = lights & ~m_prevLights;
+  bool newLeft = risingEdge & (MASK_RED | MASK_WHITE_L);
+  bool newRight = risingEdge & (MASK_GREEN | MASK_WHITE_R);
+
+  if (newLeft && !newRight) {
+    // Left confirms: award point only if left had a valid hit in the original
+    // action
+    if (m_peakLights & MASK_RED)
+      award(1, 0, now, out);
+    else
+      continueMatch(now); // left had priority but off-target — no point
+  } else if (newRight && !newLeft) {
+    // Right confirms: award point only if right had a valid hit in the original
+    // action
+    if (m_peakLights & MASK_GREEN)
+      award(0, 1, now, out);
+    else
+      continueMatch(now); // right had priority but off-target — no point
+  }
+  // Both sides again → stay in AWAITING_CONFIRMATION
+}
+
+void AutoRefCore::handleLongPress(uint32_t lhdEvent, uint32_t now,
+                                  AutoRefActions &out) {
+  bool isDouble = (lhdEvent & LONGHIT_IS_DOUBLE) != 0;
+
+  // Single long hits are intentionally ignored; only a double long press
+  // (both fencers holding for the full duration) triggers an action.
+  if (!isDouble)
+    return;
+  bool hitL = (lhdEvent & DOUBLEHIT_VALID_LEFT) != 0;  // red = scored hit
+  bool hitR = (lhdEvent & DOUBLEHIT_VALID_RIGHT) != 0; // green = scored hit
+  if (!hitL || !hitR) {
+    return;
+  }
+  if (!m_enabled) {
+    // Double long press while disabled: enter AutoRef mode.
+    out.add(AR_ACTION_CLEAR_LEDS);
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_AUTOREF_MODE);
+    m_enabled = true;
+    m_state = AR_AWARDING;
+    m_stateEnteredAt = now;
+    m_prevLights = 0;
+    m_peakLights = 0;
+    return;
+  }
+
+  // Double long press while enabled: full match reset (allowed from any state).
+  out.add(AR_ACTION_CLEAR_LEDS);
+  out.add(AR_ACTION_ANIMATION, EVENT_WS2812_AUTOREF_MODE);
+  out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_RESET);
+  out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+  m_state = AR_PERIOD_END;
+  m_stateEnteredAt = now;
+  m_prevLights = 0;
+  m_peakLights = 0;
+}
+
+void AutoRefCore::handleDoubleHit(uint32_t dhdEvent, AutoRefActions &out) {
+  bool hitL = (dhdEvent & DOUBLEHIT_VALID_LEFT) != 0;
+  bool hitR = (dhdEvent & DOUBLEHIT_VALID_RIGHT) != 0;
+
+  if (m_state != AR_AWARDING)
+    return;
+
+  if (hitL) {
+    out.add(AR_ACTION_UNDO_LIGHTS, MASK_RED | MASK_WHITE_L);
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_UNDO_HIT | 0x0001);
+    out.add(AR_ACTION_DELAY_MS, 1000);
+    out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_DECR_SCORE_LEFT);
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_UNDO_HIT | 0x0001);
+  }
+  if (hitR) {
+    out.add(AR_ACTION_UNDO_LIGHTS, MASK_GREEN | MASK_WHITE_R);
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_UNDO_HIT | 0x0002);
+    out.add(AR_ACTION_DELAY_MS, 1000);
+    out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_DECR_SCORE_RIGHT);
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_UNDO_HIT | 0x0002);
+  }
+}
+
+void AutoRefCore::handleTimerZero(uint32_t ctx, uint32_t now,
+                                  AutoRefActions &out) {
+  // Unpack snapshot captured synchronously in AutoRef::update() — no FSM
+  // getters needed
+  TimerState_t timerState = (TimerState_t)((ctx >> 8) & 0xff);
+  bool isLastRound = (ctx & 0x02) != 0;
+  bool scoresEqual = (ctx & 0x01) != 0;
+
+  // Always give an audible signal
+  out.add(AR_ACTION_ANIMATION, EVENT_WS2812_WARNING | 0x00000003); // 3 beeps
+  out.add(AR_ACTION_DELAY_MS, 2000);
+
+  switch (timerState) {
+  case FIGHTING:
+    if (!isLastRound) {
+      // Not last round: FSM auto-advances to BREAK, start the break timer
+      out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_START_TIMER);
+    } else if (scoresEqual) {
+      // Last round, tied: draw priority, play EGPA, then start overtime
+      out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_PRIO);
+      out.add(AR_ACTION_DELAY_MS, 5000);
+      out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+      m_state = AR_PERIOD_END;
+      m_stateEnteredAt = now;
+    }
+    // Last round, not tied: match is over. After an earlier round AutoRef
+    // stays armed through the break.
+    if (isLastRound && !scoresEqual)
+      m_state = AR_MATCH_OVER;
+    break;
+
+  case BREAK:
+    // Break ended: play EGPA then start next fighting period
+    out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+    m_state = AR_PERIOD_END;
+    m_stateEnteredAt = now;
+    break;
+
+  case ADDITIONAL_MINUTE:
+    // Overtime ended; match is over.
+    m_state = AR_MATCH_OVER;
+    break;
+
+  default:
+    break;
+  }
+}
+
+void AutoRefCore::handleUW2FTimerZero(uint32_t now, AutoRefActions &out) {
+  // UW2F timer reached 60 s: stop the fight, warn, issue P-card, then EGPA
+  out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_STOP_TIMER);
+  out.add(AR_ACTION_ANIMATION, EVENT_WS2812_WARNING | 0x00000003); // 3 beeps
+  m_state = AR_UW2F_PCARD_WAIT;
+  m_stateEnteredAt = now;
+  m_prevLights = 0;
+  m_peakLights = 0;
+}
+
+void AutoRefCore::checkTimeouts(uint32_t now, const AutoRefMatchInfo &match,
+                                AutoRefActions &out) {
+  if (!m_enabled)
+    return;
+  switch (m_state) {
+  case AR_AWAITING_CONFIRMATION:
+    if (now - m_stateEnteredAt >= AUTOREF_CONFIRMATION_TIMEOUT_MS) {
+      out.add(AR_ACTION_END_CONFIRMATION);
+      GoImmediatelyToArmed(now, out);
+      // continueMatch(now); // no points, restart
+    }
+
+    break;
+  case AR_AWARDING: {
+    uint32_t delay = m_isOffTargetContinue ? AUTOREF_POST_OFFTARGET_DELAY_MS
+                                           : AUTOREF_POST_AWARD_DELAY_MS;
+    if (now - m_stateEnteredAt >= delay) {
+      bool inOvertime = match.timerState == ADDITIONAL_MINUTE;
+      bool inBreak = match.timerState == BREAK;
+      bool matchDone = !m_isOffTargetContinue &&
+                       (isMatchOver(match) ||
+                        (inOvertime && match.scoreLeft != match.scoreRight));
+      if (matchDone) {
+        m_state = AR_MATCH_OVER;
+      } else if (inBreak) {
+        // Hit during break: suppress EGPA — the break timer is still running
+        // and handleTimerZero(BREAK) will play EGPA at the correct moment.
+        m_state = AR_ARMED;
+        m_prevLights = 0;
+        m_peakLights = 0;
+      } else {
+        out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+        m_state = AR_EGPA;
+        m_stateEnteredAt = now;
+      }
+    }
+    break;
+  }
+  case AR_EGPA:
+    if (now - m_stateEnteredAt >= AUTOREF_EGPA_DURATION_MS) {
+      if (match.weapon != SABRE)
+        out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_START_TIMER);
+      m_state = AR_ARMED;
+      m_prevLights = 0;
+      m_peakLights = 0;
+    }
+    break;
+  case AR_PERIOD_END:
+    if (now - m_stateEnteredAt >= AUTOREF_PERIOD_END_DELAY_MS) {
+      out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_START_TIMER);
+      m_state = AR_ARMED;
+      m_prevLights = 0;
+      m_peakLights = 0;
+    }
+    break;
+  case AR_UW2F_PCARD_WAIT:
+    if (now - m_stateEnteredAt >= AUTOREF_UW2F_PCARD_DELAY_MS) {
+      out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_P_CARD);
+      m_state = AR_UW2F_RESUME_WAIT;
+      m_stateEnteredAt = now;
+    }
+    break;
+  case AR_UW2F_RESUME_WAIT:
+    if (now - m_stateEnteredAt >= AUTOREF_UW2F_RESUME_DELAY_MS) {
+      out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+      m_state = AR_PERIOD_END;
+      m_stateEnteredAt = now;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void AutoRefCore::award(int deltaLeft, int deltaRight, uint32_t now,
+                        AutoRefActions &out) {
+  if (deltaLeft > 0)
+    out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_INCR_SCORE_LEFT);
+  if (deltaRight > 0)
+    out.add(AR_ACTION_FSM, EVENT_UI_INPUT | UI_INPUT_INCR_SCORE_RIGHT);
+
+  // Match-over decision is deferred to checkTimeouts() after the correction
+  // window
+  m_isOffTargetContinue = false;
+  continueMatch(now);
+}
+
+void AutoRefCore::GoImmediatelyToArmed(uint32_t now, AutoRefActions &out) {
+  m_prevLights = 0;
+  m_peakLights = 0;
+  out.add(AR_ACTION_ANIMATION, EVENT_WS2812_ENGARDE_PRETS_ALLEZ);
+  m_state = AR_EGPA;
+  m_stateEnteredAt = now;
+}
+
+void AutoRefCore::continueMatch(uint32_t now) {
+  m_state = AR_AWARDING;
+  m_stateEnteredAt = now;
+  m_prevLights = 0;
+  m_peakLights = 0;
+}
+
+bool AutoRefCore::isMatchOver(const AutoRefMatchInfo &match) {
+  int maxScore = getMaxScore(match);
+  int sl = (int)match.scoreLeft;
+  int sr = (int)match.scoreRight;
+  // Match is over only when one side reaches maxScore AND scores differ
+  // (equal scores at max would go to overtime, not match-over)
+  return (sl >= maxScore || sr >= maxScore) && (sl != sr);
+}
+
+int AutoRefCore::getMaxScore(const AutoRefMatchInfo &match) {
+  // nrOfRounds: 1=pool(5pts), 3=DE(15pts), 9=teams(45pts)
+  return match.nrOfRounds * 5;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include "TimerState.h"
+#include "weaponenum.h"
+#include <stdint.h>
+
+// Timing constants (ms)
+#define AUTOREF_CONFIRMATION_TIMEOUT_MS 15000
+#define AUTOREF_POST_AWARD_DELAY_MS 5000
+#define AUTOREF_POST_OFFTARGET_DELAY_MS 1000
+#define AUTOREF_EGPA_DURATION_MS 4000
+#define AUTOREF_PERIOD_END_DELAY_MS                                            \
+  6000 // warning + EGPA before starting next period
+#define AUTOREF_UW2F_PCARD_DELAY_MS 2000  // delay before issuing P-card
+#define AUTOREF_UW2F_RESUME_DELAY_MS 2000 // delay after P-card before EGPA
+
+enum AutoRefState_t {
+  AR_ARMED,
+  AR_WAITING_FOR_LIGHTS_OFF, // lights on, accumulating, waiting for them to
+                             // clear
+  AR_AWAITING_CONFIRMATION,  // double/mixed hit, waiting for single-side
+                             // confirmation
+  AR_AWARDING,               // point awarded, waiting before EGPA
+  AR_EGPA,                   // EGPA animation running
+  AR_PERIOD_END, // timer reached zero: warning+EGPA playing, waiting to start
+                 // next period
+  AR_UW2F_PCARD_WAIT,  // UW2F 60s: waiting before issuing P-card
+  AR_UW2F_RESUME_WAIT, // UW2F 60s: waiting after P-card before EGPA
+  AR_MATCH_OVER        // match ended, waiting for double-long-press reset
+};
+
+// Match data the referee logic looks at. The AutoRef task reads it from the
+// FencingStateMachine; a simulator fills it from its own bout model.
+struct AutoRefMatchInfo {
+  weapon_t weapon = UNKNOWN;
+  TimerState_t timerState = UNDEFINED;
+  unsigned int scoreLeft = 0;
+  unsigned int scoreRight = 0;
+  int nrOfRounds = 1;
+};
+
+enum AutoRefActionType_t : uint8_t {
+  AR_ACTION_FSM,              // value: EVENT_UI_INPUT command for the FSM
+  AR_ACTION_ANIMATION,        // value: WS2812 animation event
+  AR_ACTION_CLEAR_LEDS,       // clear the whole strip
+  AR_ACTION_UNDO_LIGHTS,      // value: hit lights to remove from the strip
+  AR_ACTION_END_CONFIRMATION, // stop the confirmation-wait animation
+  AR_ACTION_DELAY_MS          // value: pause before the next action
+};
+
+struct AutoRefAction {
+  AutoRefActionType_t type;
+  uint32_t value;
+};
+
+// Side effects requested by one AutoRefCore call, in execution order.
+#define AUTOREF_MAX_ACTIONS 16
+struct AutoRefActions {
+  AutoRefAction list[AUTOREF_MAX_ACTIONS];
+  uint8_t count = 0;
+
+  void add(AutoRefActionType_t type, uint32_t value = 0) {
+    if (count < AUTOREF_MAX_ACTIONS) {
+      list[count].type = type;
+      list[count].value = value;
+      count++;
+    }
+  }
+  void clear() { count = 0; }
+};
+
+// The AutoRef referee logic without FreeRTOS, clocks or singletons.
+//
+// All state lives in the object, which is a plain copyable value. Every call
+// takes the current time and match data as arguments and appends what should
+// happen (FSM commands, animations, pauses) to an AutoRefActions list instead
+// of doing it. The same sequence of calls therefore always yields the same
+// states and actions, on the box or on a host.
+class AutoRefCore {
+public:
+  // Handle one event from the AutoRef queue: EVENT_LIGHTS, EVENT_LONGHIT,
+  // EVENT_DOUBLEHIT, EVENT_UW2F_TIMER, AUTOREF_TIMER_ZERO or
+  // AUTOREF_BLACK_CARD. While disabled only a double long press is handled.
+  void onEvent(uint32_t event, uint32_t now, const AutoRefMatchInfo &match,
+               AutoRefActions &out);
+  // Advance the timed states. Called on every pass of the task loop.
+  void checkTimeouts(uint32_t now, const AutoRefMatchInfo &match,
+                     AutoRefActions &out);
+
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  bool isEnabled() const { return m_enabled; }
+  AutoRefState_t state() const { return m_state; }
+
+private:
+  void processLights(uint32_t lights, uint32_t now,
+                     const AutoRefMatchInfo &match, AutoRefActions &out);
+  void processArmed(uint32_t lights);
+  void processWaitingForLightsOff(uint32_t lights, uint32_t now,
+                                  const AutoRefMatchInfo &match,
+                                  AutoRefActions &out);
+  void processDecision(uint32_t peakLights, uint32_t now,
+                       const AutoRefMatchInfo &match, AutoRefActions &out);
+  void processConfirmation(uint32_t lights, uint32_t now, AutoRefActions &out);
+  void handleLongPress(uint32_t lhdEvent, uint32_t now, AutoRefActions &out);
+  void handleDoubleHit(uint32_t dhdEvent, AutoRefActions &out);
+  void handleTimerZero(uint32_t ctx, uint32_t now, AutoRefActions &out);
+  void handleUW2FTimerZero(uint32_t now, AutoRefActions &out);
+  void award(int deltaLeft, int deltaRight, uint32_t now, AutoRefActions &out);
+  void continueMatch(uint32_t now);
+  void GoImmediatelyToArmed(uint32_t now, AutoRefActions &out);
+  static bool isMatchOver(const AutoRefMatchInfo &match);
+  static int getMaxScore(const AutoRefMatchInfo &match);
+
+  bool m_enabled = false;
+  AutoRefState_t m_state = AR_ARMED;
+  uint32_t m_stateEnteredAt = 0;
+  uint32_t m_prevLights = 0; // last lights value seen (for change detection)
+  uint32_t m_peakLights =
+      0; // accumulated lights seen during WAITING_FOR_LIGHTS_OFF
+  bool m_isOffTargetContinue =
+      false; // true when AR_AWARDING was triggered by off-target (no point)
+};
@@ -3,6 +3,7 @@
 #include "EFP1Message.h"
 #include "MDNSResolver.h"
 #include "Opp2Handler.h"
+#include <cstring>
 #include <esp_log.h>
 #include <sstream>
 #include <string>
@@ -18,7 +19,7 @@ static const char *CYRANO_TAG = "Cyrano";
 // discovery — re-enable here if needed.
 static constexpr bool kCyranoBroadcastEnabled = false;
 const char *mdnsName = "openpiste";
-CyranoHandler::CyranoHandler() : m_CachedStatusValid(false) {
+CyranoHandler::CyranoHandler() {
   // ctor
   // Note: State now managed by OPP2::SystemState in Opp2Handler
   // Cached status will be populated on first state update
@@ -35,27 +36,9 @@ char *mqttClientId;            // MQTT Client ID
 // ════════════════════════════════════════════════════════════════════════════
 
 void CyranoHandler::updateCachedStatus(const EFP1Message &status) {
-  // Store the base state from Opp2Handler
-  m_CachedStatus = status;
-
-  // Rebuild the cached strings with current CompetitionId
-  RebuildCachedStrings();
-}
-
-void CyranoHandler::RebuildCachedStrings() {
-  // Build EFP1 message with Cyrano-specific fields
-  EFP1Message msg = m_CachedStatus;
-  msg[Command] = "INFO";
-  msg[CompetitionId] = m_CompetitionId;
-
-  // Build and cache the INFO, NEXT, PREV Cyrano wire strings
-  // CRITICAL: MakeNext/PrevMessageString() use msg[CompetitionId], so msg must have it set
-  msg.ToString(m_CachedCyranoString);
-  m_CachedNextCyrano = msg.MakeNextMessageString();
-  m_CachedPrevCyrano = msg.MakePrevMessageString();
-
-  // Mark cache as valid
-  m_CachedStatusValid = true;
+  // Most updates are a clock tick or a light/score toggle, which the cache
+  // patches into the INFO string instead of rebuilding all three strings.
+  m_WireCache.update(status);
 }
 
 void CyranoHandler::Begin() {
@@ -114,16 +97,15 @@ void CyranoHandler::SendInfoMessage() {
     return;
 
   // ── Use cached strings - NO string building in callback ───────────────
-  // Strings pre-built by RebuildCachedStrings() when state/CompetitionId
-  // changes
-  if (!m_CachedStatusValid) {
+  // Strings pre-built by m_WireCache when state/CompetitionId changes
+  if (!m_WireCache.valid()) {
     // Cache not yet initialized - skip this send
     return;
   }
 
   // Use cached string directly - zero stack allocations
-  const char *pCyranoMsg = m_CachedCyranoString.c_str();
-  size_t cyranoLen = m_CachedCyranoString.length();
+  const char *pCyranoMsg = m_WireCache.info().c_str();
+  size_t cyranoLen = m_WireCache.info().length();
 
   CyranoHandlerudpRcv.writeTo((uint8_t *)pCyranoMsg, cyranoLen,
                               SoftwareIPAddress(), CyranoBroadcastPort,
@@ -159,11 +141,7 @@ void CyranoHandler::ProcessMessageFromSoftware(const EFP1Message &input,
     bOKToSend = true;
     bSoftwareIsLive = true;
     LastHelloReception = millis();
-    m_CompetitionId = input[CompetitionId];
-
-    if (m_CachedStatusValid) {
-      RebuildCachedStrings();
-    }
+    m_WireCache.setCompetitionId(input[CompetitionId]);
     SendInfoMessage();
     break;
 
@@ -211,13 +189,13 @@ void CyranoHandler::update(Opp2Handler *subject, uint32_t eventtype) {
   case EVENT_CYRANO_SEND_NEXT:
     // Send NEXT message (WAITING state only per Cyrano spec)
     ESP_LOGI(CYRANO_TAG, "[Opp2→Cyrano] Sending NEXT message");
-    if (!m_CachedStatusValid) {
+    if (!m_WireCache.valid()) {
       ESP_LOGW(CYRANO_TAG, "[Opp2→Cyrano] NEXT: Cache not valid yet");
       return;
     }
     {
-      const char *pCyranoMsg = m_CachedNextCyrano.c_str();
-      size_t cyranoLen = m_CachedNextCyrano.length();
+      const char *pCyranoMsg = m_WireCache.next().c_str();
+      size_t cyranoLen = m_WireCache.next().length();
       CyranoHandlerudpRcv.writeTo((uint8_t *)pCyranoMsg, cyranoLen,
                                   SoftwareIPAddress(), CyranoBroadcastPort,
                                   TCPIP_ADAPTER_IF_STA);
@@ -234,13 +212,13 @@ void CyranoHandler::update(Opp2Handler *subject, uint32_t eventtype) {
   case EVENT_CYRANO_SEND_PREV:
     // Send PREV message (WAITING state only per Cyrano spec)
     ESP_LOGI(CYRANO_TAG, "[Opp2→Cyrano] Sending PREV message");
-    if (!m_CachedStatusValid) {
+    if (!m_WireCache.valid()) {
       ESP_LOGW(CYRANO_TAG, "[Opp2→Cyrano] PREV: Cache not valid yet");
       return;
     }
     {
-      const char *pCyranoMsg = m_CachedPrevCyrano.c_str();
-      size_t cyranoLen = m_CachedPrevCyrano.length();
+      const char *pCyranoMsg = m_WireCache.prev().c_str();
+      size_t cyranoLen = m_WireCache.prev().length();
       CyranoHandlerudpRcv.writeTo((uint8_t *)pCyranoMsg, cyranoLen,
                                   SoftwareIPAddress(), CyranoBroadcastPort,
                                   TCPIP_ADAPTER_IF_STA);
@@ -305,7 +283,7 @@ void ProcessCyranoPacket(AsyncUDPPacket packet) {
   }
   // ESP_LOGE(CYRANO_TAG, "%s",(char*)packet.data());
   MyCyranoHandler.ProcessMessageFromSoftware(
-      (EFP1Message((char *)packet.data())));
+      EFP1Message((const char *)packet.data(), packet.length()));
 }
 
 void CyranoHandler::CheckConnection() {
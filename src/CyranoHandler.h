@@ -1,6 +1,7 @@
 #ifndef CYRANOHANDLER_H
 #define CYRANOHANDLER_H
 #include "AsyncUDP.h"
+#include "CyranoWireCache.h"
 #include "EFP1Message.h"
 #include "EventDefinitions.h"
 #include "FencingStateMachine.h"
@@ -69,27 +70,14 @@ private:
   /** Default constructor */
   CyranoHandler();
 
-  // Cyrano-specific fields not in OPP2::SystemState
-  std::string m_CompetitionId; //!< Software-provided competition ID
-
   // ── Cached strings for UDP callback stack safety ──────────────────────
   // Phase 6 lesson: String building (ToString(), JSON conversion) in
   // UDP callbacks causes stack overflow in async_udp task (~4KB stack).
-  // Solution: Pre-build and cache ALL final strings (INFO, NEXT, PREV).
+  // Solution: Pre-build and cache ALL final strings (INFO, NEXT, PREV),
+  // together with the software-provided competition id.
   // Rebuild only when state or CompetitionId changes.
   // SendInfoMessage() and ProcessUIEvents() use cached strings - NO stack.
-  EFP1Message m_CachedStatus;       //!< Updated when Opp2Handler state changes
-  std::string m_CachedCyranoString; //!< Pre-built INFO Cyrano string
-  std::string m_CachedNextCyrano;   //!< Pre-built NEXT Cyrano string
-  std::string m_CachedPrevCyrano;   //!< Pre-built PREV Cyrano string
-  bool m_CachedStatusValid;         //!< True when cache is synchronized
-
-  /**
-   * Rebuild cached strings from m_CachedStatus and m_CompetitionId.
-   * Called when state changes (via updateCachedStatus) or CompetitionId
-   * changes.
-   */
-  void RebuildCachedStrings();
+  CyranoWireCache m_WireCache;
 
   EFP1Message m_IncompleteMessage;
   CyranoState m_State = WAITING;
@@ -0,0 +1,67 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "CyranoWireCache.h"
+#include <cstring>
+
+// Fields that also appear in the NEXT/PREV strings, or that change the shape
+// of the INFO string. A change to any of them needs a full rebuild.
+static constexpr uint64_t kCyranoHeaderFields =
+    EFP1_FIELD_BIT(Protocol) | EFP1_FIELD_BIT(PisteId);
+
+bool CyranoWireCache::update(const EFP1Message &status) {
+  // Command and CompetitionId are overridden by wireMessage(), so changes to
+  // them from Opp2Handler never reach the wire.
+  uint64_t changed =
+      m_Status.ChangedFields(status) &
+      ~(EFP1_FIELD_BIT(Command) | EFP1_FIELD_BIT(CompetitionId));
+
+  bool patched =
+      m_Valid && !(changed & kCyranoHeaderFields) && patch(status, changed);
+  m_Status = status;
+  if (!patched)
+    rebuild();
+  return patched;
+}
+
+bool CyranoWireCache::patch(const EFP1Message &status, uint64_t changed) {
+  // Only same-length edits can be done in place; anything else shifts the
+  // rest of the wire string.
+  for (int i = 0; i < MAX_NR_FIELDS; i++) {
+    if (!(changed & EFP1_FIELD_BIT(i)))
+      continue;
+    if (m_FieldOffsets[i] == EFP1_FIELD_NOT_SERIALIZED ||
+        status[i].size() != m_Status[i].size())
+      return false;
+  }
+  for (int i = 0; i < MAX_NR_FIELDS; i++) {
+    if (changed & EFP1_FIELD_BIT(i))
+      memcpy(&m_Info[m_FieldOffsets[i]], status[i].c_str(), status[i].size());
+  }
+  return true;
+}
+
+void CyranoWireCache::setCompetitionId(const std::string &id) {
+  m_CompetitionId = id;
+  if (m_Valid)
+    rebuild();
+}
+
+EFP1Message CyranoWireCache::wireMessage() const {
+  EFP1Message msg = m_Status;
+  msg[Command] = "INFO";
+  msg[CompetitionId] = m_CompetitionId;
+  return msg;
+}
+
+void CyranoWireCache::rebuild() {
+  // MakeNext/PrevMessageString() use msg[CompetitionId], so msg must have it
+  EFP1Message msg = wireMessage();
+  // INFO is serialized straight into the cached string; its capacity is kept
+  // so later rebuilds do not reallocate. The field offsets are remembered
+  // for patch().
+  m_Info.resize(EFP1_MAX_WIRE_LENGTH);
+  size_t length = msg.ToBuffer(&m_Info[0], m_Info.size(), m_FieldOffsets);
+  m_Info.resize(length);
+  m_Next = msg.MakeNextMessageString();
+  m_Prev = msg.MakePrevMessageString();
+  m_Valid = true;
+}
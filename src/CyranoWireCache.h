@@ -0,0 +1,48 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include "EFP1Message.h"
+#include <stdint.h>
+#include <string>
+
+// The Cyrano wire strings CyranoHandler sends (INFO, NEXT, PREV), built ahead
+// of time from the status Opp2Handler pushes, so the UDP callbacks only copy
+// them out.
+//
+// Most status updates are a clock tick or a light/score toggle. update()
+// patches those fields into the INFO string at the wire offsets ToBuffer()
+// recorded during the last full build, instead of serializing the whole
+// message again. A field that changes length, or a field that also appears
+// in NEXT/PREV (protocol, piste id), triggers a full rebuild. Either way
+// info() is byte for byte what ToBuffer() gives for the current status.
+//
+// Not thread-safe: CyranoHandler uses it from Core 0 contexts only.
+class CyranoWireCache {
+public:
+  // Takes a new status. Returns true when the INFO string was patched in
+  // place (or nothing on the wire changed), false after a full rebuild.
+  bool update(const EFP1Message &status);
+  // The competition id sent in all three strings, set by the software's
+  // HELLO. Rebuilds the strings if they are valid.
+  void setCompetitionId(const std::string &id);
+  // Builds INFO, NEXT and PREV from the current status
+  void rebuild();
+
+  bool valid() const { return m_Valid; }
+  const std::string &info() const { return m_Info; }
+  const std::string &next() const { return m_Next; }
+  const std::string &prev() const { return m_Prev; }
+  // The status as it goes on the wire: Command INFO, the competition id
+  EFP1Message wireMessage() const;
+
+private:
+  bool patch(const EFP1Message &status, uint64_t changed);
+
+  EFP1Message m_Status;        // last status pushed by Opp2Handler
+  std::string m_CompetitionId; // software-provided competition id
+  std::string m_Info;
+  std::string m_Next;
+  std::string m_Prev;
+  bool m_Valid = false;
+  uint16_t m_FieldOffsets[MAX_NR_FIELDS]; // field positions in m_Info
+};
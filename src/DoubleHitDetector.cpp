@@ -1,7 +1,6 @@
 // Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
 #include "DoubleHitDetector.h"
 #include "EventDefinitions.h"
-#include "esp_timer.h"
 #include <cinttypes>
 
 static constexpr int64_t DEFAULT_MIN_HIT_US = 5000LL;   //   5 ms
@@ -25,10 +24,9 @@ void DoubleHitDetector::reset() {
   last_validL_ = last_validR_ = last_invalidL_ = last_invalidR_ = false;
 }
 
-void DoubleHitDetector::update(bool validL, bool validR, bool invalidL,
-                               bool invalidR) {
+void DoubleHitDetector::update(int64_t now, bool validL, bool validR,
+                               bool invalidL, bool invalidR) {
   bool anyActive = validL || validR || invalidL || invalidR;
-  int64_t now = esp_timer_get_time();
 
   switch (state_) {
 
@@ -21,7 +21,7 @@
 // Usage:
 //   - Epee / Sabre: pass invalidL = false, invalidR = false (default).
 //   - Foil:         pass all four channels; invalid = off-target contact.
-//   - Call update() every sensor loop iteration.
+//   - Call update() every sensor loop iteration with the scan's timestamp.
 //   - Register observers via attach(); they receive EVENT_DOUBLEHIT | <flags>.
 //   - In the observer, query getLastXxx() for which channels were involved.
 
@@ -35,9 +35,10 @@ public:
   void setMaxGapUs(int64_t us); // gap window;             default 400 000 µs
 
   // --- Per-loop call ---
+  // now is the scan's tick time (esp_timer_get_time()).
   // invalidL / invalidR are only relevant for foil; leave as false for
   // epee/sabre.
-  void update(bool validL, bool validR, bool invalidL = false,
+  void update(int64_t now, bool validL, bool validR, bool invalidL = false,
               bool invalidR = false);
 
   // --- Control ---
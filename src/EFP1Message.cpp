@@ -1,17 +1,70 @@
 #include "EFP1Message.h"
+#include <cstring>
 #include <iostream>
-#include <sstream>
+
+// Maximum length of every field (wire order: 17 general, 12 right fencer,
+// 12 left fencer). Generous compared to the EFP1.1 specification so real
+// names are not cut.
+static constexpr uint8_t FieldCapacity[MAX_NR_FIELDS] = {
+    8,  8, 16, 16, 8, 16, 8, 8, 8, 8, 4, 4, 4, 4, 16, 40, 8, // general
+    16, 40, 8, 4, 4, 4, 4, 4, 4, 4, 4, 4,                    // right fencer
+    16, 40, 8, 4, 4, 4, 4, 4, 4, 4, 4, 4};                   // left fencer
+
+static constexpr uint16_t FieldOffset(int i) {
+  return i == 0 ? 0 : FieldOffset(i - 1) + FieldCapacity[i - 1] + 1;
+}
+static constexpr uint16_t FieldOffsets[MAX_NR_FIELDS] = {
+    FieldOffset(0), FieldOffset(1), FieldOffset(2), FieldOffset(3),
+    FieldOffset(4), FieldOffset(5), FieldOffset(6), FieldOffset(7),
+    FieldOffset(8), FieldOffset(9), FieldOffset(10), FieldOffset(11),
+    FieldOffset(12), FieldOffset(13), FieldOffset(14), FieldOffset(15),
+    FieldOffset(16), FieldOffset(17), FieldOffset(18), FieldOffset(19),
+    FieldOffset(20), FieldOffset(21), FieldOffset(22), FieldOffset(23),
+    FieldOffset(24), FieldOffset(25), FieldOffset(26), FieldOffset(27),
+    FieldOffset(28), FieldOffset(29), FieldOffset(30), FieldOffset(31),
+    FieldOffset(32), FieldOffset(33), FieldOffset(34), FieldOffset(35),
+    FieldOffset(36), FieldOffset(37), FieldOffset(38), FieldOffset(39),
+    FieldOffset(40)};
+static_assert(FieldOffset(MAX_NR_FIELDS - 1) +
+                      FieldCapacity[MAX_NR_FIELDS - 1] + 1 ==
+                  EFP1_ARENA_SIZE,
+              "EFP1_ARENA_SIZE does not match the field capacities");
+
+static constexpr int RightFencerBase = EFP1_NR_GENERAL_FIELDS;
+static constexpr int LeftFencerBase =
+    EFP1_NR_GENERAL_FIELDS + EFP1_NR_FENCER_FIELDS;
+
+size_t EFP1Field::size() const { return strlen(m_Data); }
+
+EFP1Field &EFP1Field::operator=(const char *value) {
+  return assign(value, value ? strlen(value) : 0);
+}
+
+EFP1Field &EFP1Field::assign(const char *value, size_t length) {
+  if (length > m_Capacity)
+    length = m_Capacity;
+  memmove(m_Data, value, length);
+  m_Data[length] = '\0';
+  return *this;
+}
+
+bool EFP1Field::operator==(const char *value) const {
+  return strcmp(m_Data, value ? value : "") == 0;
+}
 
 EFP1Message::EFP1Message() {
   // ctor
-  for (int i = 0; i < GetNrOfGeneralFields(); i++)
-    mGeneralFields.push_back("");
-  mGeneralFields[Protocol] = "EFP1.1";
-  mGeneralFields[Command] = "INFO";
-  for (int i = 0; i < GetNrOfFencerFields(); i++)
-    mLeftFencerFields.push_back("");
-  for (int i = 0; i < GetNrOfFencerFields(); i++)
-    mRightFencerFields.push_back("");
+  Clear();
+  (*this)[Protocol] = "EFP1.1";
+  (*this)[Command] = "INFO";
+}
+
+EFP1Message::EFP1Message(const std::string &Buffer) {
+  Parse(Buffer.data(), Buffer.size());
+}
+
+EFP1Message::EFP1Message(const char *Buffer, size_t Length) {
+  Parse(Buffer, Length);
 }
 
 EFP1Message::~EFP1Message() {
@@ -21,207 +74,142 @@ EFP1Message::~EFP1Message() {
 EFP1Message &EFP1Message::operator=(const EFP1Message &rhs) {
   if (this == &rhs)
     return *this; // handle self assignment
-  // assignment operator
-  for (int i = 0; i < MAX_NR_FIELDS; i++) {
-    (*this)[i] = rhs[i];
-  }
+  memcpy(m_Arena, rhs.m_Arena, sizeof(m_Arena));
   return *this;
 }
 
+void EFP1Message::Clear() {
+  for (int i = 0; i < MAX_NR_FIELDS; i++)
+    m_Arena[FieldOffsets[i]] = '\0';
+}
+
 int const EFP1Message::GetNrOfFencerFields() const {
-  if (mGeneralFields[Protocol] == "EFP1.1")
-    return 12;
+  if ((*this)[Protocol] == "EFP1.1")
+    return EFP1_NR_FENCER_FIELDS;
   else
-    return 11;
+    return EFP1_NR_FENCER_FIELDS - 1;
 }
 
-std::string EFP1Message::ToString(std::string &Buffer) {
-  Buffer = "|";
-  for (int i = 0; i < GetNrOfGeneralFields(); i++) {
-    Buffer = Buffer + mGeneralFields[i] + "|";
-  }
-  Buffer += "%|";
-
-  for (int i = 0; i < GetNrOfFencerFields(); i++) {
-    Buffer = Buffer + mRightFencerFields[i] + "|";
+EFP1Field EFP1Message::operator[](int i) {
+  static char dummy[1];
+  if (i < 0 || i >= MAX_NR_FIELDS) {
+    dummy[0] = '\0';
+    return EFP1Field(dummy, 0); // writes to an invalid index are dropped
   }
-  Buffer += "%|";
-
-  for (int i = 0; i < GetNrOfFencerFields(); i++) {
-    Buffer = Buffer + mLeftFencerFields[i] + "|";
-  }
-  Buffer += "%|";
-  /*if(!(Buffer.Len() < 211))
-      wxLogError("Aha! This is not good: Buffer should never exceed 210");*/
-  return Buffer;
+  return EFP1Field(m_Arena + FieldOffsets[i], FieldCapacity[i]);
 }
-/*
-std::string & EFP1Message::operator [](int i)
-{
-    // Todo: if you use the current field names, it is assumed that the 1.1
-version is used, (So 41 fields: 17 general and 12 for right and 12 for left.
-    // So for the Left fencer
-    if((i < 0) || (i > MAX_NR_FIELDS -1))
-        return mGeneralFields[0];
-    else
-    {
-        if(i < GetNrOfGeneralFields())
-        {
-            return mGeneralFields[i];
-        }
-        else
-        {
-            if(i >= GetNrOfFencerFields() + GetNrOfGeneralFields())
-            {
-                int correction = 0;
-                if(mGeneralFields[0] == "EFP1")
-                    correction = 1;
-                return mLeftFencerFields[i-GetNrOfFencerFields() -
-GetNrOfGeneralFields() - correction];
-            }
-            else
-            {
-                return mRightFencerFields[i - GetNrOfGeneralFields()];
-            }
-        }
-    }
 
+const EFP1Field EFP1Message::operator[](int i) const {
+  return const_cast<EFP1Message &>(*this)[i];
 }
-*/
-std::string &EFP1Message::accessField(std::vector<std::string> &general,
-                                      std::vector<std::string> &right,
-                                      std::vector<std::string> &left, int i) {
-  static std::string emptyString;
-  size_t generalCount = general.size();
-  size_t fencerCount = right.size();
-
-  if (i < 0 || static_cast<size_t>(i) >= generalCount + 2 * fencerCount) {
-    return emptyString;
-  }
 
-  if (static_cast<size_t>(i) < generalCount) {
-    return general[i];
+// Parses "|general|...|%|right|...|%|left|...|%|" directly from the receive
+// buffer. Fields beyond the expected count are ignored; fencer fields are
+// only taken when the left fencer area is present, as before.
+void EFP1Message::Parse(const char *Buffer, size_t Length) {
+  Clear();
+  const char *p = Buffer;
+  const char *end = Buffer + Length;
+  if (p < end && *p)
+    p++; // ignore the initial '|' character
+
+  static const int areaBase[3] = {0, RightFencerBase, LeftFencerBase};
+  static const int areaCount[3] = {EFP1_NR_GENERAL_FIELDS,
+                                   EFP1_NR_FENCER_FIELDS,
+                                   EFP1_NR_FENCER_FIELDS};
+  int area = 0;
+  int field = 0;
+  bool fencersPresent = false;
+  while (p < end && *p && area < 3) {
+    const char *token = p;
+    while (p < end && *p && *p != '|' && *p != '%')
+      p++;
+    // A token ends at '|'; an empty token right before '%' or the end is the
+    // trailing separator of the area, not a field.
+    bool separator = (p < end && *p == '|');
+    if ((separator || p != token) && field < areaCount[area])
+      (*this)[areaBase[area] + field].assign(token, p - token);
+    field++;
+    if (p < end && *p == '%') {
+      area++;
+      field = 0;
+      p++;
+      if (p < end && *p) {
+        if (area == 2)
+          fencersPresent = true;
+        p++; // ignore the initial '|' character of the fencer area
+      }
+    } else if (separator) {
+      p++;
+    }
   }
-
-  i -= generalCount;
-
-  if (static_cast<size_t>(i) < fencerCount && !right.empty()) {
-    return right[i];
+  if (!fencersPresent) {
+    for (int i = RightFencerBase; i < MAX_NR_FIELDS; i++)
+      (*this)[i] = "";
   }
-
-  i -= fencerCount;
-
-  if (static_cast<size_t>(i) < fencerCount && !left.empty()) {
-    return left[i];
-  }
-
-  return emptyString;
+  (*this)[Protocol] = "EFP1.1";
 }
 
-const std::string &
-EFP1Message::accessField(const std::vector<std::string> &general,
-                         const std::vector<std::string> &right,
-                         const std::vector<std::string> &left, int i) {
-  static const std::string emptyString;
-  size_t generalCount = general.size();
-  size_t fencerCount = right.size();
-
-  if (i < 0 || static_cast<size_t>(i) >= generalCount + 2 * fencerCount) {
-    return emptyString;
-  }
-
-  if (static_cast<size_t>(i) < generalCount) {
-    return general[i];
+size_t EFP1Message::ToBuffer(char *Buffer, size_t Size,
+                             uint16_t *FieldOffsets) const {
+  if (!Size)
+    return 0;
+  if (FieldOffsets) {
+    for (int i = 0; i < MAX_NR_FIELDS; i++)
+      FieldOffsets[i] = EFP1_FIELD_NOT_SERIALIZED;
   }
-
-  i -= generalCount;
-
-  if (static_cast<size_t>(i) < fencerCount && !right.empty()) {
-    return right[i];
-  }
-
-  i -= fencerCount;
-
-  if (static_cast<size_t>(i) < fencerCount && !left.empty()) {
-    return left[i];
-  }
-
-  return emptyString;
+  size_t pos = 0;
+  auto put = [&](const char *text) {
+    while (*text && pos + 1 < Size)
+      Buffer[pos++] = *text++;
+  };
+  auto putArea = [&](int base, int count) {
+    for (int i = 0; i < count; i++) {
+      if (FieldOffsets)
+        FieldOffsets[base + i] = pos;
+      put((*this)[base + i].c_str());
+      put("|");
+    }
+  };
+  put("|");
+  putArea(0, GetNrOfGeneralFields());
+  put("%|");
+  putArea(RightFencerBase, GetNrOfFencerFields());
+  put("%|");
+  putArea(LeftFencerBase, GetNrOfFencerFields());
+  put("%|");
+  Buffer[pos] = '\0';
+  return pos;
 }
 
-std::string &EFP1Message::operator[](int i) {
-  return accessField(mGeneralFields, mRightFencerFields, mLeftFencerFields, i);
+uint64_t EFP1Message::ChangedFields(const EFP1Message &Other) const {
+  uint64_t changed = 0;
+  for (int i = 0; i < MAX_NR_FIELDS; i++) {
+    if (strcmp(m_Arena + FieldOffsets[i], Other.m_Arena + FieldOffsets[i]))
+      changed |= EFP1_FIELD_BIT(i);
+  }
+  return changed;
 }
 
-const std::string &EFP1Message::operator[](int i) const {
-  return accessField(mGeneralFields, mRightFencerFields, mLeftFencerFields, i);
+std::string EFP1Message::ToString(std::string &Buffer) {
+  char wire[EFP1_MAX_WIRE_LENGTH];
+  size_t length = ToBuffer(wire, sizeof(wire));
+  Buffer.assign(wire, length);
+  return Buffer;
 }
 
-EFP1Message::EFP1Message(const std::string &Buffer) {
-
-  // Vector of std::string to save tokens
-  char dummy;
-  std::vector<std::string> main_areas;
-  std::stringstream BufferStream(Buffer);
-  BufferStream >> dummy; // used to ignore the initial '|' character
-
-  std::string intermediate;
-
-  // Start by finding the 3 main areas
-  while (getline(BufferStream, intermediate, '%')) {
-    main_areas.push_back(intermediate);
-  }
-
-  std::stringstream GeneralFields(main_areas[0]);
-  while (getline(GeneralFields, intermediate, '|')) {
-    mGeneralFields.push_back(intermediate);
-  }
-  for (int i = mGeneralFields.size(); i < GetNrOfGeneralFields(); i++) {
-    mGeneralFields.push_back("");
-  }
-  mGeneralFields[0] = "EFP1.1";
-
-  if (main_areas.size() > 2) {
-    std::stringstream LeftFencerFields(main_areas[2]);
-    LeftFencerFields >> dummy; // used to ignore the initial '|' character
-    while (getline(LeftFencerFields, intermediate, '|')) {
-      mLeftFencerFields.push_back(intermediate);
-    }
-    while (mLeftFencerFields.size() < GetNrOfFencerFields())
-      mLeftFencerFields.push_back("");
-
-    std::stringstream RightFencerFields(main_areas[1]);
-    RightFencerFields >> dummy; // used to ignore the initial '|' character
-    while (getline(RightFencerFields, intermediate, '|')) {
-      mRightFencerFields.push_back(intermediate);
-    }
-    while (mRightFencerFields.size() < GetNrOfFencerFields())
-      mRightFencerFields.push_back("");
-
-  } else // make sure there are always all sections
-  {
-    for (int i = 0; i < GetNrOfFencerFields(); i++)
-      mLeftFencerFields.push_back("");
-    for (int i = 0; i < GetNrOfFencerFields(); i++)
-      mRightFencerFields.push_back("");
-  }
-
-  // check here if the length is OK for this field
-  /*for(int i=0; i < MAX_NR_FIELDS; i++)
-  {
-      Fields[i].Truncate(EPF1SubMessageLengths[i]);
-  }*/
+std::string EFP1Message::MakeShortMessageString(const char *command) const {
+  char wire[64];
+  snprintf(wire, sizeof(wire), "|%s|%s|%s|%s|%%|", (*this)[Protocol].c_str(),
+           command, (*this)[PisteId].c_str(), (*this)[CompetitionId].c_str());
+  return std::string(wire);
 }
 
 std::string EFP1Message::MakeNextMessageString() {
-  std::string message = "|" + (*this)[Protocol] + "|NEXT|";
-  message = message + (*this)[PisteId] + "|" + (*this)[CompetitionId] + "|%|";
-  return message;
+  return MakeShortMessageString("NEXT");
 }
 std::string EFP1Message::MakePrevMessageString() {
-  std::string message = "|" + (*this)[Protocol] + "|PREV|";
-  message = message + (*this)[PisteId] + "|" + (*this)[CompetitionId] + "|%|";
-  return message;
+  return MakeShortMessageString("PREV");
 }
 
 MessageType EFP1Message::GetType() const {
@@ -248,74 +236,34 @@ MessageType EFP1Message::GetType() const {
   return ERROR;
 }
 
-/*void EFP1Message::CopyIfNotEmpty(const EFP1Message &Source)
-{// we should check if the versions are equal
-    for(int i=0; i < MAX_NR_FIELDS; i++)
-    {
-        if(Source[i] != "")
-        {
-            (*this)[i] = Source[i];
-        }
-    }
-}
-*/
 void EFP1Message::CopyIfNotEmpty(const EFP1Message &Source) {
-  auto copyIfNotEmpty = [](std::vector<std::string> &target,
-                           const std::vector<std::string> &source) {
-    size_t minSize = std::min(target.size(), source.size());
-    for (size_t i = 0; i < minSize; ++i) {
-      if (source[i] != "") {
-        target[i] = source[i];
-      }
+  for (int i = 0; i < MAX_NR_FIELDS; ++i) {
+    if (!Source[i].empty()) {
+      (*this)[i] = Source[i];
     }
-  };
-
-  copyIfNotEmpty(mGeneralFields, Source.mGeneralFields);
-  copyIfNotEmpty(mLeftFencerFields, Source.mLeftFencerFields);
-  copyIfNotEmpty(mRightFencerFields, Source.mRightFencerFields);
+  }
 }
 
-/*void EFP1Message::Prune(const EFP1Message &Source)
-{// we should check if the versions are equal
-
-    for(int i=CompetitionId; i < MAX_NR_FIELDS; i++)
-    {
-        if((*this)[i] == Source[i])
-        {
-            (*this)[i] = "";
-
-        }
-        else
-        {
-          (*this)[i] = Source[i];
-        }
-    }
-
-
-
-}
-*/
 void EFP1Message::Prune(const EFP1Message &Source) {
-  auto pruneVector = [](std::vector<std::string> &target,
-                        const std::vector<std::string> &source) {
-    size_t minSize = std::min(target.size(), source.size());
-    for (size_t i = 0; i < minSize; ++i) {
-      if (target[i] == source[i]) {
-        target[i] = ""; // Set to ""
-      } else {
-        target[i] = source[i];
-      }
+  for (int i = 0; i < MAX_NR_FIELDS; ++i) {
+    if ((*this)[i] == Source[i]) {
+      (*this)[i] = ""; // Set to ""
+    } else {
+      (*this)[i] = Source[i];
     }
-  };
-  pruneVector(mGeneralFields, Source.mGeneralFields);
-  pruneVector(mLeftFencerFields, Source.mLeftFencerFields);
-  pruneVector(mRightFencerFields, Source.mRightFencerFields);
+  }
 }
 
 void EFP1Message::SwapFencersInclScoreCardsEtc() {
-  std::vector<std::string> temp = mRightFencerFields;
-  mRightFencerFields = mLeftFencerFields;
-  mLeftFencerFields = temp;
+  // Both fencer areas have the same layout, so swap them byte by byte.
+  char *right = m_Arena + FieldOffsets[RightFencerBase];
+  char *left = m_Arena + FieldOffsets[LeftFencerBase];
+  size_t length = FieldOffsets[LeftFencerBase] - FieldOffsets[RightFencerBase];
+  for (size_t i = 0; i < length; i++) {
+    char temp = right[i];
+    right[i] = left[i];
+    left[i] = temp;
+  }
 }
 
 void EFP1Message::HandleTeamReserve(bool left, bool value) {
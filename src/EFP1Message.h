@@ -1,9 +1,20 @@
 #ifndef EFP1Message_H
 #define EFP1Message_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
 #include <string>
-#include <vector>
 
 #define MAX_NR_FIELDS 41
+#define EFP1_NR_GENERAL_FIELDS 17
+#define EFP1_NR_FENCER_FIELDS 12
+// Size of the field arena: every field at its maximum length plus terminator
+#define EFP1_ARENA_SIZE 425
+// Longest wire string ToBuffer() can produce (all fields full + separators)
+#define EFP1_MAX_WIRE_LENGTH (EFP1_ARENA_SIZE + 16)
+// Wire offset reported by ToBuffer() for fields that are not serialized
+#define EFP1_FIELD_NOT_SERIALIZED 0xffff
+#define EFP1_FIELD_BIT(field) (1ULL << (field))
 // using namespace std;
 
 enum EPF1SubMessage {
@@ -52,12 +63,68 @@ enum EPF1SubMessage {
 
 enum MessageType { HELLO, DISP, ACK, NAK, INFO, NEXT, PREV, ERROR };
 
+// One field of an EFP1Message, stored in the message's arena. Behaves enough
+// like the std::string it replaces (compare, assign, c_str()) for the
+// protocol code; values longer than the field's capacity are truncated.
+class EFP1Field {
+public:
+  EFP1Field(char *data, uint8_t capacity)
+      : m_Data(data), m_Capacity(capacity) {}
+
+  const char *c_str() const { return m_Data; }
+  size_t size() const;
+  bool empty() const { return m_Data[0] == '\0'; }
+  operator std::string() const { return std::string(m_Data); }
+
+  EFP1Field &operator=(const EFP1Field &other) {
+    return assign(other.m_Data, other.size());
+  }
+  EFP1Field &operator=(const char *value);
+  EFP1Field &operator=(const std::string &value) {
+    return assign(value.data(), value.size());
+  }
+  EFP1Field &operator=(char value) { return assign(&value, 1); }
+  EFP1Field &assign(const char *value, size_t length);
+
+  bool operator==(const char *value) const;
+  bool operator!=(const char *value) const { return !(*this == value); }
+  bool operator==(const std::string &value) const {
+    return *this == value.c_str();
+  }
+  bool operator!=(const std::string &value) const {
+    return !(*this == value.c_str());
+  }
+  bool operator==(const EFP1Field &other) const {
+    return *this == other.m_Data;
+  }
+  bool operator!=(const EFP1Field &other) const { return !(*this == other); }
+
+private:
+  char *m_Data;
+  uint8_t m_Capacity;
+};
+
+inline bool operator==(const char *value, const EFP1Field &field) {
+  return field == value;
+}
+inline bool operator!=(const char *value, const EFP1Field &field) {
+  return field != value;
+}
+inline std::ostream &operator<<(std::ostream &os, const EFP1Field &field) {
+  return os << field.c_str();
+}
+
+// An EFP1 (Cyrano) message. All 41 fields live in one fixed char arena at
+// fixed offsets, so constructing, copying, parsing and serializing a message
+// never touches the heap.
 class EFP1Message {
 public:
   /** Default constructor */
   EFP1Message();
   /** Constructor from string*/
   EFP1Message(const std::string &Buffer);
+  /** Parse in place from a (not necessarily terminated) receive buffer */
+  EFP1Message(const char *Buffer, size_t Length);
   /** Default destructor */
   virtual ~EFP1Message();
 
@@ -67,14 +134,20 @@ public:
    */
   EFP1Message &operator=(const EFP1Message &other);
   std::string ToString(std::string &Buffer);
-  std::string &operator[](int i);
-  const std::string &operator[](int i) const;
+  // Serializes the message in a single pass into Buffer (always terminated).
+  // Returns the length written, excluding the terminator. If FieldOffsets is
+  // given, it receives the wire position of each of the MAX_NR_FIELDS fields.
+  size_t ToBuffer(char *Buffer, size_t Size,
+                  uint16_t *FieldOffsets = nullptr) const;
+  // Bit i (EFP1_FIELD_BIT(i)) is set when field i differs from Other.
+  uint64_t ChangedFields(const EFP1Message &Other) const;
+  EFP1Field operator[](int i);
+  const EFP1Field operator[](int i) const;
   void CopyIfNotEmpty(const EFP1Message &Source);
   void Prune(const EFP1Message &Source);
   void TruncateToMaxLength(void) {
     return;
-  } // ToDo make sure the length of the fields is conform to the specification.
-    // I don't think I really need it.
+  } // Fields are truncated to their capacity on assignment.
   MessageType GetType() const;
   std::string MakeNextMessageString();
   std::string MakePrevMessageString();
@@ -114,22 +187,12 @@ public:
 
 protected:
 private:
-  std::vector<std::string> mGeneralFields; //!< Member variable "mGeneralFields"
-  std::vector<std::string>
-      mLeftFencerFields; //!< Member variable "mLeftFencerFields"
-  std::vector<std::string>
-      mRightFencerFields; //!< Member variable "mRightFencerFields"
-  int const GetNrOfGeneralFields() const { return 17; }
+  char m_Arena[EFP1_ARENA_SIZE]; //!< All fields, NUL terminated, fixed offsets
+  int const GetNrOfGeneralFields() const { return EFP1_NR_GENERAL_FIELDS; }
   int const GetNrOfFencerFields() const;
-  // Overloaded helpers for const and non-const access
-  static std::string &accessField(std::vector<std::string> &general,
-                                  std::vector<std::string> &right,
-                                  std::vector<std::string> &left, int i);
-
-  static const std::string &accessField(const std::vector<std::string> &general,
-                                        const std::vector<std::string> &right,
-                                        const std::vector<std::string> &left,
-                                        int i);
+  void Clear();
+  void Parse(const char *Buffer, size_t Length);
+  std::string MakeShortMessageString(const char *command) const;
 };
 
 #endif // EFP1Message_H
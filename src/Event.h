@@ -0,0 +1,109 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include "EventDefinitions.h"
+#include <stdint.h>
+
+// Typed view of an event word. It holds the same 32 bits as the EVENT_*
+// macros, so queues, observers and ESP-NOW frames are unchanged: an Event
+// converts implicitly to uint32_t. The named constructors and accessors
+// replace hand-written mask-and-shift code, which is where encoding bugs
+// (&& for &, || for |) slipped in. Everything is constexpr; the checks at the
+// bottom run in every build.
+class Event {
+public:
+  constexpr Event() : m_Word(0) {}
+  constexpr explicit Event(uint32_t word) : m_Word(word) {}
+  constexpr operator uint32_t() const { return m_Word; }
+
+  constexpr uint32_t word() const { return m_Word; }
+  constexpr uint32_t type() const { return m_Word & MAIN_TYPE_MASK; }
+  constexpr uint32_t data() const { return m_Word & SUB_TYPE_MASK; }
+  constexpr bool is(uint32_t mainType) const { return type() == mainType; }
+
+  // EVENT_LIGHTS: MASK_* bits
+  static constexpr Event Lights(uint32_t mask) {
+    return Event(EVENT_LIGHTS | (mask & SUB_TYPE_MASK));
+  }
+  constexpr bool has(uint32_t mask) const { return (m_Word & mask) != 0; }
+  // The same lights seen from the other side of the piste: left and right
+  // colours swapped, MASK_REVERSE_COLORS set, buzzer and other bits kept.
+  constexpr Event mirrored() const {
+    return Event((m_Word & ~SIDE_BITS) | MASK_REVERSE_COLORS |
+                 swapped(MASK_RED, MASK_GREEN) |
+                 swapped(MASK_WHITE_L, MASK_WHITE_R) |
+                 swapped(MASK_ORANGE_L, MASK_ORANGE_R));
+  }
+
+  // EVENT_TIMER and EVENT_UW2F_TIMER: minutes, seconds, hundredths
+  static constexpr Event Timer(uint32_t minutes, uint32_t seconds,
+                               uint32_t hundredths) {
+    return Event(EVENT_TIMER | Pack(hundredths, seconds, minutes));
+  }
+  static constexpr Event UW2FTimer(uint32_t seconds) {
+    return Event(EVENT_UW2F_TIMER | Pack(0, seconds % 60, seconds / 60));
+  }
+  constexpr uint32_t minutes() const { return (m_Word >> 16) & 0xff; }
+  constexpr uint32_t seconds() const { return (m_Word >> 8) & 0xff; }
+  constexpr uint32_t hundredths() const { return m_Word & 0xff; }
+
+  // EVENT_SCORE_LEFT / EVENT_SCORE_RIGHT
+  static constexpr Event ScoreLeft(uint32_t score) {
+    return Event(EVENT_SCORE_LEFT | (score & SUB_TYPE_MASK));
+  }
+  static constexpr Event ScoreRight(uint32_t score) {
+    return Event(EVENT_SCORE_RIGHT | (score & SUB_TYPE_MASK));
+  }
+  constexpr uint32_t score() const { return data(); }
+
+  // EVENT_YELLOW_CARD_* / EVENT_RED_CARD_* / EVENT_BLACK_CARD_*: count
+  static constexpr Event Card(uint32_t cardType, uint32_t count) {
+    return Event((cardType & MAIN_TYPE_MASK) | (count & SUB_TYPE_MASK));
+  }
+  constexpr uint32_t count() const { return data(); }
+
+  // EVENT_P_CARD: left in byte 0, right in byte 1
+  static constexpr Event PCards(uint32_t left, uint32_t right) {
+    return Event(EVENT_P_CARD | Pack(left, right, 0));
+  }
+  constexpr uint32_t pCardLeft() const { return m_Word & 0xff; }
+  constexpr uint32_t pCardRight() const { return (m_Word >> 8) & 0xff; }
+
+  // EVENT_ROUND: current round in byte 0, number of rounds in byte 1
+  static constexpr Event Round(uint32_t current, uint32_t rounds) {
+    return Event(EVENT_ROUND | Pack(current, rounds, 0));
+  }
+  constexpr uint32_t round() const { return m_Word & 0xff; }
+  constexpr uint32_t rounds() const { return (m_Word >> 8) & 0xff; }
+
+private:
+  static constexpr uint32_t SIDE_BITS = MASK_RED | MASK_GREEN | MASK_WHITE_L |
+                                        MASK_WHITE_R | MASK_ORANGE_L |
+                                        MASK_ORANGE_R;
+  static constexpr uint32_t Pack(uint32_t byte0, uint32_t byte1,
+                                 uint32_t byte2) {
+    return (byte0 & 0xff) | (byte1 & 0xff) << 8 | (byte2 & 0xff) << 16;
+  }
+  constexpr uint32_t swapped(uint32_t a, uint32_t b) const {
+    return ((m_Word & a) ? b : 0) | ((m_Word & b) ? a : 0);
+  }
+
+  uint32_t m_Word;
+};
+
+static_assert(sizeof(Event) == sizeof(uint32_t), "Event must stay one word");
+static_assert(Event::Timer(3, 0, 0) == 0x01030000, "timer encoding");
+static_assert(Event::Timer(0, 9, 57).hundredths() == 57, "timer decoding");
+static_assert(Event::UW2FTimer(75) == (EVENT_UW2F_TIMER | 0x00010f00),
+              "UW2F timer encoding");
+static_assert(Event::Round(2, 3) == (EVENT_ROUND | 0x0302), "round encoding");
+static_assert(Event::PCards(1, 2).pCardRight() == 2, "P-card decoding");
+static_assert(Event::Card(EVENT_RED_CARD_LEFT, 2).is(EVENT_RED_CARD_LEFT),
+              "card encoding");
+static_assert(Event::ScoreLeft(14).score() == 14, "score decoding");
+static_assert(Event::Lights(MASK_RED | MASK_BUZZ).mirrored() ==
+                  (MASK_GREEN | MASK_BUZZ | MASK_REVERSE_COLORS),
+              "mirrored lights");
+static_assert(Event::Lights(MASK_WHITE_L | MASK_ORANGE_R).mirrored() ==
+                  (MASK_WHITE_R | MASK_ORANGE_L | MASK_REVERSE_COLORS),
+              "mirrored lights");
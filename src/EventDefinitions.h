@@ -206,6 +206,9 @@ union mix_t {
 #define EVENT_WS2812_UNDO_HIT 0x08080000 // low word: 0x0001=left, 0x0002=right
 #define EVENT_WS2812_FLASH_SCORE                                               \
   0x08090000 // low word: 0x0001=left, 0x0002=right
+// Confirmation wait animation (AutoRef double/mixed hit)
+#define EVENT_WS2812_CONFIRMATION_WAIT 0x00FF0000
+#define EVENT_WS2812_CONFIRMATION_END 0x00FF0001
 
 constexpr uint32_t MASK_BUZZ = 0x00000002;
 constexpr uint32_t MASK_GREEN = 0x00000004;
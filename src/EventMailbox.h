@@ -0,0 +1,50 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Latest-value mailbox: N slots, each holding the newest event of one class
+// (timer, score, lights, ...). The observer decides which event goes to which
+// slot.
+//
+// post() may be called from any task and never blocks: it overwrites the
+// slot and raises its pending bit. One consumer task calls take(), which
+// hands over the value of every pending slot once. A value that was
+// overwritten before the consumer got to it is counted, not queued, so a slow
+// display can never hold up the state machine tick.
+template <size_t N> class EventMailbox {
+  static_assert(N >= 1 && N <= 32, "EventMailbox holds 1..32 slots");
+
+public:
+  void post(size_t slot, uint32_t event) {
+    uint32_t bit = 1u << slot;
+    values_[slot].store(event, std::memory_order_relaxed);
+    if (pending_.fetch_or(bit, std::memory_order_release) & bit)
+      overwritten_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Calls handle(uint32_t event) for each pending slot, lowest slot first.
+  // Returns false if nothing was pending.
+  template <typename F> bool take(F handle) {
+    uint32_t pending = pending_.exchange(0, std::memory_order_acquire);
+    for (uint32_t m = pending; m; m &= m - 1)
+      handle(values_[__builtin_ctz(m)].load(std::memory_order_relaxed));
+    return pending != 0;
+  }
+
+  bool empty() const {
+    return pending_.load(std::memory_order_acquire) == 0;
+  }
+
+  // Number of events replaced by a newer one before they were taken.
+  uint32_t overwritten() const {
+    return overwritten_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint32_t> values_[N];
+  std::atomic<uint32_t> pending_{0};
+  std::atomic<uint32_t> overwritten_{0};
+};
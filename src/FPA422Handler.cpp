@@ -254,8 +254,8 @@ void FPA422Handler::WifiPeriodicalUpdate() {
     if (5 == m_SlowWifiPeriodicalUpdateCounter) {
       {
         static const char kStateChars[] = {'F','H','P','W','E','W'};
-        OPP2::SystemState s = Opp2Handler::getInstance().getStateCopy();
-        int idx = static_cast<int>(s.apparatus_state.state);
+        int idx = static_cast<int>(
+            Opp2Handler::getInstance().getApparatusState());
         Message10.SetMachineStatus(kStateChars[idx < 6 ? idx : 3]);
       }
       WifiTransmitMessage(10);
@@ -497,6 +497,26 @@ void FPA422Handler::ProcessLightsChange(uint32_t eventtype) {
   // Message1.Print();
 }
 
+EventMask FPA422Handler::StateMachineEvents() {
+  return EventMask()
+      .add(EVENT_LIGHTS)
+      .add(EVENT_WEAPON)
+      .add(EVENT_SCORE_LEFT)
+      .add(EVENT_SCORE_RIGHT)
+      .add(EVENT_TIMER_STATE)
+      .add(EVENT_TIMER)
+      .add(EVENT_ROUND)
+      .add(EVENT_YELLOW_CARD_LEFT)
+      .add(EVENT_YELLOW_CARD_RIGHT)
+      .add(EVENT_RED_CARD_LEFT)
+      .add(EVENT_RED_CARD_RIGHT)
+      .add(EVENT_BLACK_CARD_LEFT)
+      .add(EVENT_BLACK_CARD_RIGHT)
+      .add(EVENT_P_CARD)
+      .add(EVENT_UW2F_TIMER)
+      .add(EVENT_PRIO);
+}
+
 void FPA422Handler::update(FencingStateMachine *subject, uint32_t eventtype) {
   uint32_t event_data = eventtype & SUB_TYPE_MASK;
   uint32_t maineventtype = eventtype & MAIN_TYPE_MASK;
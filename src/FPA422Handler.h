@@ -33,6 +33,8 @@ public:
   /** Default destructor */
   virtual ~FPA422Handler();
   void update(FencingStateMachine *subject, uint32_t eventtype);
+  // Main event types handled by update(FencingStateMachine *, uint32_t)
+  static EventMask StateMachineEvents();
   void update(Opp2Handler *subject, uint32_t eventtype);
   void ProcessLightsChange(uint32_t eventtype);
 #ifdef ALLOW_BLUETOOTH
@@ -1,13 +1,7 @@
 #include <driver/gpio.h> // Ensure ESP32 GPIO driver is included
 #include <esp32-hal.h>
-
-// ESP32 Register Addresses
-#define GPIO_ENABLE_REG (DR_REG_GPIO_BASE + 0x20)    // GPIO 0-31 direction
-#define GPIO_ENABLE1_REG (DR_REG_GPIO_BASE + 0x24)   // GPIO 32-39 direction
-#define GPIO_OUT_W1TS_REG (DR_REG_GPIO_BASE + 0x08)  // GPIO 0-31 set HIGH
-#define GPIO_OUT_W1TC_REG (DR_REG_GPIO_BASE + 0x0C)  // GPIO 0-31 set LOW
-#define GPIO_OUT1_W1TS_REG (DR_REG_GPIO_BASE + 0x10) // GPIO 32-39 set HIGH
-#define GPIO_OUT1_W1TC_REG (DR_REG_GPIO_BASE + 0x18) // GPIO 32-39 set LOW
+#include <soc/gpio_reg.h>
+#include <soc/io_mux_reg.h>
 
 // Precomputed masks for your GPIOs (21,23,25,5,18,19)
 constexpr uint32_t LOWER_PINS =
@@ -46,12 +40,15 @@ void Set_IODirectionAndValue(uint8_t direction, uint8_t values) {
   REG_WRITE(GPIO_OUT_W1TC_REG, (~lower_levels) & LOWER_PINS); // Set LOW
 
   // --- Higher GPIO33 (32-39) ---
+  // Register writes instead of gpio_set_direction()/gpio_set_level(): the
+  // driver calls take a spinlock and cost several µs per probe. The pad is
+  // routed to GPIO and its pulls are disabled once in MultiWeaponSensor::begin.
   if (direction & 0x01) {
-    gpio_set_direction(GPIO_NUM_33, GPIO_MODE_INPUT);
-    gpio_set_pull_mode(GPIO_NUM_33, GPIO_FLOATING);
+    REG_WRITE(GPIO_ENABLE1_W1TC_REG, HIGHER_PIN_33); // high impedance
   } else {
-    gpio_set_direction(GPIO_NUM_33, GPIO_MODE_OUTPUT);
-    gpio_set_level(GPIO_NUM_33, (values & 0x01));
+    REG_WRITE((values & 0x01) ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG,
+              HIGHER_PIN_33);
+    REG_WRITE(GPIO_ENABLE1_W1TS_REG, HIGHER_PIN_33);
   }
   delayMicroseconds(1); // allow levels to settle before attaching ADC
-}
\ No newline at end of file
+}
@@ -44,4 +44,5 @@
 #define IOValues_cr_cl 32
 #define IOValues_cl_piste 4
 #define IOValues_br_br 16
-extern void Set_IODirectionAndValue(uint8_t direction, uint8_t values);
\ No newline at end of file
+extern void Set_IODirectionAndValue(uint8_t direction, uint8_t values);
+extern void disable_gpio33_pull();
\ No newline at end of file
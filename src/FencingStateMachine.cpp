@@ -22,24 +22,51 @@ static const char *FSM_TAG = "Fencing State Machine:";
 #define IDLE_TIME_MS 1000 * 66 * 3       // 3 minute in milliseconds
 #define TIME_TO_DEEP_SLEEP 1000 * 66 * 6 // 6 minutes in milliseconds
 
+#define FSM_TICK_MS 10 // while the match clock or UW2F timer runs
+// Longest sleep without input; well below the 5 s task watchdog
+#define FSM_MAX_WAIT_MS 1000
+
 volatile SemaphoreHandle_t timerSemaphore_FSMPeriod;
 void IRAM_ATTR onTimer_FSMPeriod() {
   // Give a semaphore that we can check in the loop
   xSemaphoreGiveFromISR(timerSemaphore_FSMPeriod, NULL);
 }
 
-TaskHandle_t StateMachineTask;
+TaskHandle_t StateMachineTask = NULL;
+// The task sleeps until an input arrives (Wake()) or the next deadline passes.
+// Only a running clock needs the 10 ms tick; the timers read esp_timer, so an
+// extra tick in between costs nothing.
 void StateMachineHandler(void *parameter) {
   FencingStateMachine &MyLocalStatemachine = FencingStateMachine::getInstance();
-  TickType_t xLastWakeTime = xTaskGetTickCount();
-  const TickType_t xInterval = pdMS_TO_TICKS(10); // 10 ms interval
   while (true) {
-    vTaskDelayUntil(&xLastWakeTime, xInterval); // Maintains periodicity
+    ulTaskNotifyTake(pdTRUE, MyLocalStatemachine.TicksUntilNextDeadline());
     MyLocalStatemachine.DoStateMachineTick();
     esp_task_wdt_reset();
   }
 }
 
+void FencingStateMachine::Wake() {
+  TaskHandle_t task = StateMachineTask;
+  if (task && task != xTaskGetCurrentTaskHandle())
+    xTaskNotifyGive(task);
+}
+
+TickType_t FencingStateMachine::TicksUntilNextDeadline() {
+  if (m_Timer.IsRunning() || m_UW2FTimer.IsRunning())
+    return pdMS_TO_TICKS(FSM_TICK_MS);
+  // The idle and sleep timeouts are minutes; checking them once per
+  // FSM_MAX_WAIT_MS is plenty
+  uint32_t wait = FSM_MAX_WAIT_MS;
+  if (m_NoHitsAllowed) {
+    uint32_t now = millis();
+    uint32_t rearm = m_timeToRearm > now ? m_timeToRearm - now + 1 : 1;
+    if (rearm < wait)
+      wait = rearm;
+  }
+  TickType_t ticks = pdMS_TO_TICKS(wait);
+  return ticks ? ticks : 1;
+}
+
 FencingStateMachine::FencingStateMachine(int hw_timer_nr, int tickPeriod) {
   // ctor
 
@@ -60,21 +87,25 @@ FencingStateMachine::FencingStateMachine(int hw_timer_nr, int tickPeriod) {
   // timerAlarmEnable(timer_FSMPeriod);
   m_nrOfRounds = 3;
   ResetAll();
-  m_Timer.SetTicksPeriod(tickPeriod);
   // m_Timer.SetDisplayResolution(100);
-  m_low_prio_divider = m_low_prio_divider_init;
 }
 
 void FencingStateMachine::begin() {
   if (m_HasBegun)
     return;
   Preferences mypreferences;
+  uint32_t journalEntries = 0;
   {
     FlashWriteGuard guard; // enable brownout detection while NVS may write
     mypreferences.begin("scoringdevice", false);
     m_MiniDE = mypreferences.getBool("SmallDE", false);
+    // Journal of all inputs, for reproducing disputes. Number of entries
+    // (12 bytes each); 0 = off.
+    journalEntries = mypreferences.getUInt("INPUT_JOURNAL", 0);
     mypreferences.end();
   } // guard destroyed here: brownout detection disabled again
+  if (journalEntries)
+    InputJournal::enable(journalEntries);
 
   xTaskCreatePinnedToCore(StateMachineHandler,   /* Task function. */
                           "StateMachineHandler", /* String with name of task. */
@@ -84,6 +115,9 @@ void FencingStateMachine::begin() {
                           &StateMachineTask,      /* Task handle. */
                           CORE_STATE_MACHINE);
   esp_task_wdt_add(StateMachineTask);
+  // The sensor wakes the task when it queues a lights change
+  if (m_TheSensor)
+    m_TheSensor->SetHitEventTask(StateMachineTask);
 }
 FencingStateMachine::~FencingStateMachine() {
   // dtor
@@ -91,6 +125,7 @@ FencingStateMachine::~FencingStateMachine() {
 
 void FencingStateMachine::update(MultiWeaponSensor *subject,
                                  uint32_t eventtype) {
+  InputJournal::record(InputJournal::JOURNAL_SENSOR, eventtype);
   // SetMachineLights(subject->get_Lights());
   uint32_t maineventtype = eventtype & MAIN_TYPE_MASK;
   if (EVENT_LIGHTS == maineventtype)
@@ -102,9 +137,10 @@ void FencingStateMachine::update(MultiWeaponSensor *subject,
 
 void FencingStateMachine::update(CyranoHandler *subject,
                                  const std::string &eventtype) {
-
+  InputJournal::recordText(eventtype.data(), eventtype.size());
   EFP1Message input(eventtype);
   ProcessDisplayMessage(input);
+  Wake();
 }
 
 void FencingStateMachine::ProcessSpecialSetting(uint32_t eventtype) {
@@ -122,45 +158,23 @@ void FencingStateMachine::ProcessSpecialSetting(uint32_t eventtype) {
 
 void FencingStateMachine::TransmitFullStateToDisplay(
     RepeaterSender *TheRepeater) {
-
-  // StateChanged(EVENT_LIGHTS | m_Lights);   // Wrong, this will cause
-  // everything to transmit
-  TheRepeater->update(this, EVENT_LIGHTS | m_Lights);
-  m_low_prio_divider--;
-  if (!m_low_prio_divider) {
-    m_low_prio_divider = m_low_prio_divider_init;
-
-  } else
-    return;
-  yield();
-  if (m_Timer.IsRunning())
-    return;
-
-  TheRepeater->update(this, EVENT_SCORE_LEFT | m_ScoreLeft);
-
-  TheRepeater->update(this, m_YellowCardLeft | EVENT_YELLOW_CARD_LEFT);
-
-  TheRepeater->update(this, m_RedCardLeft | EVENT_RED_CARD_LEFT);
-
-  TheRepeater->update(this, EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
-  yield();
-
-  TheRepeater->update(this, EVENT_SCORE_RIGHT | m_ScoreRight);
-
-  TheRepeater->update(this, m_YellowCardRight | EVENT_YELLOW_CARD_RIGHT);
-
-  TheRepeater->update(this, m_RedCardRight | EVENT_RED_CARD_RIGHT);
-  yield();
-
-  TheRepeater->update(this, EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
-
-  TheRepeater->update(this, MakeTimerEvent());
-
-  // TheRepeater->update(this,EVENT_UW2F_TIMER | (m_UW2FSeconds/60)<<16 |
-  // (m_UW2FSeconds%60)<<8);
+  // All of this goes out as one snapshot frame; only slots whose value
+  // differs from what the repeater last sent bump its state version.
+  TheRepeater->RefreshSnapshot(EVENT_LIGHTS | m_Lights);
+  TheRepeater->RefreshSnapshot(EVENT_SCORE_LEFT | m_ScoreLeft);
+  TheRepeater->RefreshSnapshot(m_YellowCardLeft | EVENT_YELLOW_CARD_LEFT);
+  TheRepeater->RefreshSnapshot(m_RedCardLeft | EVENT_RED_CARD_LEFT);
+  TheRepeater->RefreshSnapshot(Event::PCards(m_PCardLeft, m_PCardRight));
+  TheRepeater->RefreshSnapshot(EVENT_SCORE_RIGHT | m_ScoreRight);
+  TheRepeater->RefreshSnapshot(m_YellowCardRight | EVENT_YELLOW_CARD_RIGHT);
+  TheRepeater->RefreshSnapshot(m_RedCardRight | EVENT_RED_CARD_RIGHT);
+  TheRepeater->RefreshSnapshot(Event::Round(m_currentRound, m_nrOfRounds));
+  TheRepeater->RefreshSnapshot(MakeTimerEvent());
+  TheRepeater->BroadcastSnapshot();
 }
 
 void FencingStateMachine::update(CyranoHandler *subject, uint32_t eventtype) {
+  InputJournal::record(InputJournal::JOURNAL_CYRANO, eventtype);
   if (EVENT_CYRANO_STATE_LOCKED == eventtype) {
     m_UI_State = LOCKED;
     return;
@@ -171,6 +185,7 @@ void FencingStateMachine::update(CyranoHandler *subject, uint32_t eventtype) {
 }
 
 void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
+  InputJournal::record(InputJournal::JOURNAL_REMOTE, eventtype);
   uint32_t event_data = eventtype & UI_SUB_TYPE_MASK;
 
   uint32_t maineventtype = eventtype & MAIN_TYPE_MASK;
@@ -252,6 +267,7 @@ void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
           m_NoHitsAllowed = false;
         }
       }
+      Wake(); // a running clock needs the 10 ms tick
     }
     break;
 
@@ -339,14 +355,14 @@ void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
     }
     m_currentRound = 1;
 
-    StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+    StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
 
     break;
 
   case UI_NEXT_PERIOD:
     SetNextTimerStateAndRoundAndNewTimeOnTimerZero();
     StateChanged(EVENT_TIMER_STATE);
-    StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+    StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
     StateChanged(MakeTimerEvent());
     break;
 
@@ -467,28 +483,28 @@ void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
 
   case UI_INPUT_P_CARD:
     ProcessUW2F();
-    StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+    StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
     m_UW2FTimer.Reset();
     StateChanged(EVENT_UW2F_TIMER);
     break;
 
   case UI_INPUT_P_CARD_UNDO:
     ProcessUW2FUndo();
-    StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+    StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
 
     break;
 
   case UI_INPUT_BLACK_PCARD_LEFT:
     if (m_PCardLeft == 2) {
       m_PCardLeft += 2;
-      StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+      StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
     }
     break;
 
   case UI_INPUT_BLACK_PCARD_RIGHT:
     if (m_PCardRight == 2) {
       m_PCardRight += 2;
-      StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+      StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
     }
     break;
 
@@ -496,14 +512,14 @@ void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
 
     if (m_PCardLeft == 4) {
       m_PCardLeft = 2;
-      StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+      StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
     }
     break;
 
   case UI_INPUT_BLACK_PCARD_RIGHT_DECR:
     if (m_PCardRight == 4) {
       m_PCardRight = 2;
-      StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+      StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
     }
     break;
 
@@ -515,8 +531,7 @@ void FencingStateMachine::update(UDPIOHandler *subject, uint32_t eventtype) {
 
     m_UW2FTimer.RestorePreviousState();
     m_UW2FSeconds = m_UW2FTimer.GetIntermediateTime();
-    StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                 (m_UW2FSeconds % 60) << 8);
+    StateChanged(Event::UW2FTimer(m_UW2FSeconds));
 
     break;
 
@@ -608,8 +623,7 @@ void FencingStateMachine::ProcessUW2FUndo() {
     m_PCardRight = 0;
     m_UW2FTimer.RestorePreviousState();
     m_UW2FSeconds = m_UW2FTimer.GetIntermediateTime();
-    StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                 (m_UW2FSeconds % 60) << 8);
+    StateChanged(Event::UW2FTimer(m_UW2FSeconds));
     return;
   }
 
@@ -623,8 +637,7 @@ void FencingStateMachine::ProcessUW2FUndo() {
     StateChanged(EVENT_SCORE_LEFT | m_ScoreLeft);
     m_UW2FTimer.RestorePreviousState();
     m_UW2FSeconds = m_UW2FTimer.GetIntermediateTime();
-    StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                 (m_UW2FSeconds % 60) << 8);
+    StateChanged(Event::UW2FTimer(m_UW2FSeconds));
     return;
   }
   if ((m_PCardLeft == 4) &&
@@ -634,18 +647,14 @@ void FencingStateMachine::ProcessUW2FUndo() {
 
     m_UW2FTimer.RestorePreviousState();
     m_UW2FSeconds = m_UW2FTimer.GetIntermediateTime();
-    StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                 (m_UW2FSeconds % 60) << 8);
+    StateChanged(Event::UW2FTimer(m_UW2FSeconds));
     return;
   }
 }
 
 uint32_t FencingStateMachine::MakeTimerEvent() {
-  uint32_t temp = (m_Timer.GetMinutes() << 16 | m_Timer.GetSeconds() << 8 |
-                   m_Timer.GetHundredths());
-
-  temp |= EVENT_TIMER;
-  return temp;
+  return Event::Timer(m_Timer.GetMinutes(), m_Timer.GetSeconds(),
+                      m_Timer.GetHundredths());
 }
 void FencingStateMachine::ClearAllCards(bool bIncludePCards) {
   m_YellowCardLeft = 0;
@@ -692,7 +701,7 @@ void FencingStateMachine::ResetAll() {
   // StateChanged(EVENT_LIGHTS | m_Lights);
   StateChanged(EVENT_SCORE_LEFT | m_ScoreLeft);
   StateChanged(EVENT_SCORE_RIGHT | m_ScoreRight);
-  StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+  StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
   StateChanged(EVENT_PRIO);
   StateChanged(EVENT_RED_CARD_RIGHT);
   StateChanged(EVENT_YELLOW_CARD_RIGHT);
@@ -763,8 +772,7 @@ void FencingStateMachine::SetNextTimerStateAndRoundAndNewTimeOnTimerZero() {
     m_Timer.SetSeconds(FIGHTING_SECONDS);
     m_UW2FTimer.Reset();
     m_UW2FSeconds = 0;
-    StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                 (m_UW2FSeconds % 60) << 8);
+    StateChanged(Event::UW2FTimer(m_UW2FSeconds));
 
     if (m_currentRound < m_nrOfRounds)
       m_currentRound++;
@@ -782,8 +790,42 @@ void FencingStateMachine::SetNextTimerStateAndRoundAndNewTimeOnTimerZero() {
 // As a minimum we should perform a timer tick
 char ChronoString[32];
 int RestartTimerTime;
+void FencingStateMachine::StateChanged(uint32_t eventtype) {
+  if (m_BatchOwner != xTaskGetCurrentTaskHandle()) {
+    notify(eventtype);
+    return;
+  }
+  if (!m_Batch.add(eventtype)) {
+    FlushEvents();
+    m_Batch.add(eventtype);
+  }
+}
+
+void FencingStateMachine::FlushEvents() {
+  if (m_Batch.empty())
+    return;
+  // Observers may raise new events; those start a fresh batch
+  EventBatch batch = m_Batch;
+  m_Batch.clear();
+  notify(batch);
+}
+
 void FencingStateMachine::DoStateMachineTick() {
   bool idle = true;
+  m_BatchOwner = xTaskGetCurrentTaskHandle();
+  // Lights changes come from the sensor core through a lock-free ring, so the
+  // sensor never runs observer code. Only the latest state matters here.
+  if (m_TheSensor) {
+    HitEvent hit;
+    while (m_TheSensor->PopHitEvent(hit)) {
+      uint32_t times[InputJournal::HIT_TIMES] = {
+          (uint32_t)hit.time_us, (uint32_t)hit.contact_left_us,
+          (uint32_t)hit.contact_right_us, (uint32_t)hit.lockout_us};
+      InputJournal::recordHit(hit.event, times);
+      m_LastHitEvent = hit;
+      SetMachineLights(hit.event);
+    }
+  }
   // while (!xSemaphoreTake(timerSemaphore_FSMPeriod, 1 / (portTICK_PERIOD_MS))
   // == pdTRUE); // check with 1 ms timeout
   // while(xSemaphoreTake(timerSemaphore_FSMPeriod, 0) == pdTRUE)
@@ -816,8 +858,11 @@ void FencingStateMachine::DoStateMachineTick() {
         m_UW2FTimer.Stop();
         StateChanged(EVENT_TIMER_STATE);
         StateChanged(MakeTimerEvent());
+        // Observers (AutoRef) must see the end of the period before the
+        // timer is reloaded for the next one
+        FlushEvents();
         SetNextTimerStateAndRoundAndNewTimeOnTimerZero();
-        StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+        StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
       }
 
       StateChanged(MakeTimerEvent());
@@ -826,8 +871,7 @@ void FencingStateMachine::DoStateMachineTick() {
   if (m_UW2FTimer.IsRunning()) {
     if (m_UW2FSeconds != m_UW2FTimer.GetIntermediateTime()) {
       m_UW2FSeconds = m_UW2FTimer.GetIntermediateTime();
-      StateChanged(EVENT_UW2F_TIMER | (m_UW2FSeconds / 60) << 16 |
-                   (m_UW2FSeconds % 60) << 8);
+      StateChanged(Event::UW2FTimer(m_UW2FSeconds));
     }
   }
 
@@ -898,6 +942,95 @@ void FencingStateMachine::DoStateMachineTick() {
       StateChanged(EVENT_WEAPON | WEAPON_MASK_UNKNOWN);
     }
   }
+  m_BatchOwner = NULL;
+  FlushEvents();
+}
+
+void FencingStateMachine::ReplayInput(const InputJournal::Entry &entry) {
+  InputJournal::Replaying replaying;
+  uint32_t value = entry.value;
+  switch (entry.source) {
+  case InputJournal::JOURNAL_HIT:
+    // Applied with its last HIT_TIME, so observers see the times
+    m_LastHitEvent = HitEvent();
+    m_LastHitEvent.event = value;
+    m_ReplayHitTime = 0;
+    break;
+  case InputJournal::JOURNAL_HIT_TIME: {
+    int64_t *times[InputJournal::HIT_TIMES] = {
+        &m_LastHitEvent.time_us, &m_LastHitEvent.contact_left_us,
+        &m_LastHitEvent.contact_right_us, &m_LastHitEvent.lockout_us};
+    if (m_ReplayHitTime >= InputJournal::HIT_TIMES)
+      break; // the hit was lost
+    *times[m_ReplayHitTime++] = value;
+    if (m_ReplayHitTime == InputJournal::HIT_TIMES)
+      SetMachineLights(m_LastHitEvent.event);
+    break;
+  }
+  case InputJournal::JOURNAL_SENSOR:
+    // The weapon itself is journaled by SetMachineWeapon()
+    if (EVENT_LIGHTS == (value & MAIN_TYPE_MASK))
+      SetMachineLights(value);
+    break;
+  case InputJournal::JOURNAL_REMOTE:
+    update((UDPIOHandler *)nullptr, value);
+    break;
+  case InputJournal::JOURNAL_CYRANO:
+    update((CyranoHandler *)nullptr, value);
+    break;
+  case InputJournal::JOURNAL_CYRANO_TEXT:
+    m_ReplayText.clear();
+    m_ReplayTextLength = value;
+    break;
+  case InputJournal::JOURNAL_TEXT:
+    for (int i = 0; i < 4 && m_ReplayText.size() < m_ReplayTextLength; i++)
+      m_ReplayText += (char)(value >> (8 * i));
+    if (m_ReplayTextLength && m_ReplayText.size() == m_ReplayTextLength) {
+      m_ReplayTextLength = 0;
+      update((CyranoHandler *)nullptr, m_ReplayText);
+    }
+    break;
+  case InputJournal::JOURNAL_SET_CLOCK:
+    SetClockFromMs(value);
+    break;
+  case InputJournal::JOURNAL_SET_UW2F:
+    SetUW2FSecondsFromMs(value);
+    break;
+  case InputJournal::JOURNAL_SET: {
+    uint32_t data = value & SUB_TYPE_MASK;
+    switch (value & MAIN_TYPE_MASK) {
+    case EVENT_PRIO:
+      SetPriority((Priority_t)data);
+      break;
+    case EVENT_YELLOW_CARD_LEFT:
+      SetYellowCardLeft(data);
+      break;
+    case EVENT_YELLOW_CARD_RIGHT:
+      SetYellowCardRight(data);
+      break;
+    case EVENT_RED_CARD_LEFT:
+      SetRedCardLeft(data);
+      break;
+    case EVENT_RED_CARD_RIGHT:
+      SetRedCardRight(data);
+      break;
+    case EVENT_SCORE_LEFT:
+      SetScoreLeft(data);
+      break;
+    case EVENT_SCORE_RIGHT:
+      SetScoreRight(data);
+      break;
+    case EVENT_WEAPON:
+      SetMachineWeapon((weapon_t)data);
+      break;
+    case EVENT_P_CARD:
+      m_PCardLeft = data & 0xff;
+      m_PCardRight = (data >> 8) & 0xff;
+      break;
+    }
+    break;
+  }
+  }
 }
 
 #define emptystring ""
@@ -913,8 +1046,8 @@ void FencingStateMachine::ProcessDisplayMessage(const EFP1Message &input) {
 
   if (input[StopWatch] != emptystring) {
     // Do Something with input[StopWatch];
-    uint8_t minutes = 3;
-    uint8_t seconds = 0;
+    int minutes = 3;
+    int seconds = 0;
     sscanf(input[StopWatch].c_str(), "%d:%d", &minutes, &seconds);
     m_Timer.SetMinutes(minutes);
     m_Timer.SetSeconds(seconds);
@@ -936,10 +1069,10 @@ void FencingStateMachine::ProcessDisplayMessage(const EFP1Message &input) {
     if (temp == m_currentRound + 1) {
       SetNextTimerStateAndRoundAndNewTimeOnTimerZero();
       StateChanged(EVENT_TIMER_STATE);
-      StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+      StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
     } else {
       m_currentRound = temp;
-      StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+      StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
     }
   }
   if (input[Weapon] != emptystring) {
@@ -1027,7 +1160,7 @@ void FencingStateMachine::ProcessDisplayMessage(const EFP1Message &input) {
   if (input[RightPCards] != emptystring) {
     // Do Something with input[RightPCards];
     sscanf(input[RightPCards].c_str(), "%d", &m_PCardRight);
-    StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+    StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
   }
 
   if (input[LeftFencerId] != emptystring) {
@@ -1075,7 +1208,7 @@ void FencingStateMachine::ProcessDisplayMessage(const EFP1Message &input) {
   if (input[LeftPCards] != emptystring) {
     // Do Something with input[LeftPCards];
     sscanf(input[LeftPCards].c_str(), "%d", &m_PCardLeft);
-    StateChanged(EVENT_P_CARD | m_PCardLeft | m_PCardRight << 8);
+    StateChanged(Event::PCards(m_PCardLeft, m_PCardRight));
   }
 }
 
@@ -1114,7 +1247,7 @@ bool FencingStateMachine::incrementScoreAndCheckForMinuteBreak(
     if ((8 == m_ScoreRight) || (8 == m_ScoreLeft)) {
       StateChanged(EVENT_TIMER);
       SetNextTimerStateAndRoundAndNewTimeOnTimerZero();
-      StateChanged(EVENT_ROUND | m_currentRound | m_nrOfRounds << 8);
+      StateChanged(Event::Round(m_currentRound, m_nrOfRounds));
       StateChanged(MakeTimerEvent());
       return true;
     }
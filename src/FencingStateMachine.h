@@ -3,21 +3,17 @@
 #define FENCINGSTATEMACHINE_H
 #include "3WeaponSensor.h"
 #include "EFP1Message.h"
+#include "Event.h"
 #include "FencingTimer.h"
+#include "InputJournal.h"
 #include "RepeaterSender.h"
 #include "Singleton.h"
 #include "SubjectObserverTemplate.h"
+#include "TimerState.h"
 #include "UW2FTimer.h"
+#include <Arduino.h>
 
 enum Priority_t { NO_PRIO, PRIO_LEFT, PRIO_RIGHT };
-enum TimerState_t {
-  FIGHTING,
-  BREAK,
-  INJURY,
-  ADDITIONAL_MINUTE,
-  MATCH_ENDED,
-  UNDEFINED
-};
 enum UI_State_t { LOCKED, UNLOCKED };
 // enum weapon_t{FOIL, EPEE, SABRE, UNKNOWN};
 // enum WeaponSelectionMode_t {MANUAL, AUTO, HYBRID};
@@ -41,7 +37,7 @@ public:
   void update(CyranoHandler *subject, uint32_t eventtype);
   void update(CyranoHandler *subject, const std::string &eventtype);
   void TransmitFullStateToDisplay(class RepeaterSender *TheRepeater);
-  void StateChanged(uint32_t eventtype) { notify(eventtype); }
+  void StateChanged(uint32_t eventtype);
   void ProcessDisplayMessage(const EFP1Message &input);
   void PeriodicallyBroadcastFullState(class RepeaterSender *TheRepeater,
                                       long Period = 7919);
@@ -63,6 +59,7 @@ public:
   void SetPriority(Priority_t val) {
     if (val != m_Priority) {
       m_Priority = val;
+      InputJournal::record(InputJournal::JOURNAL_SET, EVENT_PRIO | val);
       m_StateChanged = true;
     }
   }
@@ -76,6 +73,8 @@ public:
   void SetYellowCardLeft(int val) {
     if (val != m_YellowCardLeft) {
       m_YellowCardLeft = val;
+      InputJournal::record(InputJournal::JOURNAL_SET,
+                           EVENT_YELLOW_CARD_LEFT | val);
       m_StateChanged = true;
     }
   }
@@ -89,6 +88,8 @@ public:
   void SetYellowCardRight(int val) {
     if (val != m_YellowCardRight) {
       m_YellowCardRight = val;
+      InputJournal::record(InputJournal::JOURNAL_SET,
+                           EVENT_YELLOW_CARD_RIGHT | val);
       m_StateChanged = true;
     }
   }
@@ -102,6 +103,8 @@ public:
   void SetRedCardLeft(int val) {
     if (val != m_RedCardLeft) {
       m_RedCardLeft = val;
+      InputJournal::record(InputJournal::JOURNAL_SET,
+                           EVENT_RED_CARD_LEFT | val);
       m_StateChanged = true;
     }
   }
@@ -115,6 +118,8 @@ public:
   void SetRedCardRight(int val) {
     if (val != m_RedCardRight) {
       m_RedCardRight = val;
+      InputJournal::record(InputJournal::JOURNAL_SET,
+                           EVENT_RED_CARD_RIGHT | val);
       m_StateChanged = true;
     }
   }
@@ -141,6 +146,7 @@ public:
   void SetScoreLeft(unsigned int val) {
     if (val != m_ScoreLeft) {
       m_ScoreLeft = val;
+      InputJournal::record(InputJournal::JOURNAL_SET, EVENT_SCORE_LEFT | val);
       m_StateChanged = true;
     }
   }
@@ -154,6 +160,7 @@ public:
   void SetScoreRight(unsigned int val) {
     if (val != m_ScoreRight) {
       m_ScoreRight = val;
+      InputJournal::record(InputJournal::JOURNAL_SET, EVENT_SCORE_RIGHT | val);
       m_StateChanged = true;
     }
   }
@@ -169,13 +176,16 @@ public:
   void SetMachineWeapon(weapon_t val) {
     if (val != m_MachineWeapon) {
       m_MachineWeapon = val;
+      InputJournal::record(InputJournal::JOURNAL_SET, EVENT_WEAPON | val);
       m_WeaponChanged = true;
+      Wake();
     }
   }
   void SetMachineLights(uint32_t val) {
     if (val != m_Lights) {
       m_Lights = val;
       m_LightsChanged = true;
+      Wake();
     }
   }
   void RegisterMultiWeaponSensor(MultiWeaponSensor *MySensor) {
@@ -184,12 +194,23 @@ public:
   }
   void ResetAll();
   void SetClockFromMs(uint32_t time_ms) {
+    InputJournal::record(InputJournal::JOURNAL_SET_CLOCK, time_ms);
     m_Timer.SetMinutes(time_ms / 60000);
     m_Timer.SetSeconds((time_ms % 60000) / 1000);
   }
-  void SetUW2FSecondsFromMs(uint32_t time_ms) { m_UW2FSeconds = (long)(time_ms / 1000); m_UW2FTimer.Seed(time_ms); }
-  void SetPCardLeft(int count)  { m_PCardLeft  = count; }
-  void SetPCardRight(int count) { m_PCardRight = count; }
+  void SetUW2FSecondsFromMs(uint32_t time_ms) {
+    InputJournal::record(InputJournal::JOURNAL_SET_UW2F, time_ms);
+    m_UW2FSeconds = (long)(time_ms / 1000);
+    m_UW2FTimer.Seed(time_ms);
+  }
+  void SetPCardLeft(int count) {
+    m_PCardLeft = count;
+    JournalPCards();
+  }
+  void SetPCardRight(int count) {
+    m_PCardRight = count;
+    JournalPCards();
+  }
   uint32_t MakeTimerEvent();
   void GetFormattedStringTime(char *Destination, int MinutePrecision,
                               int HundredthsPrecision) {
@@ -203,7 +224,23 @@ public:
   bool incrementScoreAndCheckForMinuteBreak(bool bLeftFencer);
   uint32_t get_max_score();
   bool GoToSleep() { return m_GoToSleep; };
+  // Last lights change received from the sensor, with µs contact/lockout
+  // times. Opp2Handler publishes them (diag/hit_timing) when it is notified
+  // of the lights; only read it from the state machine task.
+  const HitEvent &GetLastHitEvent() const { return m_LastHitEvent; }
+  // Apply one InputJournal entry through the entry point it was recorded at.
+  // The state machine reads the clock itself, so the replayer sets the clock
+  // to the entry's time_us first, and runs the ticks in between as the task
+  // does; test/host/fsm_replay does this on the host. Nothing is journaled
+  // while an entry is replayed.
+  void ReplayInput(const InputJournal::Entry &entry);
   void begin();
+  // Runs a state machine tick soon. Called by every input that leaves work
+  // for the tick; the task otherwise only wakes for the running clock.
+  void Wake();
+  // How long the task may sleep: 10 ms while a timer runs, until the rearm
+  // deadline after a period end, otherwise at most FSM_MAX_WAIT_MS.
+  TickType_t TicksUntilNextDeadline();
 
 protected:
 private:
@@ -216,8 +253,21 @@ private:
   void SetNextTimerStateAndRoundAndNewTimeOnTimerZero();
   void ProcessUW2F();
   void ProcessUW2FUndo();
+  void FlushEvents();
+  void JournalPCards() {
+    InputJournal::record(InputJournal::JOURNAL_SET,
+                         Event::PCards(m_PCardLeft, m_PCardRight));
+  }
 
   // private member variables
+  // Events raised during DoStateMachineTick, delivered once at its end. Only
+  // the task running the tick (m_BatchOwner) adds to the batch; events from
+  // other tasks are notified immediately.
+  EventBatch m_Batch;
+  TaskHandle_t m_BatchOwner = NULL;
+  std::string m_ReplayText; // EFP1 message being reassembled by ReplayInput
+  size_t m_ReplayTextLength = 0;
+  int m_ReplayHitTime = InputJournal::HIT_TIMES; // next HIT_TIME of the hit
   bool m_StateChanged;
   Priority_t m_Priority;  //!< Member variable "m_Priority"
   int m_YellowCardLeft;   //!< Member variable "m_YellowCardLeft"
@@ -253,12 +303,11 @@ private:
   bool m_NoHitsAllowed = false;
   hw_timer_t *timer_FSMPeriod = NULL;
   MultiWeaponSensor *m_TheSensor = NULL;
+  HitEvent m_LastHitEvent = {};
   long m_NextIdleTime = 0;
   bool m_IsConnectedToRemote = false;
 
   long m_TimeToBroadcastFullState = 0;
-  int m_low_prio_divider = 5;
-  int m_low_prio_divider_init = 7;
 
   bool m_GlobalIdle = false;
   long m_LastLightEventTime = 0;
@@ -1,13 +1,13 @@
 //Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
 #include "FencingTimer.h"
+#include "esp_timer.h"
 #include <iostream>
 //using namespace std;
 FencingTimer::FencingTimer()
 {
     //ctor
 
-    m_ResolutionCounter = m_DisplayResolution;
-    MakeNewString();
+    SetRemainingFromFields();
 }
 
 FencingTimer::~FencingTimer()
@@ -63,70 +63,94 @@ char temp[8];
     }
 }
 
+void FencingTimer::SetRemainingFromFields()
+{
+    m_RemainingUs = ((int64_t)(m_Minutes * 60 + m_Seconds) * 100 + m_Hundredths) * 10000;
+    if(m_TimerIsRunning)
+        m_StartedAtUs = esp_timer_get_time();
+    MakeNewString();
+}
+
+int64_t FencingTimer::GetRemainingUs(int64_t nowUs) const
+{
+    if(!m_TimerIsRunning)
+        return m_RemainingUs;
+    int64_t remaining = m_RemainingUs - (nowUs - m_StartedAtUs);
+    return remaining > 0 ? remaining : 0;
+}
+
+// Above 10 s the display shows whole seconds, rounded up: 3:00 stays until a
+// full second has passed. Below that it shows hundredths, rounded up to
+// m_DisplayResolution, so 0.00 only appears when the time is really over.
+bool FencingTimer::UpdateFields(int64_t remainingUs)
+{
+    uint32_t hundredths = (uint32_t)((remainingUs + 9999) / 10000);
+    if(hundredths >= 1000)
+        hundredths = (hundredths + 99) / 100 * 100;
+    else
+        hundredths = (hundredths + m_DisplayResolution - 1) / m_DisplayResolution * m_DisplayResolution;
+    uint8_t minutes = hundredths / 6000;
+    uint8_t seconds = (hundredths / 100) % 60;
+    uint8_t rest = hundredths % 100;
+    if(minutes == m_Minutes && seconds == m_Seconds && rest == m_Hundredths)
+        return false;
+    m_Minutes = minutes;
+    m_Seconds = seconds;
+    m_Hundredths = rest;
+    MakeNewString();
+    return true;
+}
+
 bool FencingTimer::DoTick()
 {
     if(!m_TimerIsRunning)
         return false;
-    m_Ticks++;
-    if(m_Ticks < m_TicksInOneHundreth)
+    return DoTick(esp_timer_get_time());
+}
+
+bool FencingTimer::DoTick(int64_t nowUs)
+{
+    if(!m_TimerIsRunning)
         return false;
-    m_Ticks = 1;
-    bool returnvalue = false;
-    if(m_Hundredths > 0)
+    int64_t remaining = GetRemainingUs(nowUs);
+    bool changed = UpdateFields(remaining);
+    if(remaining == 0)
     {
-        m_Hundredths--;
-        if(m_ShowingHundredths)
-        {
-            m_ResolutionCounter--;
-            if(!m_ResolutionCounter)
-            {
-                MakeNewString();
-                m_ResolutionCounter = m_DisplayResolution;
-                returnvalue = true;
-            }
-
-        }
-
+        m_TimerIsRunning = false;
+        m_RemainingUs = 0;
+        return true;
     }
-    else
-    {
-        returnvalue = true;
+    return changed;
+}
 
-        if(m_Seconds > 0)
-        {
-            m_Seconds--;
-            m_Hundredths = 99;
-            if((m_Minutes == 0) && (m_Seconds < 10))
-            {
-                m_ShowingHundredths = true;
-                return false;
-            }
-
-            else
-                m_ShowingHundredths = false;
-        }
-        else
-        {
+void FencingTimer::StartTimer()
+{
+    StartTimer(esp_timer_get_time());
+}
 
-            if(m_Minutes > 0)
-            {
-                m_Minutes--;
-                m_Seconds=59;
-                m_Hundredths = 99;
-            }
-
-            else
-            {
-                m_TimerIsRunning = false;
-                return true;
-            }
-            MakeNewString();
-            m_Seconds = 59;
-            return true;
+void FencingTimer::StartTimer(int64_t nowUs)
+{
+    if(m_TimerIsRunning)
+        return;
+    m_StartedAtUs = nowUs;
+    m_TimerIsRunning = true;
+}
 
-        }
-        MakeNewString();
+char *FencingTimer::StopTimer()
+{
+    return StopTimer(esp_timer_get_time());
+}
 
+// Keeps the exact remaining time, so stopping and restarting neither loses
+// nor adds anything; only the display is rounded.
+char *FencingTimer::StopTimer(int64_t nowUs)
+{
+    if(m_TimerIsRunning)
+    {
+        m_RemainingUs = GetRemainingUs(nowUs);
+        m_TimerIsRunning = false;
+        UpdateFields(m_RemainingUs);
     }
-    return returnvalue;
+    MakeNewString();
+    return m_TimerString;
 }
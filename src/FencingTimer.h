@@ -20,7 +20,7 @@ class FencingTimer
         /** Set m_Minutes
          * \param val New value to set
          */
-        void SetMinutes(uint8_t val) { m_Minutes = val; m_Ticks=0; m_Hundredths = 100;MakeNewString();}
+        void SetMinutes(uint8_t val) { m_Minutes = val; m_Hundredths = 0; SetRemainingFromFields();}
         /** Access m_Seconds
          * \return The current value of m_Seconds
          */
@@ -28,7 +28,7 @@ class FencingTimer
         /** Set m_Seconds
          * \param val New value to set
          */
-        void SetSeconds(uint8_t val) { m_Seconds = val; m_Ticks=0;m_Hundredths = 100;MakeNewString();}
+        void SetSeconds(uint8_t val) { m_Seconds = val; m_Hundredths = 0; SetRemainingFromFields();}
         /** Access m_Hundredths
          * \return The current value of m_Hundredths
          */
@@ -36,34 +36,32 @@ class FencingTimer
         /** Set m_Hundredths
          * \param val New value to set
          */
-        void SetHundredths(uint8_t val) { m_Hundredths = val; }
+        void SetHundredths(uint8_t val) { m_Hundredths = val; SetRemainingFromFields();}
         /** Access m_TimerString[5]
          * \return The current value of m_TimerString[5]
          */
         char *GetTimerString() { return m_TimerString; }
 
-        /** Access m_TicksPeriod
-         * \return The current value of m_TicksPeriod
-         */
-        unsigned int GetTicksPeriod() { return m_TicksPeriod;}
-        /** Set m_TicksPeriod
-         * \param val New value to set
-         */
-        void SetTicksPeriod(unsigned int val) { m_TicksPeriod = val; m_TicksInOneHundreth = 10 / m_TicksPeriod;}
-
         /** Set SetDisplayResolution
-         * \param val New value to set
+         * \param val New value to set (hundredths between events below 10 s)
          */
-        void SetDisplayResolution(unsigned int val) { m_DisplayResolution = val; m_ResolutionCounter = val;}
+        void SetDisplayResolution(unsigned int val) { m_DisplayResolution = val ? val : 1;}
 
         bool IsRunning(){return m_TimerIsRunning;}
 
         /** DoTick
-         * \return  true if executing results in new string, false otherwise
+         *  Recompute the displayed time from the clock. Can be called at any
+         *  rate: a late or missed call delays the update, never the clock.
+         * \return  true if the displayed time changed (or zero was reached)
          */
         bool DoTick();
-        void StartTimer(){m_TimerIsRunning = true;}
-        char *StopTimer() { m_TimerIsRunning = false; MakeNewString();return m_TimerString; }
+        bool DoTick(int64_t nowUs);
+        void StartTimer();
+        void StartTimer(int64_t nowUs);
+        char *StopTimer();
+        char *StopTimer(int64_t nowUs);
+        /** Remaining time in microseconds at nowUs */
+        int64_t GetRemainingUs(int64_t nowUs) const;
         void GetFormattedStringTime(char *Destination, int MinutePrecision, int HundredthsPrecision);
         bool ReachedZero(){return (!(m_Minutes+m_Seconds+m_Hundredths));};
 
@@ -72,6 +70,11 @@ class FencingTimer
          *  Determine Display std::string from internal Minutes, Seconds, Hundredths
          */
         void MakeNewString();
+        void SetRemainingFromFields();
+        /** Set Minutes, Seconds, Hundredths to what is shown for remainingUs.
+         * \return true if that differs from what was shown before
+         */
+        bool UpdateFields(int64_t remainingUs);
 
 
     protected:
@@ -81,13 +84,12 @@ class FencingTimer
         uint8_t m_Seconds=0; //!< Member variable "m_Seconds"
         uint8_t m_Hundredths=0; //!< Member variable "m_Hundredths"
         char m_TimerString[16]; //!< Member variable "m_TimerString[16]"
-        unsigned int m_Ticks=0; //!< Member variable "m_Ticks"
-        unsigned int m_TicksPeriod=1; //!< Member variable "m_TicksPeriod (in hundredths of seconds"
-        unsigned int m_TicksInOneHundreth=10;
-        uint8_t m_DisplayResolution = 2;
+        // The clock itself: remaining time when last stopped or set, and the
+        // moment it was started. Minutes/Seconds/Hundredths are derived.
+        int64_t m_RemainingUs = 180000000;
+        int64_t m_StartedAtUs = 0;
+        unsigned int m_DisplayResolution = 2;
         bool m_TimerIsRunning = false;
-        uint8_t m_ResolutionCounter;
-        bool m_ShowingHundredths = false;
 
 };
 
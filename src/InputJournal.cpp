@@ -0,0 +1,166 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "InputJournal.h"
+#include <cstdio>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+InputJournal::Entry *InputJournal::s_Buffer = nullptr;
+uint32_t InputJournal::s_CapacityBits = 0;
+uint32_t InputJournal::s_Serialized = 0;
+std::atomic<uint32_t> InputJournal::s_Head{0};
+std::atomic<bool> InputJournal::s_Enabled{false};
+
+// Longest EFP1 message kept; longer ones are truncated
+static constexpr size_t MAX_TEXT_LENGTH = 1020;
+
+bool InputJournal::enable(size_t entries) {
+  if (s_Buffer)
+    return true;
+  uint32_t bits = 0;
+  while (bits < 16 && ((size_t)2 << bits) <= entries)
+    bits++;
+  size_t capacity = (size_t)1 << bits;
+  if (capacity < 64)
+    return false;
+  size_t bytes = capacity * sizeof(Entry);
+  s_Buffer = (Entry *)heap_caps_calloc(1, bytes,
+                                       MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!s_Buffer)
+    s_Buffer = (Entry *)heap_caps_calloc(1, bytes, MALLOC_CAP_8BIT);
+  if (!s_Buffer) {
+    printf("InputJournal: no memory for %u entries\n", (unsigned)capacity);
+    return false;
+  }
+  s_CapacityBits = bits;
+  s_Enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+void InputJournal::append(Source source, uint32_t value) {
+  uint32_t time_us = (uint32_t)esp_timer_get_time();
+  uint32_t sequence = s_Head.fetch_add(1, std::memory_order_relaxed);
+  Entry &e = s_Buffer[sequence & ((1u << s_CapacityBits) - 1)];
+  e.time_us = time_us;
+  e.value = value;
+  e.source = source;
+  std::atomic_thread_fence(std::memory_order_release);
+  e.lap = lapOf(sequence);
+}
+
+// The message and its TEXT entries are claimed in one go, so they stay
+// together even when another task records at the same time.
+void InputJournal::appendText(const char *text, size_t length) {
+  if (length > MAX_TEXT_LENGTH)
+    length = MAX_TEXT_LENGTH;
+  uint32_t words = (length + 3) / 4;
+  uint32_t time_us = (uint32_t)esp_timer_get_time();
+  uint32_t sequence = s_Head.fetch_add(1 + words, std::memory_order_relaxed);
+  uint32_t mask = (1u << s_CapacityBits) - 1;
+  for (uint32_t i = 0; i <= words; i++) {
+    Entry &e = s_Buffer[(sequence + i) & mask];
+    e.time_us = time_us;
+    if (i == 0) {
+      e.source = JOURNAL_CYRANO_TEXT;
+      e.value = length;
+    } else {
+      size_t offset = (i - 1) * 4;
+      size_t n = length - offset < 4 ? length - offset : 4;
+      e.source = JOURNAL_TEXT;
+      e.value = 0;
+      memcpy(&e.value, text + offset, n);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    e.lap = lapOf(sequence + i);
+  }
+}
+
+// Like appendText: the hit and its times are claimed in one go
+void InputJournal::appendHit(uint32_t event,
+                             const uint32_t (&times_us)[HIT_TIMES]) {
+  uint32_t time_us = (uint32_t)esp_timer_get_time();
+  uint32_t sequence =
+      s_Head.fetch_add(1 + HIT_TIMES, std::memory_order_relaxed);
+  uint32_t mask = (1u << s_CapacityBits) - 1;
+  for (uint32_t i = 0; i <= HIT_TIMES; i++) {
+    Entry &e = s_Buffer[(sequence + i) & mask];
+    e.time_us = time_us;
+    e.source = i == 0 ? JOURNAL_HIT : JOURNAL_HIT_TIME;
+    e.value = i == 0 ? event : times_us[i - 1];
+    std::atomic_thread_fence(std::memory_order_release);
+    e.lap = lapOf(sequence + i);
+  }
+}
+
+// Sequence number up to which every entry has been committed
+uint32_t InputJournal::committedHead() {
+  uint32_t head = s_Head.load(std::memory_order_acquire);
+  uint32_t mask = (1u << s_CapacityBits) - 1;
+  uint32_t from = s_Serialized;
+  if (head - from > mask + 1)
+    from = head - (mask + 1);
+  uint32_t committed = from;
+  while (committed != head &&
+         s_Buffer[committed & mask].lap == lapOf(committed))
+    committed++;
+  return committed;
+}
+
+size_t InputJournal::pendingSize() {
+  if (!isEnabled())
+    return 0;
+  uint32_t head = committedHead();
+  uint32_t from = s_Serialized;
+  uint32_t capacity = 1u << s_CapacityBits;
+  if (head - from > capacity)
+    from = head - capacity;
+  if (head == from)
+    return 0;
+  return sizeof(Header) + (head - from) * sizeof(Entry);
+}
+
+size_t InputJournal::serialize(uint8_t *out, size_t size) {
+  if (!isEnabled() || size < sizeof(Header))
+    return 0;
+  uint32_t head = committedHead();
+  uint32_t mask = (1u << s_CapacityBits) - 1;
+  uint32_t from = s_Serialized;
+  uint32_t lost = 0;
+  if (head - from > mask + 1) {
+    lost = head - from - (mask + 1);
+    from = head - (mask + 1);
+  }
+  uint32_t count = head - from;
+  if (count > (size - sizeof(Header)) / sizeof(Entry))
+    count = (size - sizeof(Header)) / sizeof(Entry);
+
+  Entry *entries = (Entry *)(out + sizeof(Header));
+  for (uint32_t i = 0; i < count; i++) {
+    const Entry &e = s_Buffer[(from + i) & mask];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    entries[i] = e;
+    entries[i].lap = 0;
+  }
+  // A writer that lapped the ring while we copied has overwritten the
+  // oldest entries; report them as lost instead of sending mixed data
+  uint32_t skip = 0;
+  while (skip < count && s_Buffer[(from + skip) & mask].lap != lapOf(from + skip))
+    skip++;
+  if (skip) {
+    memmove(entries, entries + skip, (count - skip) * sizeof(Entry));
+    count -= skip;
+    lost += skip;
+    from += skip;
+  }
+
+  Header header;
+  memcpy(header.magic, "OIJ1", 4);
+  header.header_size = sizeof(Header);
+  header.entry_size = sizeof(Entry);
+  header.first_sequence = from;
+  header.count = count;
+  header.lost = lost;
+  memcpy(out, &header, sizeof(header));
+  s_Serialized = from + count;
+  return sizeof(Header) + count * sizeof(Entry);
+}
@@ -0,0 +1,125 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+// InputJournal records every input of the FencingStateMachine with its time
+// in a RAM ring: lights changes from the sensor, remote and Cyrano commands,
+// and the state OPP2/FPA set directly. When a referee reports a wrong score
+// or a timer jump, the journal holds what the state machine was told and
+// when, and FencingStateMachine::ReplayInput() feeds it back in
+// (test/host/fsm_replay replays a journal on the host).
+//
+// Writers: any task. A writer claims its slot(s) with one atomic add, fills
+// them and commits them by writing the lap number last; it never blocks.
+// Reader: the loop task serializes the entries committed since its previous
+// call (Opp2Handler publishes them), so the broker keeps the whole session.
+//
+// Serialized chunk (little endian), decoded by decode_input_journal.py:
+//   Header  : "OIJ1", u16 header size, u16 entry size, u32 sequence number of
+//             the first entry, u32 entry count, u32 entries lost (overwritten
+//             before they were serialized)
+//   Entries : oldest first, see Entry below.
+
+class InputJournal {
+public:
+  static constexpr size_t DEFAULT_ENTRIES = 2048; // 24 KB
+
+  enum Source : uint8_t {
+    JOURNAL_HIT = 1,     // lights popped from the sensor ring (value: event)
+    JOURNAL_SENSOR,      // update(MultiWeaponSensor *)
+    JOURNAL_REMOTE,      // update(UDPIOHandler *)
+    JOURNAL_CYRANO,      // update(CyranoHandler *, uint32_t)
+    JOURNAL_CYRANO_TEXT, // EFP1 message, value: length; TEXT entries follow
+    JOURNAL_TEXT,        // next 4 bytes of the message (value, little endian)
+    JOURNAL_SET,         // setter called from outside (value: state event)
+    JOURNAL_SET_CLOCK,   // SetClockFromMs (value: ms)
+    JOURNAL_SET_UW2F,    // SetUW2FSecondsFromMs (value: ms)
+    JOURNAL_HIT_TIME     // follows JOURNAL_HIT, see HitTime (value: µs)
+  };
+
+  // The HIT_TIMES entries after a JOURNAL_HIT, in this order: the µs times
+  // of the HitEvent, low 32 bits like Entry::time_us, 0 when not set.
+  enum HitTime {
+    HIT_PUBLISHED,     // the sensor pushed the lights change
+    HIT_CONTACT_LEFT,  // start of the contact that gave the left hit
+    HIT_CONTACT_RIGHT, // start of the contact that gave the right hit
+    HIT_LOCKOUT,       // first hit + weapon lock time
+    HIT_TIMES
+  };
+
+  struct Entry {
+    uint32_t time_us; // low 32 bits of esp_timer_get_time()
+    uint32_t value;
+    uint8_t source;
+    uint8_t lap; // commit marker, internal
+    uint8_t reserved[2];
+  };
+
+  struct Header {
+    char magic[4];
+    uint16_t header_size;
+    uint16_t entry_size;
+    uint32_t first_sequence;
+    uint32_t count;
+    uint32_t lost;
+  };
+
+  // Allocates the ring (rounded down to a power of two, PSRAM when
+  // available) and starts recording. The ring is never freed.
+  static bool enable(size_t entries = DEFAULT_ENTRIES);
+  static bool isEnabled() {
+    return s_Enabled.load(std::memory_order_relaxed);
+  }
+
+  // Nothing is recorded while one exists, from any task. ReplayInput()
+  // holds one, so replaying a journal does not record it a second time.
+  class Replaying {
+  public:
+    Replaying() : m_WasEnabled(s_Enabled.exchange(false)) {}
+    ~Replaying() { s_Enabled.store(m_WasEnabled); }
+    Replaying(const Replaying &) = delete;
+    Replaying &operator=(const Replaying &) = delete;
+
+  private:
+    bool m_WasEnabled;
+  };
+
+  // Writer side, any task. A load and a branch while disabled.
+  static void record(Source source, uint32_t value) {
+    if (isEnabled())
+      append(source, value);
+  }
+  static void recordText(const char *text, size_t length) {
+    if (isEnabled())
+      appendText(text, length);
+  }
+  // JOURNAL_HIT and its HIT_TIME entries
+  static void recordHit(uint32_t event, const uint32_t (&times_us)[HIT_TIMES]) {
+    if (isEnabled())
+      appendHit(event, times_us);
+  }
+
+  // Reader side (one task).
+  // Bytes serialize() needs for the entries not serialized yet; 0 if none.
+  static size_t pendingSize();
+  // Writes a chunk with the pending entries. Returns bytes written.
+  static size_t serialize(uint8_t *out, size_t size);
+
+private:
+  static void append(Source source, uint32_t value);
+  static void appendText(const char *text, size_t length);
+  static void appendHit(uint32_t event, const uint32_t (&times_us)[HIT_TIMES]);
+  static uint8_t lapOf(uint32_t sequence) {
+    return (uint8_t)((sequence >> s_CapacityBits) + 1);
+  }
+  static uint32_t committedHead();
+
+  static Entry *s_Buffer;
+  static uint32_t s_CapacityBits;
+  static uint32_t s_Serialized;
+  static std::atomic<uint32_t> s_Head;
+  static std::atomic<bool> s_Enabled;
+};
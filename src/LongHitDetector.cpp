@@ -1,7 +1,6 @@
 // Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
 #include "LongHitDetector.h"
 #include "EventDefinitions.h"
-#include "esp_timer.h"
 #include <cinttypes>
 
 static constexpr int64_t DEFAULT_DURATION_US = 3000000LL; // 3 s
@@ -32,8 +31,8 @@ void LongHitDetector::reset() {
   state_ = State::IDLE;
 }
 
-void LongHitDetector::update(bool validL, bool validR, bool invalidL,
-                             bool invalidR) {
+void LongHitDetector::update(int64_t now, bool validL, bool validR,
+                             bool invalidL, bool invalidR) {
   // Clear the latch as soon as contact is broken so the channel can re-arm.
   if (!validL)
     latch_validL_ = false;
@@ -46,10 +45,10 @@ void LongHitDetector::update(bool validL, bool validR, bool invalidL,
 
   // Feed each timer: suppress input while latched so they cannot re-fire
   // during a sustained contact that has already produced an event.
-  bool okVL = timer_validL_.update(validL && !latch_validL_);
-  bool okVR = timer_validR_.update(validR && !latch_validR_);
-  bool okIL = timer_invalidL_.update(invalidL && !latch_invalidL_);
-  bool okIR = timer_invalidR_.update(invalidR && !latch_invalidR_);
+  bool okVL = timer_validL_.update(validL && !latch_validL_, now);
+  bool okVR = timer_validR_.update(validR && !latch_validR_, now);
+  bool okIL = timer_invalidL_.update(invalidL && !latch_invalidL_, now);
+  bool okIR = timer_invalidR_.update(invalidR && !latch_invalidR_, now);
 
   // A channel fires exactly once per contact press (rising edge of okXx).
   // Set the latch immediately so the timer sees 'false' from the next cycle.
@@ -73,7 +72,7 @@ void LongHitDetector::update(bool validL, bool validR, bool invalidL,
     return;
 
   handleFired(firedVL, firedVR, firedIL, firedIR, validL, validR, invalidL,
-              invalidR, esp_timer_get_time());
+              invalidR, now);
 }
 
 // ---------------------------------------------------------------------------
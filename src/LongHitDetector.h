@@ -16,7 +16,7 @@
 // Usage:
 //   - Epee / Sabre: pass invalidL = false, invalidR = false (default).
 //   - Foil:        pass all four channels; invalid = off-target contact.
-//   - Call update() every sensor loop iteration.
+//   - Call update() every sensor loop iteration with the scan's timestamp.
 //   - Register observers via attach(); they receive EVENT_LONGHIT | <flags>.
 //   - In the observer, query getLastXxx() for the full hit details.
 
@@ -29,9 +29,10 @@ public:
   setDurationUs(int64_t us); // minimum hold time; default 3 000 000 µs (3 s)
 
   // --- Per-loop call ---
+  // now is the scan's tick time (esp_timer_get_time()).
   // invalidL / invalidR are only relevant for foil; leave as false for
   // epee/sabre.
-  void update(bool validL, bool validR, bool invalidL = false,
+  void update(int64_t now, bool validL, bool validR, bool invalidL = false,
               bool invalidR = false);
 
   // --- Control ---
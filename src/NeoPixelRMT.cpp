@@ -3,14 +3,49 @@
 
 static const char *TAG = "NeoPixelRMT";
 
+uint32_t NeoPixelRMT::nibbleItems[16][4];
+bool NeoPixelRMT::nibbleItemsBuilt = false;
+
+class NeoPixelRMT::Lock {
+public:
+    explicit Lock(SemaphoreHandle_t mutex) : mutex(mutex) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+    }
+    ~Lock() { xSemaphoreGive(mutex); }
+
+private:
+    Lock(const Lock &) = delete;
+    Lock &operator=(const Lock &) = delete;
+    SemaphoreHandle_t mutex;
+};
+
 NeoPixelRMT::NeoPixelRMT(uint16_t numPixels, gpio_num_t pin) :
-    numPixels(numPixels), pin(pin), channel(RMT_CHANNEL_0),
-    pixels(numPixels, 0),
-    items(numPixels * BITS_PER_PIXEL + 1) // +1 for reset pulse
-{}
+    numPixels(numPixels), pin(pin), mutex(xSemaphoreCreateMutex()),
+    channel(RMT_CHANNEL_0), pixels(numPixels, 0)
+{
+    buildNibbleItems();
+    for (int v = 0; v < 256; v++) {
+        levelLut[v] = v;
+    }
+    int numRegions = (numPixels + (1 << REGION_SHIFT) - 1) >> REGION_SHIFT;
+    for (int b = 0; b < NUM_BUFFERS; b++) {
+        items[b].resize(numPixels * BITS_PER_PIXEL + 1); // +1 for reset pulse
+        dirtyRegions[b].assign((numRegions + 31) / 32, 0);
+
+        // Reset pulse: low for >50us to latch data
+        rmt_item32_t &reset = items[b][numPixels * BITS_PER_PIXEL];
+        reset.duration0 = RESET_US * 40; // 40 ticks per us (25ns ticks)
+        reset.level0 = 0;
+        reset.duration1 = 0;
+        reset.level1 = 0;
+    }
+    markDirty(0, numPixels);
+}
 
 NeoPixelRMT::~NeoPixelRMT() {
+    rmt_wait_tx_done(channel, pdMS_TO_TICKS(100));
     rmt_driver_uninstall(channel);
+    vSemaphoreDelete(mutex);
 }
 
 void NeoPixelRMT::begin() {
@@ -42,7 +77,12 @@ void NeoPixelRMT::setPixelColor(uint16_t idx, uint32_t color) {
     uint8_t g = (color >> 8) & 0xFF;
     uint8_t b = color & 0xFF;
 
-    pixels[idx] = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+    uint32_t grbColor = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+    Lock lock(mutex);
+    if (pixels[idx] != grbColor) {
+        pixels[idx] = grbColor;
+        markDirty(idx, idx + 1);
+    }
 }
 
 void NeoPixelRMT::fill(uint32_t color, int startIndex, int count) {
@@ -57,14 +97,29 @@ void NeoPixelRMT::fill(uint32_t color, int startIndex, int count) {
     uint8_t b = color & 0xFF;
     uint32_t grbColor = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
 
+    Lock lock(mutex);
     for (int i = startIndex; i < endIndex; i++) {
-        pixels[i] = grbColor;
+        if (pixels[i] != grbColor) {
+            pixels[i] = grbColor;
+            markDirty(i, i + 1);
+        }
     }
 }
 
 
 void NeoPixelRMT::clear() {
-    std::fill(pixels.begin(), pixels.end(), 0);
+    fill(0, 0, numPixels);
+}
+
+void NeoPixelRMT::markDirty(int startIndex, int endIndex) {
+    int first = startIndex >> REGION_SHIFT;
+    int last = (endIndex - 1) >> REGION_SHIFT;
+    for (int region = first; region <= last; region++) {
+        for (int b = 0; b < NUM_BUFFERS; b++) {
+            dirtyRegions[b][region / 32] |= 1u << (region % 32);
+        }
+    }
+    changed = true;
 }
 
 uint32_t NeoPixelRMT::Color(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness) {
@@ -79,37 +134,96 @@ uint32_t NeoPixelRMT::Color(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness)
     return (r_scaled << 16) | (g_scaled << 8) | b_scaled;
 }
 
-void NeoPixelRMT::encodePixels() {
-    int idx = 0;
-    for (uint16_t i = 0; i < numPixels; i++) {
-        uint32_t color = pixels[i];
-        for (int bit = 23; bit >= 0; bit--) {
-            bool bitIsSet = color & (1 << bit);
-            if (bitIsSet) {
-                items[idx].duration0 = T1H;
-                items[idx].level0 = 1;
-                items[idx].duration1 = T1L;
-                items[idx].level1 = 0;
-            } else {
-                items[idx].duration0 = T0H;
-                items[idx].level0 = 1;
-                items[idx].duration1 = T0L;
-                items[idx].level1 = 0;
+void NeoPixelRMT::buildNibbleItems() {
+    if (nibbleItemsBuilt) return;
+    rmt_item32_t zero = {};
+    zero.duration0 = T0H;
+    zero.level0 = 1;
+    zero.duration1 = T0L;
+    zero.level1 = 0;
+    rmt_item32_t one = {};
+    one.duration0 = T1H;
+    one.level0 = 1;
+    one.duration1 = T1L;
+    one.level1 = 0;
+    for (int nibble = 0; nibble < 16; nibble++) {
+        for (int bit = 0; bit < 4; bit++) {
+            bool bitIsSet = nibble & (0x8 >> bit);
+            nibbleItems[nibble][bit] = bitIsSet ? one.val : zero.val;
+        }
+    }
+    nibbleItemsBuilt = true;
+}
+
+void NeoPixelRMT::setBrightness(uint8_t brightness) {
+    requestedBrightness = brightness;
+}
+
+// Rebuilds levelLut for a new brightness and marks every pixel for
+// re-encoding. Runs in show(), so a concurrent setBrightness() never
+// changes the table halfway through an encode.
+void NeoPixelRMT::applyBrightness() {
+    brightness = requestedBrightness;
+    for (int v = 0; v < 256; v++) {
+        levelLut[v] = (v * brightness) / 255;
+    }
+    markDirty(0, numPixels);
+}
+
+void NeoPixelRMT::encodePixel(int buffer, uint16_t idx) {
+    uint32_t *item = &items[buffer][idx * BITS_PER_PIXEL].val;
+    uint32_t color = pixels[idx];
+    for (int shift = 16; shift >= 0; shift -= 8) {
+        uint8_t level = levelLut[(color >> shift) & 0xFF];
+        const uint32_t *high = nibbleItems[level >> 4];
+        const uint32_t *low = nibbleItems[level & 0x0F];
+        item[0] = high[0];
+        item[1] = high[1];
+        item[2] = high[2];
+        item[3] = high[3];
+        item[4] = low[0];
+        item[5] = low[1];
+        item[6] = low[2];
+        item[7] = low[3];
+        item += 8;
+    }
+}
+
+// Re-encodes only the dirty regions of the buffer; the rest still holds the
+// waveform of the last frame sent from it.
+void NeoPixelRMT::encodePixels(int buffer) {
+    std::vector<uint32_t> &dirty = dirtyRegions[buffer];
+    for (size_t w = 0; w < dirty.size(); w++) {
+        for (uint32_t m = dirty[w]; m; m &= m - 1) {
+            int region = w * 32 + __builtin_ctz(m);
+            int first = region << REGION_SHIFT;
+            int last = std::min<int>(first + (1 << REGION_SHIFT), numPixels);
+            for (int i = first; i < last; i++) {
+                encodePixel(buffer, i);
             }
-            idx++;
         }
+        dirty[w] = 0;
     }
-    // Reset pulse: low for >50us to latch data
-    items[idx].duration0 = RESET_US * 40; // 40 ticks per us (25ns ticks)
-    items[idx].level0 = 0;
-    items[idx].duration1 = 0;
-    items[idx].level1 = 0;
 }
 
 void NeoPixelRMT::show() {
-    encodePixels();
-    gpio_set_level(pin, 0);
-    ets_delay_us(80); // 80us reset pulse
-    ESP_ERROR_CHECK(rmt_write_items(channel, items.data(), items.size(), true));
+    // Held until the frame is queued, so a second show() cannot encode into
+    // the buffer this one is handing to the driver
+    Lock lock(mutex);
+    if (requestedBrightness != brightness) applyBrightness();
+    if (!changed) return; // strip already shows this frame
+    changed = false;
+    // The back buffer is not on the wire: encode while the previous frame is
+    // still being sent. The reset pulse closing that frame separates the two.
+    encodePixels(backBuffer);
+    waitShowDone();
+    std::vector<rmt_item32_t> &frame = items[backBuffer];
+    ESP_ERROR_CHECK(
+        rmt_write_items(channel, frame.data(), frame.size(), false));
+    backBuffer = (backBuffer + 1) % NUM_BUFFERS;
+}
+
+void NeoPixelRMT::waitShowDone() {
+    // Returns as soon as the driver's end-of-transmission interrupt fired
     ESP_ERROR_CHECK(rmt_wait_tx_done(channel, pdMS_TO_TICKS(100)));
 }
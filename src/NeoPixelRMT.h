@@ -1,8 +1,14 @@
 #pragma once
 #include "driver/rmt.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <vector>
 #include <algorithm>
 
+// The LED handler, the animator and the state machine task all paint and
+// show, so every public call takes the strip's lock: show() never encodes a
+// buffer while another task writes its pixels or sends it, and no dirty bit
+// is lost to a concurrent encode.
 class NeoPixelRMT {
 public:
     NeoPixelRMT(uint16_t numPixels, gpio_num_t pin);
@@ -13,22 +19,58 @@ public:
     void setPixelColor(uint16_t idx, uint32_t color);
     void fill(uint32_t color, int startIndex, int count);
     void clear();
+    // Starts sending the frame and returns without waiting for it. Only
+    // pixels changed since the buffer was last used are re-encoded; an
+    // unchanged frame is not sent at all. Waits only if the previous frame
+    // is still on the wire.
     void show();
+    // Blocks until the frame started by the last show() has been sent.
+    void waitShowDone();
+
+    // Scales every channel by brightness/255 while encoding. The stored
+    // pixels keep their full value, so dimming re-encodes the frame on the
+    // next show() without the caller repainting it.
+    void setBrightness(uint8_t brightness);
 
     static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t brightness = 255);
 
 private:
-    void encodePixels();
+    void encodePixels(int buffer);
+    void encodePixel(int buffer, uint16_t idx);
     void setRMTConfig();
+    void markDirty(int startIndex, int endIndex);
+    void applyBrightness();
+    static void buildNibbleItems();
+
+    class Lock; // holds the strip's mutex for one call
 
     static constexpr int BITS_PER_PIXEL = 24;
+    static constexpr int NUM_BUFFERS = 2;
+    // Dirty tracking granularity: one bit per row of 8 pixels
+    static constexpr int REGION_SHIFT = 3;
 
     uint16_t numPixels;
     gpio_num_t pin;
+    SemaphoreHandle_t mutex;
     rmt_channel_t channel;
 
     std::vector<uint32_t> pixels;      // Pixels in GRB order packed
-    std::vector<rmt_item32_t> items;   // RMT waveform data
+    // RMT waveform data. The driver reads the buffer of the frame on the
+    // wire until it is sent, so the next frame is encoded in the other one.
+    std::vector<rmt_item32_t> items[NUM_BUFFERS];
+    // Regions to re-encode in each buffer, one bit per region
+    std::vector<uint32_t> dirtyRegions[NUM_BUFFERS];
+    int backBuffer = 0;  // buffer the next show() encodes and sends
+    bool changed = true; // a pixel changed since the last show()
+
+    // Channel value after brightness scaling, indexed by the stored value
+    uint8_t levelLut[256];
+    uint8_t brightness = 255;                  // brightness levelLut holds
+    volatile uint8_t requestedBrightness = 255; // applied by the next show()
+
+    // RMT items for the 4 bits of every nibble, MSB first
+    static uint32_t nibbleItems[16][4];
+    static bool nibbleItemsBuilt;
 
     // Timing parameters (clock ticks at clk_div=2, 40MHz tick = 25ns)
     static constexpr int T0H = 14; // 350ns
@@ -11,13 +11,21 @@
 #include "CyranoHandler.h"
 #include "EFP1Message.h"
 #include "MDNSResolver.h"
+#include "InputJournal.h"
+#include "RawCapture.h"
 #include "TierAProvisioning.h"
+#include "TimeScoreDisplay.h"
+#include "WS2812BLedStrip.h"
+#include <cstdlib>
 #include <cstring>
 #include <esp_log.h>
+#include <esp_timer.h>
 
 static const char *OPP2_TAG = "OPP2";
 extern const char *mdnsName;             // Defined in CyranoHandler.cpp
 extern AtlasAsyncMqttClient &mqttClient; // Shared MQTT client singleton
+extern TimeScoreDisplay *MyTimeScoreDisplay; // Defined in main.cpp
+extern WS2812B_LedStrip *MyLedStrip;         // Defined in main.cpp
 
 // Boot recovery state — used by CheckConnection() and OnMqttMessageStatic()
 // to intercept the apparatus's own retained topics on the first MQTT connect
@@ -27,6 +35,12 @@ static bool s_bBootRecoveryActive =
     false; // true during the 1000ms recovery window
 static uint32_t s_BootRecoveryStartMs = 0; // millis() when the window opened
 
+// Window length of the scan-loop timing diagnostics (see PublishScanTiming()),
+// also the period of the display event counters (PublishDisplayEvents()).
+static constexpr uint32_t SCAN_TIMING_PERIOD_MS = 10000;
+// Interval between input journal chunks (see PublishInputJournal()).
+static constexpr uint32_t INPUT_JOURNAL_PERIOD_MS = 5000;
+
 // ── Constructor / Destructor ────────────────────────────────────────────────
 
 Opp2Handler::Opp2Handler()
@@ -48,6 +62,7 @@ Opp2Handler::Opp2Handler()
   m_State.match.phase_type =
       OPP2::PhaseType::POOL; // Default to POOL (updated by EVENT_ROUND)
   m_State.match.round = 1;   // Default to round 1
+  m_PublishedState.store(m_State);
 }
 
 Opp2Handler::~Opp2Handler() {
@@ -62,6 +77,23 @@ Opp2Handler::~Opp2Handler() {
   }
 }
 
+// ── State snapshot ──────────────────────────────────────────────────────────
+
+void Opp2Handler::ReleaseState() {
+  m_PublishedState.store(m_State);
+  xSemaphoreGiveRecursive(m_StateMutex);
+}
+
+template <typename F> void Opp2Handler::ReadState(F read) {
+  if (m_PublishedState.tryRead(read))
+    return;
+  // The writer holds the mutex for the whole store, so waiting for it
+  // (with priority inheritance) always ends with a stable m_State.
+  xSemaphoreTakeRecursive(m_StateMutex, portMAX_DELAY);
+  read(m_State);
+  xSemaphoreGiveRecursive(m_StateMutex);
+}
+
 // ── Initialization ──────────────────────────────────────────────────────────
 
 void Opp2Handler::Begin() {
@@ -90,6 +122,7 @@ void Opp2Handler::Begin() {
     snprintf(m_State.piste_id, sizeof(m_State.piste_id), "%u", pisteNr);
     ESP_LOGI(OPP2_TAG, "Using piste number: %u", pisteNr);
   }
+  m_PublishedState.store(m_State);
 
   m_NextPeriodicUpdate = millis() + 10000;
 
@@ -307,7 +340,7 @@ void Opp2Handler::OnMqttMessageStatic(const char *topic, const char *payload,
     if (strstr(topic, "/software/efp1") != nullptr) {
       ESP_LOGD(OPP2_TAG, "[L1] Routing software/efp1 to CyranoHandler");
       CyranoHandler::getInstance().ProcessMessageFromSoftware(
-          EFP1Message((char *)payload), false);
+          EFP1Message((const char *)payload, length), false);
     } else {
       // OPP2 protocol message
       ESP_LOGD(OPP2_TAG, "[OPP2] Routing to Opp2Handler");
@@ -319,8 +352,10 @@ void Opp2Handler::OnMqttMessageStatic(const char *topic, const char *payload,
 }
 
 void Opp2Handler::SetPisteID(const char *pisteId) {
+  xSemaphoreTakeRecursive(m_StateMutex, portMAX_DELAY);
   strncpy(m_State.piste_id, pisteId, sizeof(m_State.piste_id) - 1);
   m_State.piste_id[sizeof(m_State.piste_id) - 1] = '\0';
+  ReleaseState();
 }
 
 // ── Topic Management ────────────────────────────────────────────────────────
@@ -401,7 +436,7 @@ void Opp2Handler::PublishConnection(bool online) {
     }
     snap = m_State.connection;
     snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] PublishConnection() timeout");
     return;
@@ -427,14 +462,10 @@ void Opp2Handler::PublishApparatusState() {
   }
 
   OPP2::ApparatusStateMsg snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.apparatus_state;
-    snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishApparatusState() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) {
+    snap = state.apparatus_state;
+  });
+  snap.seq = NextSeq();
 
   char payloadBuf[512] = {0};
   char topicBuf[64] = {0};
@@ -460,15 +491,9 @@ void Opp2Handler::PublishLights() {
   }
 
   OPP2::Lights snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.lights;
-    snap.seq = NextSeq();
-    snap.ts = CreateTimestamp();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishLights() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.lights; });
+  snap.seq = NextSeq();
+  snap.ts = CreateTimestamp();
 
   char payloadBuf[512] = {0};
   char topicBuf[64] = {0};
@@ -492,14 +517,8 @@ void Opp2Handler::PublishClock() {
 
   // Clock is QoS 0, no sequence number
   OPP2::Clock snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.clock;
-    snap.ts = CreateTimestamp();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishClock() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.clock; });
+  snap.ts = CreateTimestamp();
 
   char payloadBuf[512];
   char topicBuf[64];
@@ -519,14 +538,8 @@ void Opp2Handler::PublishScore() {
   }
 
   OPP2::Score snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.score;
-    snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishScore() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.score; });
+  snap.seq = NextSeq();
 
   char payloadBuf[512] = {0};
   char topicBuf[64] = {0};
@@ -546,14 +559,8 @@ void Opp2Handler::PublishFencers() {
   }
 
   OPP2::Fencers snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.fencers;
-    snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishFencers() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.fencers; });
+  snap.seq = NextSeq();
 
   char payloadBuf[512] = {0};
   char topicBuf[64] = {0};
@@ -574,14 +581,8 @@ void Opp2Handler::PublishMatch() {
   }
 
   OPP2::Match snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.match;
-    snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishMatch() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.match; });
+  snap.seq = NextSeq();
 
   ESP_LOGI(OPP2_TAG, "PublishMatch: weapon=%d type=%d phase_type=%d round=%d",
            static_cast<int>(snap.weapon), static_cast<int>(snap.type),
@@ -621,14 +622,8 @@ void Opp2Handler::PublishUW2F() {
   }
 
   OPP2::UW2F snap;
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    snap = m_State.uw2f;
-    snap.seq = NextSeq();
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PublishUW2F() timeout");
-    return;
-  }
+  ReadState([&](const OPP2::SystemState &state) { snap = state.uw2f; });
+  snap.seq = NextSeq();
 
   char payloadBuf[512] = {0};
   char topicBuf[64] = {0};
@@ -661,6 +656,117 @@ void Opp2Handler::PublishBladeContact(bool active) {
   ESP_LOGD(OPP2_TAG, "Published blade_contact: active=%d", active);
 }
 
+void Opp2Handler::PublishScanTiming() {
+  if (!mqttClient.isConnected())
+    return;
+
+  ScanTimingStats &stats =
+      MultiWeaponSensor::getInstance().getScanTimingStats();
+  char payloadBuf[1536]; // 7 histograms of 16 buckets; loop task stack
+  char topicBuf[80];
+  stats.toJson(payloadBuf, sizeof(payloadBuf));
+  stats.requestReset(); // each message covers one publish window
+  snprintf(topicBuf, sizeof(topicBuf), "openpiste/%s/apparatus/diag/scan_timing",
+           m_State.piste_id);
+  mqttClient.publish(topicBuf, 0, false, payloadBuf); // QoS 0, not retained
+
+  ESP_LOGD(OPP2_TAG, "Published scan timing: %s", payloadBuf);
+}
+
+void Opp2Handler::PublishDisplayEvents() {
+  if (!mqttClient.isConnected() || !MyTimeScoreDisplay || !MyLedStrip)
+    return;
+
+  char payloadBuf[160];
+  char topicBuf[80];
+  snprintf(payloadBuf, sizeof(payloadBuf),
+           "{\"display_overwritten\":%u,\"display_dropped\":%u,"
+           "\"strip_overwritten\":%u,\"animations_dropped\":%u}",
+           (unsigned)MyTimeScoreDisplay->GetOverwrittenEvents(),
+           (unsigned)MyTimeScoreDisplay->GetDroppedEvents(),
+           (unsigned)MyLedStrip->GetOverwrittenEvents(),
+           (unsigned)MyLedStrip->GetDroppedAnimations());
+  snprintf(topicBuf, sizeof(topicBuf),
+           "openpiste/%s/apparatus/diag/display_events", m_State.piste_id);
+  mqttClient.publish(topicBuf, 0, false, payloadBuf); // QoS 0, not retained
+
+  ESP_LOGD(OPP2_TAG, "Published display events: %s", payloadBuf);
+}
+
+void Opp2Handler::PublishRawCapture() {
+  if (!mqttClient.isConnected())
+    return;
+
+  size_t size = RawCapture::serializedSize();
+  uint8_t *payload = (uint8_t *)malloc(size); // up to tens of KB: not on stack
+  if (!payload) {
+    ESP_LOGW(OPP2_TAG, "No memory to publish raw capture (%u bytes)",
+             (unsigned)size);
+    RawCapture::rearm();
+    return;
+  }
+  size = RawCapture::serialize(payload, size);
+  RawCapture::rearm();
+
+  char topicBuf[80];
+  snprintf(topicBuf, sizeof(topicBuf),
+           "openpiste/%s/apparatus/diag/raw_capture", m_State.piste_id);
+  mqttClient.publish(topicBuf, 0, false, payload, size); // QoS 0, not retained
+  free(payload);
+
+  ESP_LOGI(OPP2_TAG, "Published raw capture: %u bytes", (unsigned)size);
+}
+
+void Opp2Handler::PublishInputJournal() {
+  if (!mqttClient.isConnected())
+    return;
+
+  size_t size = InputJournal::pendingSize();
+  if (!size)
+    return;
+  uint8_t *payload = (uint8_t *)malloc(size); // up to 24 KB: not on stack
+  if (!payload) {
+    ESP_LOGW(OPP2_TAG, "No memory to publish input journal (%u bytes)",
+             (unsigned)size);
+    return; // entries stay pending until the next attempt
+  }
+  size = InputJournal::serialize(payload, size);
+
+  char topicBuf[80];
+  snprintf(topicBuf, sizeof(topicBuf),
+           "openpiste/%s/apparatus/diag/input_journal", m_State.piste_id);
+  mqttClient.publish(topicBuf, 0, false, payload, size); // QoS 0, not retained
+  free(payload);
+
+  ESP_LOGD(OPP2_TAG, "Published input journal: %u bytes", (unsigned)size);
+}
+
+void Opp2Handler::PublishHitTiming(const HitEvent &hit) {
+  if (!mqttClient.isConnected())
+    return;
+
+  // Read together: ts_ms is what CreateTimestamp() would report at now_us
+  AbsoluteTime &absTime = AbsoluteTime::getInstance();
+  int64_t now_us = esp_timer_get_time();
+  uint64_t ts_ms = absTime.getTimestamp();
+  char payloadBuf[256];
+  char topicBuf[80];
+  snprintf(payloadBuf, sizeof(payloadBuf),
+           "{\"lights\":%u,\"time_us\":%lld,\"contact_left_us\":%lld,"
+           "\"contact_right_us\":%lld,\"lockout_us\":%lld,\"now_us\":%lld,"
+           "\"ts_ms\":%llu,\"ntp\":%s}",
+           (unsigned)(hit.event & SUB_TYPE_MASK), (long long)hit.time_us,
+           (long long)hit.contact_left_us, (long long)hit.contact_right_us,
+           (long long)hit.lockout_us, (long long)now_us,
+           (unsigned long long)ts_ms,
+           absTime.isSynced() ? "true" : "false");
+  snprintf(topicBuf, sizeof(topicBuf), "openpiste/%s/apparatus/diag/hit_timing",
+           m_State.piste_id);
+  mqttClient.publish(topicBuf, 0, false, payloadBuf); // QoS 0, not retained
+
+  ESP_LOGD(OPP2_TAG, "Published hit timing: %s", payloadBuf);
+}
+
 void Opp2Handler::ProcessLightsChange(uint32_t eventtype) {
   uint32_t event_data = eventtype & SUB_TYPE_MASK;
 
@@ -745,7 +851,7 @@ void Opp2Handler::ProcessUIEvents(uint32_t event) {
         break;
       }
 
-      xSemaphoreGiveRecursive(m_StateMutex);
+      ReleaseState();
     } else {
       ESP_LOGW(OPP2_TAG, "[SWAP] mutex timeout — swap dropped");
       break;
@@ -1003,7 +1109,7 @@ void Opp2Handler::ProcessBootRecovery(const char *topic, const char *payload,
     break;
   }
 
-  xSemaphoreGiveRecursive(m_StateMutex);
+  ReleaseState();
 }
 
 void Opp2Handler::ProcessIncomingControl(const OPP2::Control &msg) {
@@ -1084,7 +1190,7 @@ void Opp2Handler::ClearIdentifyingData() {
   if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
     m_State.fencers = OPP2::Fencers{};
     m_State.match = OPP2::Match{};
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] ClearIdentifyingData() timeout");
     return;
@@ -1096,6 +1202,26 @@ void Opp2Handler::ClearIdentifyingData() {
   notify(EVENT_CYRANO_SEND_INFO);
 }
 
+EventMask Opp2Handler::StateMachineEvents() {
+  return EventMask()
+      .add(EVENT_LIGHTS)
+      .add(EVENT_WEAPON)
+      .add(EVENT_SCORE_LEFT)
+      .add(EVENT_SCORE_RIGHT)
+      .add(EVENT_TIMER_STATE)
+      .add(EVENT_TIMER)
+      .add(EVENT_ROUND)
+      .add(EVENT_YELLOW_CARD_LEFT)
+      .add(EVENT_YELLOW_CARD_RIGHT)
+      .add(EVENT_RED_CARD_LEFT)
+      .add(EVENT_RED_CARD_RIGHT)
+      .add(EVENT_BLACK_CARD_LEFT)
+      .add(EVENT_BLACK_CARD_RIGHT)
+      .add(EVENT_P_CARD)
+      .add(EVENT_UW2F_TIMER)
+      .add(EVENT_PRIO);
+}
+
 void Opp2Handler::update(FencingStateMachine *subject, uint32_t eventtype) {
 
   uint32_t event_data = eventtype & SUB_TYPE_MASK;
@@ -1110,6 +1236,16 @@ void Opp2Handler::update(FencingStateMachine *subject, uint32_t eventtype) {
   case EVENT_LIGHTS:
     ProcessLightsChange(eventtype);
     bTransmit = false; // Already published in ProcessLightsChange
+    {
+      // Observers run on the state machine task, which owns the last hit
+      static const HitEvent none = {};
+      const HitEvent &hit = subject ? subject->GetLastHitEvent() : none;
+      if (hit.time_us != m_LastHitTimingUs &&
+          (hit.contact_left_us || hit.contact_right_us)) {
+        m_LastHitTimingUs = hit.time_us;
+        PublishHitTiming(hit);
+      }
+    }
     break;
 
   case EVENT_WEAPON:
@@ -1478,6 +1614,21 @@ void Opp2Handler::CheckConnection() {
     }
   }
 
+  // Scan-loop timing diagnostics, one window every SCAN_TIMING_PERIOD_MS, and
+  // the display event counters with them.
+  if (m_bConnected && (int32_t)(millis() - m_NextScanTimingPublish) >= 0) {
+    m_NextScanTimingPublish = millis() + SCAN_TIMING_PERIOD_MS;
+    PublishScanTiming();
+    PublishDisplayEvents();
+  }
+  if (m_bConnected && RawCapture::isFrozen())
+    PublishRawCapture();
+  if (m_bConnected && InputJournal::isEnabled() &&
+      (int32_t)(millis() - m_NextInputJournalPublish) >= 0) {
+    m_NextInputJournalPublish = millis() + INPUT_JOURNAL_PERIOD_MS;
+    PublishInputJournal();
+  }
+
   // Close the boot recovery window after 1000ms and publish restored state.
   if (s_bBootRecoveryActive && (millis() - s_BootRecoveryStartMs >= 1000)) {
     s_bBootRecoveryActive = false;
@@ -1519,21 +1670,21 @@ void Opp2Handler::CheckConnection() {
       // FSM setters only set m_StateChanged/m_WeaponChanged flags; the tick
       // emits score/card/timer events only inline, not from those flags.
       // Explicitly broadcast so WS2812B and TimeScoreDisplay update now.
-      m_pFSM->StateChanged(EVENT_SCORE_LEFT | m_State.score.left.score);
-      m_pFSM->StateChanged(EVENT_SCORE_RIGHT | m_State.score.right.score);
-      m_pFSM->StateChanged(EVENT_YELLOW_CARD_LEFT |
-                           (m_State.score.left.yellow_card ? 1 : 0));
-      m_pFSM->StateChanged(EVENT_YELLOW_CARD_RIGHT |
-                           (m_State.score.right.yellow_card ? 1 : 0));
-      m_pFSM->StateChanged(EVENT_RED_CARD_LEFT | m_State.score.left.red_cards);
-      m_pFSM->StateChanged(EVENT_RED_CARD_RIGHT |
-                           m_State.score.right.red_cards);
-      m_pFSM->StateChanged(EVENT_P_CARD | m_State.uw2f.left.p_card |
-                           (m_State.uw2f.right.p_card << 8));
+      m_pFSM->StateChanged(Event::ScoreLeft(m_State.score.left.score));
+      m_pFSM->StateChanged(Event::ScoreRight(m_State.score.right.score));
+      m_pFSM->StateChanged(Event::Card(EVENT_YELLOW_CARD_LEFT,
+                                       m_State.score.left.yellow_card ? 1 : 0));
+      m_pFSM->StateChanged(Event::Card(
+          EVENT_YELLOW_CARD_RIGHT, m_State.score.right.yellow_card ? 1 : 0));
+      m_pFSM->StateChanged(
+          Event::Card(EVENT_RED_CARD_LEFT, m_State.score.left.red_cards));
+      m_pFSM->StateChanged(
+          Event::Card(EVENT_RED_CARD_RIGHT, m_State.score.right.red_cards));
+      m_pFSM->StateChanged(Event::PCards(m_State.uw2f.left.p_card,
+                                         m_State.uw2f.right.p_card));
       m_pFSM->StateChanged(m_pFSM->MakeTimerEvent());
       uint32_t uw2fSec = m_State.uw2f.time_ms / 1000;
-      m_pFSM->StateChanged(EVENT_UW2F_TIMER | (uw2fSec / 60) << 16 |
-                           (uw2fSec % 60) << 8);
+      m_pFSM->StateChanged(Event::UW2FTimer(uw2fSec));
     }
     // Publish recovered state to broker.
     PublishConnection(true);
@@ -1791,7 +1942,7 @@ bool Opp2Handler::updateFromCyranoMessage(
   }
 
   // ── Release mutex before publishing ──────────────────────────────────
-  xSemaphoreGiveRecursive(m_StateMutex);
+  ReleaseState();
 
   // ── Publish updated state to OPP2 MQTT topics ───────────────────────
 
@@ -1843,30 +1994,23 @@ bool Opp2Handler::updateFromCyranoMessage(
 
 OPP2::SystemState Opp2Handler::getStateCopy() {
   OPP2::SystemState copy;
-
-  // Acquire mutex with timeout
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    copy = m_State;
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG,
-             "[MUTEX] getStateCopy() timeout - returning default state");
-    // Return default-initialized state on timeout
-  }
-
+  ReadState([&](const OPP2::SystemState &state) { copy = state; });
   return copy;
 }
 
 void Opp2Handler::getPisteId(char *buffer) {
-  // Acquire mutex with timeout
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    strncpy(buffer, m_State.piste_id, OPP2::PISTE_ID_MAX - 1);
-    buffer[OPP2::PISTE_ID_MAX - 1] = '\0';
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] getPisteId() timeout - returning empty");
-    buffer[0] = '\0';
-  }
+  ReadState([&](const OPP2::SystemState &state) {
+    strncpy(buffer, state.piste_id, OPP2::PISTE_ID_MAX - 1);
+  });
+  buffer[OPP2::PISTE_ID_MAX - 1] = '\0';
+}
+
+OPP2::ApparatusState Opp2Handler::getApparatusState() {
+  OPP2::ApparatusState apparatusState;
+  ReadState([&](const OPP2::SystemState &state) {
+    apparatusState = state.apparatus_state.state;
+  });
+  return apparatusState;
 }
 
 // ════════════════════════════════════════════════════════════════════════════
@@ -1875,16 +2019,7 @@ void Opp2Handler::getPisteId(char *buffer) {
 
 void Opp2Handler::PushCachedStatusToCyrano() {
   // Called after state updates (mutex already released)
-  // Safe to take mutex again for read-only copy
-  OPP2::SystemState stateCopy;
-
-  if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    stateCopy = m_State;
-    xSemaphoreGiveRecursive(m_StateMutex);
-  } else {
-    ESP_LOGW(OPP2_TAG, "[MUTEX] PushCachedStatusToCyrano() timeout");
-    return;
-  }
+  OPP2::SystemState stateCopy = getStateCopy();
 
   // Convert to Cyrano format and push to CyranoHandler
   EFP1Message cyranoStatus = convertOpp2ToCyrano(stateCopy, stateCopy.piste_id);
@@ -1903,7 +2038,7 @@ void Opp2Handler::updateLightsInternal(const OPP2::Lights &lights) {
       m_State.lights = lights;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateLightsInternal() timeout");
     return;
@@ -1927,7 +2062,7 @@ void Opp2Handler::updateScoreInternal(const OPP2::Score &score) {
       m_State.score = score;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateScoreInternal() timeout");
     return;
@@ -1951,7 +2086,7 @@ void Opp2Handler::updateClockInternal(const OPP2::Clock &clock) {
       m_State.clock = clock;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateClockInternal() timeout");
     return;
@@ -1975,7 +2110,7 @@ void Opp2Handler::updateApparatusStateInternal(
       m_State.apparatus_state = apparatusState;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateApparatusStateInternal() timeout");
     return;
@@ -2012,7 +2147,7 @@ void Opp2Handler::updateMatchInternal(const OPP2::Match &match) {
       m_State.match = match;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateMatchInternal() timeout");
     return;
@@ -2037,7 +2172,7 @@ void Opp2Handler::updateUW2FInternal(const OPP2::UW2F &uw2f) {
       m_State.uw2f = uw2f;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateUW2FInternal() timeout");
     return;
@@ -2066,7 +2201,7 @@ bool Opp2Handler::updateFencersExternal(const OPP2::Fencers &fencers,
   if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
     canUpdate =
         (m_State.apparatus_state.state == OPP2::ApparatusState::WAITING);
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateFencersExternal() guard check timeout");
     return false;
@@ -2085,7 +2220,7 @@ bool Opp2Handler::updateFencersExternal(const OPP2::Fencers &fencers,
       m_State.fencers = fencers;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateFencersExternal() update timeout");
     return false;
@@ -2112,7 +2247,7 @@ bool Opp2Handler::updateMatchExternal(const OPP2::Match &match,
   if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
     canUpdate =
         (m_State.apparatus_state.state == OPP2::ApparatusState::WAITING);
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateMatchExternal() guard check timeout");
     return false;
@@ -2131,7 +2266,7 @@ bool Opp2Handler::updateMatchExternal(const OPP2::Match &match,
       m_State.match = match;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateMatchExternal() update timeout");
     return false;
@@ -2175,7 +2310,7 @@ bool Opp2Handler::updateClockExternal(const OPP2::Clock &clock,
   bool canUpdate = false;
   if (xSemaphoreTakeRecursive(m_StateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
     canUpdate = !m_State.clock.running;
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateClockExternal() guard check timeout");
     return false;
@@ -2193,7 +2328,7 @@ bool Opp2Handler::updateClockExternal(const OPP2::Clock &clock,
       m_State.clock = clock;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateClockExternal() update timeout");
     return false;
@@ -2227,7 +2362,7 @@ bool Opp2Handler::updateScoreExternal(const OPP2::Score &score,
       m_State.score = score;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateScoreExternal() update timeout");
     return false;
@@ -2268,7 +2403,7 @@ bool Opp2Handler::updateLightsExternal(const OPP2::Lights &lights,
       m_State.lights = lights;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateLightsExternal() update timeout");
     return false;
@@ -2309,7 +2444,7 @@ bool Opp2Handler::updateApparatusStateExternal(
       m_State.apparatus_state = apparatusState;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateApparatusStateExternal() update timeout");
     return false;
@@ -2343,7 +2478,7 @@ bool Opp2Handler::updateUW2FExternal(const OPP2::UW2F &uw2f,
       m_State.uw2f = uw2f;
       changed = true;
     }
-    xSemaphoreGiveRecursive(m_StateMutex);
+    ReleaseState();
   } else {
     ESP_LOGW(OPP2_TAG, "[MUTEX] updateUW2FExternal() update timeout");
     return false;
@@ -4,10 +4,12 @@
 #include "CyranoHandler.h"
 #include "EventDefinitions.h"
 #include "FencingStateMachine.h"
+#include "SeqLock.h"
 #include "SubjectObserverTemplate.h"
 #include <AtlasAsyncMqttClient.h>
 #include <Preferences.h>
 #include <WiFi.h>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <opp2.h>
@@ -35,6 +37,9 @@ enum class InputProtocol {
  * for all piste state (m_State). All other components read from this state.
  *
  * Thread Safety: m_State is protected by m_StateMutex for dual-core access.
+ * Writers release the mutex through ReleaseState(), which republishes
+ * m_State into a sequence-locked snapshot; readers (Publish*, getters) copy
+ * from that snapshot without taking the mutex.
  * - Core 0 (PRO_CPU): All protocol handlers, FSM, remote control
  * - Core 1 (APP_CPU): 3WeaponSensor (high-frequency hit detection)
  *
@@ -67,6 +72,9 @@ public:
    */
   void update(FencingStateMachine *subject, uint32_t eventtype) override;
 
+  /** Main event types handled by update(FencingStateMachine*, uint32_t). */
+  static EventMask StateMachineEvents();
+
   /**
    * Observer pattern: receive UI events from UDPIOHandler.
    */
@@ -107,18 +115,24 @@ public:
 
   /**
    * Get a thread-safe copy of the complete system state.
-   * Uses mutex protection for dual-core safety.
+   * Reads the published snapshot, so it does not take the mutex.
    * @return Copy of OPP2::SystemState
    */
   OPP2::SystemState getStateCopy();
 
   /**
    * Get piste ID without copying entire state (stack-efficient).
-   * Thread-safe with mutex protection.
+   * Thread-safe, reads the published snapshot.
    * @param buffer Output buffer (must be at least PISTE_ID_MAX bytes)
    */
   void getPisteId(char *buffer);
 
+  /**
+   * Get the apparatus state without copying entire state.
+   * Thread-safe, reads the published snapshot.
+   */
+  OPP2::ApparatusState getApparatusState();
+
   // ── OPP2 to Cyrano Conversion ─────────────────────────────────────────
 
   /**
@@ -287,9 +301,12 @@ private:
   OPP2::SystemState
       m_State; ///< Complete OPP2 piste state (CANONICAL - protected by mutex)
   SemaphoreHandle_t m_StateMutex; ///< Mutex for thread-safe access to m_State
+  SeqLock<OPP2::SystemState>
+      m_PublishedState; ///< Copy of m_State as of the last ReleaseState()
   OPP2::Dispatcher
       m_Dispatcher;      ///< OPP2 message dispatcher for incoming messages
-  uint32_t m_SeqCounter; ///< Global sequence counter for all QoS 1 messages
+  std::atomic<uint32_t>
+      m_SeqCounter; ///< Global sequence counter for all QoS 1 messages
 
   // Protocol selection (for external state updates only)
   InputProtocol
@@ -299,6 +316,9 @@ private:
   // Timing and throttling
   uint32_t m_NextPeriodicUpdate;
   uint32_t m_TimeToShowClock; ///< Throttle clock updates to ~1 Hz
+  uint32_t m_NextScanTimingPublish = 0; ///< Next scan timing diagnostics publish
+  uint32_t m_NextInputJournalPublish = 0; ///< Next input journal publish
+  int64_t m_LastHitTimingUs = 0; ///< HitEvent::time_us of the last hit_timing
 
   // ── Publishing ────────────────────────────────────────────────────────
 
@@ -353,6 +373,45 @@ private:
    */
   void PublishBladeContact(bool active);
 
+  /**
+   * Publish the sensor scan-loop timing histograms (diagnostics, QoS 0, not
+   * retained) to openpiste/{piste_id}/apparatus/diag/scan_timing and start a
+   * new measurement window. Not part of OPP2; meant for field debugging.
+   */
+  void PublishScanTiming();
+
+  /**
+   * Publish the display event counters (diagnostics, QoS 0, not retained) to
+   * openpiste/{piste_id}/apparatus/diag/display_events: states the
+   * TimeScoreDisplay and the LED strip overwrote before showing them, and
+   * commands or animations their queues dropped. The counters run from boot.
+   */
+  void PublishDisplayEvents();
+
+  /**
+   * Publish a frozen raw ADC capture (see RawCapture.h; binary, QoS 0, not
+   * retained) to openpiste/{piste_id}/apparatus/diag/raw_capture and re-arm
+   * the capture. Decode with decode_raw_capture.py.
+   */
+  void PublishRawCapture();
+
+  /**
+   * Publish the InputJournal entries recorded since the previous call
+   * (binary, QoS 0, not retained) to
+   * openpiste/{piste_id}/apparatus/diag/input_journal. Decode with
+   * decode_input_journal.py.
+   */
+  void PublishInputJournal();
+
+  /**
+   * Publish the µs timing of a hit (diagnostics for video replay, QoS 0,
+   * not retained) to openpiste/{piste_id}/apparatus/diag/hit_timing: the
+   * contact starts, the lockout end and when the sensor reported the lights,
+   * all in esp_timer µs. now_us and ts_ms (AbsoluteTime) are read together,
+   * so a consumer can place the other times on the NTP time line.
+   */
+  void PublishHitTiming(const HitEvent &hit);
+
   // ── Event processing ──────────────────────────────────────────────────
 
   /**
@@ -405,7 +464,20 @@ private:
   /**
    * Generate next sequence number (QoS 1 messages only).
    */
-  uint32_t NextSeq() { return ++m_SeqCounter; }
+  uint32_t NextSeq() { return m_SeqCounter.fetch_add(1) + 1; }
+
+  /**
+   * Publish m_State to m_PublishedState and give m_StateMutex. Every writer
+   * uses this instead of xSemaphoreGiveRecursive() so readers see the update.
+   */
+  void ReleaseState();
+
+  /**
+   * Call read(const OPP2::SystemState &) on a consistent copy of the state.
+   * Lock-free in the normal case; falls back to m_StateMutex only if the
+   * snapshot keeps changing underneath (e.g. the writer was preempted).
+   */
+  template <typename F> void ReadState(F read);
 
   /**
    * Build an OPP2 topic for the given message type.
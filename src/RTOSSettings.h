@@ -35,7 +35,7 @@
 #endif
 #define CORE_SENSOR                                                            \
   ESP_TIMER_TASK_CORE          // ESP_TIMER_TASK — controlled via build_flags
-#define CORE_STATE_MACHINE 0   // StateMachineHandler  — 10 ms FSM tick
+#define CORE_STATE_MACHINE 0   // StateMachineHandler  — FSM, event driven
 #define CORE_AUTOREF 0         // AutoRefHandler       — long/double hit queue
 #define CORE_LED_HANDLER 0     // LedStripHandler      — display updates
 #define CORE_LED_ANIMATOR 0    // LedStripAnimator     — animations
@@ -50,7 +50,7 @@
 #define PRIORITY_AUTOREF 1         // AutoRefHandler    — queue-driven
 #define PRIORITY_STARTUP_DISPLAY 0 // StartupDisplayTask — one-shot startup
 #define PRIORITY_LED_HANDLER 4     // LedStripHandler   — display updates
-#define PRIORITY_STATE_MACHINE 6   // StateMachineHandler — 10 ms tick
+#define PRIORITY_STATE_MACHINE 6   // StateMachineHandler — inputs + clock
 #define PRIORITY_ARDUINO_TASK 3    // setup() + loop()  — below FSM/LED tasks
 
 // ---------------------------------------------------------------------------
@@ -79,9 +79,10 @@
 // Queue depths (number of items)
 // All queues carry uint32_t events. Senders use timeout=0 (drop-on-full)
 // because events carry absolute state — the next event reflects the truth.
+// State events for the displays (timer, score, lights) bypass the queues and
+// go to an EventMailbox, which keeps only the latest value of each.
 // ---------------------------------------------------------------------------
-#define QUEUE_DEPTH_TIME_SCORE_DISPLAY 64 // TimeScoreDisplay event queue
-#define QUEUE_DEPTH_LED_STRIP 64          // WS2812B_LedStrip main event queue
+#define QUEUE_DEPTH_TIME_SCORE_DISPLAY 64 // TimeScoreDisplay command queue
 #define QUEUE_DEPTH_LED_ANIMATION 64      // WS2812B_LedStrip animation queue
 #define QUEUE_DEPTH_AUTOREF 64            // AutoRef hit-event queue
 
@@ -0,0 +1,94 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "RawCapture.h"
+#include <cstdio>
+#include <cstring>
+#ifndef SENSOR_HOST_SIM
+#include <esp_heap_caps.h>
+#else
+#include <cstdlib>
+#endif
+
+RawCapture::Sample *RawCapture::s_Buffer = nullptr;
+size_t RawCapture::s_Capacity = 0;
+size_t RawCapture::s_Head = 0;
+bool RawCapture::s_Wrapped = false;
+size_t RawCapture::s_PostTrigger = 0;
+uint32_t RawCapture::s_ScanTime = 0;
+uint32_t RawCapture::s_TriggerTime = 0;
+size_t RawCapture::s_TriggerIndex = 0;
+uint8_t RawCapture::s_Weapon = 0;
+std::atomic<uint8_t> RawCapture::s_State{RawCapture::OFF};
+
+bool RawCapture::enable(size_t samples) {
+  if (!s_Buffer) {
+    if (samples < 2)
+      return false;
+#ifndef SENSOR_HOST_SIM
+    s_Buffer = (Sample *)heap_caps_malloc(samples * sizeof(Sample),
+                                          MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_Buffer)
+      s_Buffer = (Sample *)heap_caps_malloc(samples * sizeof(Sample),
+                                            MALLOC_CAP_8BIT);
+#else
+    s_Buffer = (Sample *)malloc(samples * sizeof(Sample));
+#endif
+    if (!s_Buffer) {
+      printf("RawCapture: no memory for %u samples\n", (unsigned)samples);
+      return false;
+    }
+    s_Capacity = samples;
+  }
+  rearm();
+  return true;
+}
+
+void RawCapture::trigger(uint8_t weapon) {
+  if (s_State.load(std::memory_order_relaxed) != ARMED)
+    return;
+  s_TriggerTime = s_ScanTime;
+  s_TriggerIndex = s_Head;
+  s_Weapon = weapon;
+  s_PostTrigger = s_Capacity / 2;
+  s_State.store(TRIGGERED, std::memory_order_relaxed);
+}
+
+size_t RawCapture::serializedSize() {
+  size_t count = s_Wrapped ? s_Capacity : s_Head;
+  return sizeof(Header) + count * sizeof(Sample);
+}
+
+size_t RawCapture::serialize(uint8_t *out, size_t size) {
+  if (!isFrozen() || size < serializedSize())
+    return 0;
+  size_t count = s_Wrapped ? s_Capacity : s_Head;
+  size_t oldest = s_Wrapped ? s_Head : 0;
+
+  Header header;
+  memcpy(header.magic, "ORC1", 4);
+  header.header_size = sizeof(Header);
+  header.sample_size = sizeof(Sample);
+  header.count = count;
+  // Index of the first sample recorded after the trigger, oldest first.
+  header.trigger_index = (s_TriggerIndex + s_Capacity - oldest) % s_Capacity;
+  header.trigger_time_us = s_TriggerTime;
+  header.weapon = s_Weapon;
+  memset(header.reserved, 0, sizeof(header.reserved));
+  memcpy(out, &header, sizeof(header));
+
+  uint8_t *p = out + sizeof(header);
+  size_t first = s_Wrapped ? s_Capacity - oldest : count;
+  memcpy(p, s_Buffer + oldest, first * sizeof(Sample));
+  memcpy(p + first * sizeof(Sample), s_Buffer,
+         (count - first) * sizeof(Sample));
+  return serializedSize();
+}
+
+void RawCapture::rearm() {
+  uint8_t state = s_State.load(std::memory_order_acquire);
+  if (!s_Buffer || state == ARMED || state == TRIGGERED)
+    return;
+  // The writer is idle in FROZEN and OFF, so the indices can be reset here.
+  s_Head = 0;
+  s_Wrapped = false;
+  s_State.store(ARMED, std::memory_order_release);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+// RawCapture records every raw ADC sample taken by the sensor scan into a
+// circular buffer and freezes it around a hit, so a disputed touch (foil
+// whip-over, epee Dos Santos case, ...) can be looked at afterwards.
+//
+// Lifecycle (single writer = esp_timer task, single reader = loop task):
+//   OFF       : enable() never called; record() is a load and a branch.
+//   ARMED     : every probe is recorded, oldest samples are overwritten.
+//   TRIGGERED : a hit was signalled; recording continues for half a buffer
+//               so the capture holds as much "after" as "before".
+//   FROZEN    : the writer stops; the reader serializes the buffer and calls
+//               rearm().
+//
+// Serialized format (little endian), decoded by decode_raw_capture.py:
+//   Header  : "ORC1", u16 header size, u16 sample size, u32 sample count,
+//             u32 trigger sample index, u32 trigger time (µs), u8 weapon,
+//             3 bytes padding
+//   Samples : oldest first, see Sample below.
+
+class RawCapture {
+public:
+  static constexpr size_t DEFAULT_SAMPLES = 4096; // 32 KB, ~160 ms of foil
+
+  struct Sample {
+    uint32_t time_us;  // low 32 bits of esp_timer_get_time() of the scan
+    uint16_t raw;      // bits 0..11 ADC value, bits 12..14 ADC1 channel
+    uint8_t direction; // Set_IODirectionAndValue() arguments of the probe
+    uint8_t values;
+  };
+
+  struct Header {
+    char magic[4];
+    uint16_t header_size;
+    uint16_t sample_size;
+    uint32_t count;
+    uint32_t trigger_index;
+    uint32_t trigger_time_us;
+    uint8_t weapon;
+    uint8_t reserved[3];
+  };
+
+  // Allocates the buffer (PSRAM when available) and arms the capture.
+  // The buffer is never freed, so the writer can't see it disappear.
+  static bool enable(size_t samples = DEFAULT_SAMPLES);
+  static void disable() { s_State.store(OFF, std::memory_order_release); }
+
+  // Writer side (esp_timer task).
+  static void beginScan(uint32_t time_us) { s_ScanTime = time_us; }
+  static void record(uint8_t direction, uint8_t values, uint8_t channel,
+                     int raw) {
+    uint8_t state = s_State.load(std::memory_order_relaxed);
+    if (state != ARMED && state != TRIGGERED)
+      return;
+    Sample &s = s_Buffer[s_Head];
+    s.time_us = s_ScanTime;
+    s.raw = (uint16_t)((raw & 0x0fff) | ((channel & 0x07) << 12));
+    s.direction = direction;
+    s.values = values;
+    if (++s_Head == s_Capacity) {
+      s_Head = 0;
+      s_Wrapped = true;
+    }
+    if (state == TRIGGERED && --s_PostTrigger == 0)
+      s_State.store(FROZEN, std::memory_order_release);
+  }
+  static void trigger(uint8_t weapon);
+
+  // Reader side (loop task).
+  static bool isFrozen() {
+    return s_State.load(std::memory_order_acquire) == FROZEN;
+  }
+  // Bytes needed by serialize() for the current capture.
+  static size_t serializedSize();
+  // Writes header + samples; only valid while frozen. Returns bytes written.
+  static size_t serialize(uint8_t *out, size_t size);
+  static void rearm();
+
+private:
+  enum State : uint8_t { OFF, ARMED, TRIGGERED, FROZEN };
+
+  static Sample *s_Buffer;
+  static size_t s_Capacity;
+  static size_t s_Head;
+  static bool s_Wrapped;
+  static size_t s_PostTrigger;
+  static uint32_t s_ScanTime;
+  static uint32_t s_TriggerTime;
+  static size_t s_TriggerIndex;
+  static uint8_t s_Weapon;
+  static std::atomic<uint8_t> s_State;
+};
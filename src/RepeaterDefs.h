@@ -1,14 +1,123 @@
 //Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
 #ifndef REPEATERDEFS_H
 #define REPEATERDEFS_H
-enum MessageType_t {EVENT, HEARTBEAT, PAIRING_REQUEST};
+#include "Event.h"
+#include "EventDefinitions.h"
+#include <stddef.h>
+#include <stdint.h>
+enum MessageType_t {EVENT, HEARTBEAT, PAIRING_REQUEST, STATE_SNAPSHOT};
+// EVENT frame (delta): one state machine event. messagenumber is the state
+// version after applying it.
 typedef struct struct_message {
   MessageType_t type;
   uint32_t event;
   int piste_ID;
   long messagenumber;
 } struct_message;
+
+// Slots of the state snapshot: for each main event type that describes what
+// a repeater displays, the last event of that type.
+enum RepeaterSlot_t {
+  SLOT_LIGHTS,
+  SLOT_SCORE_LEFT,
+  SLOT_SCORE_RIGHT,
+  SLOT_TIMER,
+  SLOT_ROUND,
+  SLOT_PRIO,
+  SLOT_YELLOW_CARD_LEFT,
+  SLOT_YELLOW_CARD_RIGHT,
+  SLOT_RED_CARD_LEFT,
+  SLOT_RED_CARD_RIGHT,
+  SLOT_BLACK_CARD_LEFT,
+  SLOT_BLACK_CARD_RIGHT,
+  SLOT_P_CARD,
+  SLOT_UW2F_TIMER,
+  REPEATER_NUM_SLOTS
+};
+
+// Snapshot slot of an event, -1 for events that are only sent as deltas
+inline int RepeaterSlot(uint32_t event) {
+  switch (event & MAIN_TYPE_MASK) {
+  case EVENT_LIGHTS: return SLOT_LIGHTS;
+  case EVENT_SCORE_LEFT: return SLOT_SCORE_LEFT;
+  case EVENT_SCORE_RIGHT: return SLOT_SCORE_RIGHT;
+  case EVENT_TIMER: return SLOT_TIMER;
+  case EVENT_ROUND: return SLOT_ROUND;
+  case EVENT_PRIO: return SLOT_PRIO;
+  case EVENT_YELLOW_CARD_LEFT: return SLOT_YELLOW_CARD_LEFT;
+  case EVENT_YELLOW_CARD_RIGHT: return SLOT_YELLOW_CARD_RIGHT;
+  case EVENT_RED_CARD_LEFT: return SLOT_RED_CARD_LEFT;
+  case EVENT_RED_CARD_RIGHT: return SLOT_RED_CARD_RIGHT;
+  case EVENT_BLACK_CARD_LEFT: return SLOT_BLACK_CARD_LEFT;
+  case EVENT_BLACK_CARD_RIGHT: return SLOT_BLACK_CARD_RIGHT;
+  case EVENT_P_CARD: return SLOT_P_CARD;
+  case EVENT_UW2F_TIMER: return SLOT_UW2F_TIMER;
+  default: return -1;
+  }
+}
+
+// STATE_SNAPSHOT frame: the complete displayed state in one packet.
+// messagenumber is the state version it reflects; a repeater that applies it
+// is up to date no matter which deltas it missed.
+//
+// Repeaters with firmware from before snapshots copy every frame into a
+// struct_message without looking at type or length, and only check
+// piste_ID. The snapshot therefore starts like a struct_message for a piste
+// that does not exist: they drop it as a frame for another piste. magic
+// carries the snapshot format; a receiver drops snapshots whose magic it
+// does not know, so the layout can change by changing the magic.
+#define REPEATER_SNAPSHOT_MAGIC 0x31535352 // "RSS1"
+#define REPEATER_NOT_A_PISTE INT32_MIN     // MasterPiste -1 means unpaired
+
+typedef struct struct_snapshot {
+  MessageType_t type;  // STATE_SNAPSHOT
+  uint32_t magic;      // REPEATER_SNAPSHOT_MAGIC, at struct_message::event
+  int32_t notAPiste;   // REPEATER_NOT_A_PISTE, at struct_message::piste_ID
+  long messagenumber;
+  int piste_ID;
+  uint32_t session;    // random per boot of the sender
+  uint32_t validSlots; // bit per RepeaterSlot_t that has been set
+  uint32_t slot[REPEATER_NUM_SLOTS];
+} struct_snapshot;
+
+static_assert(offsetof(struct_snapshot, notAPiste) ==
+                  offsetof(struct_message, piste_ID),
+              "old repeaters must read the snapshot as another piste");
+
 #define FULL_STATUS_REPETITION_PERIOD 1021
 #define MESSAGE_REPETITION_FACTOR 4
+#define LIGHTS_REPETITION_FACTOR 7
+
+// Resends a delta gets after its first send. Running hundredths are replaced
+// by the next tick anyway: -1, no resends of their own, but the sender keeps
+// those still due for an older change.
+inline int RepeaterResends(uint32_t event) {
+  Event e(event);
+  if (e.is(EVENT_TIMER) && e.hundredths())
+    return -1;
+  return e.is(EVENT_LIGHTS) ? LIGHTS_REPETITION_FACTOR
+                            : MESSAGE_REPETITION_FACTOR;
+}
+
+// The event as a mirrored repeater, on the other side of the piste, shows
+// it: lights, scores, priority, yellow/red cards and P-cards change sides.
+inline uint32_t RepeaterMirrored(uint32_t event) {
+  Event e(event);
+  switch (e.type()) {
+  case EVENT_LIGHTS: return e.mirrored();
+  case EVENT_SCORE_LEFT: return EVENT_SCORE_RIGHT | e.data();
+  case EVENT_SCORE_RIGHT: return EVENT_SCORE_LEFT | e.data();
+  case EVENT_PRIO:
+    if (e.data() == 1 || e.data() == 2)
+      return EVENT_PRIO | (3 - e.data());
+    return event;
+  case EVENT_YELLOW_CARD_LEFT: return EVENT_YELLOW_CARD_RIGHT | e.data();
+  case EVENT_YELLOW_CARD_RIGHT: return EVENT_YELLOW_CARD_LEFT | e.data();
+  case EVENT_RED_CARD_LEFT: return EVENT_RED_CARD_RIGHT | e.data();
+  case EVENT_RED_CARD_RIGHT: return EVENT_RED_CARD_LEFT | e.data();
+  case EVENT_P_CARD: return Event::PCards(e.pCardRight(), e.pCardLeft());
+  default: return event;
+  }
+}
 
 #endif // REPEATERDEFS_H
@@ -8,26 +8,29 @@
 #include "esp_log.h"
 static const char* REPEATER_RCV_TAG = "Repeater Receiver";
 // using namespace std;
-#define MASK_REVERSE_COLORS 0x00000001
 //RepeaterReceiver &LocalRepeaterReiver = RepeaterReceiver::getInstance();
 
 void OnDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len) {
-static long LastNumber = 0;
-static long MessageCounter = 0;
-
-struct_message m_message;
-  memcpy(&m_message, incomingData, sizeof(m_message));
+  MessageType_t type;
+  if(len < (int)sizeof(struct_message))
+    return;
+  memcpy(&type, incomingData, sizeof(type));
   RepeaterReceiver &LocalRepeaterReiver = RepeaterReceiver::getInstance();
-  if(m_message.piste_ID == LocalRepeaterReiver.MasterPiste())
-  {
-    LocalRepeaterReiver.ResetWatchDog();
-    long difference = m_message.messagenumber - LastNumber;
-    if(difference > 0){
-      LocalRepeaterReiver.StateChanged(m_message.event);
-      MessageCounter++;
-    }
-    LastNumber = m_message.messagenumber;
+  if(type == STATE_SNAPSHOT){
+    if(len < (int)sizeof(struct_snapshot))
+      return;
+    struct_snapshot snapshot;
+    memcpy(&snapshot, incomingData, sizeof(snapshot));
+    if(snapshot.magic != REPEATER_SNAPSHOT_MAGIC)
+      return; // a snapshot format this firmware does not know
+    LocalRepeaterReiver.ApplySnapshot(snapshot);
+    return;
   }
+  if(type != EVENT)
+    return; // heartbeats, pairing requests and types of newer firmware
+  struct_message m_message;
+  memcpy(&m_message, incomingData, sizeof(m_message));
+  LocalRepeaterReiver.ApplyDelta(m_message);
 }
 
 RepeaterReceiver::RepeaterReceiver()
@@ -41,95 +44,57 @@ RepeaterReceiver::~RepeaterReceiver()
     //dtor
 }
 
-void changeEventMainType(uint32_t *event, uint32_t newType){
-  *event &=  SUB_TYPE_MASK;    // clear original type
-  *event |=  newType;  // set new type
+void RepeaterReceiver::ApplyDelta(const struct_message &message)
+{
+  if(message.piste_ID != m_MasterPiste)
+    return;
+  ResetWatchDog();
+  if(message.messagenumber <= m_StateVersion)
+    return; // a resend, late, or already contained in a snapshot
+  m_StateVersion = message.messagenumber;
+  int slot = RepeaterSlot(message.event);
+  if(slot >= 0){
+    m_Applied[slot] = message.event;
+    m_AppliedSlots |= 1u << slot;
+  }
+  StateChanged(message.event);
 }
 
-uint32_t swapLights(const uint32_t &event) {
-  uint32_t result = EVENT_LIGHTS || MASK_REVERSE_COLORS;
-  if(event & MASK_RED)
-    result |= MASK_GREEN;
-
-  if(event & MASK_GREEN)
-    result |= MASK_RED;
-
-  if(event & MASK_WHITE_L)
-    result |= MASK_WHITE_R;
-
-  if(event & MASK_WHITE_R)
-        result |= MASK_WHITE_L;
-
-  if(event & MASK_ORANGE_L)
-    result |= MASK_ORANGE_R;
-
-  if(event & MASK_ORANGE_R)
-    result |= MASK_ORANGE_L;
-
-  return result;
-}
-void RepeaterReceiver::StateChanged (uint32_t event)
+// Brings the displays up to date in one go: every slot that differs from what
+// was last passed on is notified, whatever deltas were lost before.
+void RepeaterReceiver::ApplySnapshot(const struct_snapshot &snapshot)
 {
-// we have to modify the event in case of mirroring
-if(!m_Mirror){
-  notify(event);
-  return;
+  if(snapshot.piste_ID != m_MasterPiste)
+    return;
+  ResetWatchDog();
+  if(m_HasSession && snapshot.session == m_Session){
+    if(snapshot.messagenumber < m_StateVersion)
+      return; // older than a frame already applied
+  }
+  else{
+    // First snapshot, or the master rebooted and counts from 0 again:
+    // restart from its version. Deltas of the new session that arrived
+    // before were dropped as old; this snapshot contains them.
+    m_Session = snapshot.session;
+    m_HasSession = true;
+  }
+  m_StateVersion = snapshot.messagenumber;
+  for(int slot = 0; slot < REPEATER_NUM_SLOTS; slot++){
+    uint32_t bit = 1u << slot;
+    if(!(snapshot.validSlots & bit))
+      continue;
+    if((m_AppliedSlots & bit) && m_Applied[slot] == snapshot.slot[slot])
+      continue;
+    m_Applied[slot] = snapshot.slot[slot];
+    m_AppliedSlots |= bit;
+    StateChanged(snapshot.slot[slot]);
+  }
 }
-uint32_t event_data = event & SUB_TYPE_MASK;
-uint32_t maineventtype = event & MAIN_TYPE_MASK ;
-uint32_t tempevent = event;
-  switch(maineventtype)
-  {
-    case EVENT_LIGHTS:
-    tempevent = swapLights(event);
-    break;
-    case EVENT_SCORE_LEFT:
-    changeEventMainType(&tempevent,EVENT_SCORE_RIGHT);
-    break;
-
-    case EVENT_SCORE_RIGHT:
-    changeEventMainType(&tempevent,EVENT_SCORE_LEFT);
-    break;
-
-    case EVENT_PRIO:
-    if(event_data == 1)
-      event_data = 2;
-    else
-      if(event_data == 2)
-        event_data = 1;
-    tempevent = event_data | EVENT_PRIO;
-    break;
-
-    case EVENT_YELLOW_CARD_LEFT:
-    changeEventMainType(&tempevent,EVENT_YELLOW_CARD_RIGHT);
-    break;
-
-    case EVENT_YELLOW_CARD_RIGHT:
-    changeEventMainType(&tempevent,EVENT_YELLOW_CARD_LEFT);
-    break;
-
-    case EVENT_RED_CARD_LEFT:
-    changeEventMainType(&tempevent,EVENT_RED_CARD_RIGHT);
-    break;
-
-    case EVENT_RED_CARD_RIGHT:
-    changeEventMainType(&tempevent,EVENT_RED_CARD_LEFT);
-    break;
-
-
-    case EVENT_P_CARD:
-        //StateChanged(EVENT_P_CARD |  m_PCardLeft | m_PCardRight << 8);
-        mix_t PCardInfo;
-        PCardInfo.theDWord = event_data;
-        uint8_t temp = PCardInfo.theBytes[0];
-        PCardInfo.theBytes[0] = PCardInfo.theBytes[1];
-        PCardInfo.theBytes[1] = temp;
-        tempevent = PCardInfo.theDWord | EVENT_P_CARD;
-
-    break;
 
-  }
-  notify(tempevent);
+void RepeaterReceiver::StateChanged (uint32_t event)
+{
+  // a mirrored repeater shows the piste from the other side
+  notify(m_Mirror ? RepeaterMirrored(event) : event);
 }
 
 
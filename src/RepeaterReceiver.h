@@ -14,6 +14,9 @@ class RepeaterReceiver : public Subject<RepeaterReceiver>, public SingletonMixin
         /** Default destructor */
         virtual ~RepeaterReceiver();
         void StateChanged (uint32_t eventtype);
+        // Called from the ESP-NOW receive callback
+        void ApplyDelta(const struct_message &message);
+        void ApplySnapshot(const struct_snapshot &snapshot);
         void RegisterRepeater(uint8_t *broadcastAddress);
         void begin();
         int32_t MasterPiste(){return m_MasterPiste;};
@@ -38,6 +41,11 @@ class RepeaterReceiver : public Subject<RepeaterReceiver>, public SingletonMixin
     esp_now_peer_info_t peerInfo;
     long m_WatchDogTriggerTime = 999999;
     long m_WatchDogPeriod =  FULL_STATUS_REPETITION_PERIOD * 3;
+    long m_StateVersion = -1;         // newest version applied, never lowered
+    uint32_t m_Session = 0;           // session of the last snapshot applied
+    bool m_HasSession = false;        // m_Session is valid
+    uint32_t m_Applied[REPEATER_NUM_SLOTS]; // last event passed on per slot
+    uint32_t m_AppliedSlots = 0;      // slots of m_Applied that are valid
 
     // private member variables
 
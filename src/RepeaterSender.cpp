@@ -4,6 +4,7 @@
 #include <iostream>
 #include <Preferences.h>
 #include "esp_err.h"
+#include "esp_system.h"
 #include "esp_log.h"
 static const char* REPEATER_SND_TAG = "Repeater Sender";
 
@@ -73,6 +74,13 @@ void RepeaterSender::begin()
   networkpreferences.begin("credentials", false);
   m_message.piste_ID = networkpreferences.getInt("pisteNr", 500);
   networkpreferences.end();
+  m_snapshot.type = STATE_SNAPSHOT;
+  m_snapshot.magic = REPEATER_SNAPSHOT_MAGIC;
+  m_snapshot.notAPiste = REPEATER_NOT_A_PISTE;
+  m_snapshot.piste_ID = m_message.piste_ID;
+  // Versions restart at 0 after a reboot; the new session tells repeaters
+  // to take them instead of waiting for the old version to be passed.
+  m_snapshot.session = esp_random();
 
   RegisterRepeater(m_broadcastAddress);
   RegisterRepeater(m_receiverAddress);
@@ -99,32 +107,102 @@ void RepeaterSender::BroadcastHeartBeat()
   esp_err_t result = esp_now_send(m_broadcastAddress, (uint8_t *) &m_message, sizeof(m_message));
 }
 
+// Returns false if the event is already the value of its snapshot slot
+bool RepeaterSender::RecordInSnapshot(uint32_t eventtype)
+{
+  int slot = RepeaterSlot(eventtype);
+  if(slot < 0)
+    return true;
+  uint32_t bit = 1u << slot;
+  if((m_snapshot.validSlots & bit) && m_snapshot.slot[slot] == eventtype)
+    return false;
+  m_snapshot.slot[slot] = eventtype;
+  m_snapshot.validSlots |= bit;
+  return true;
+}
+
+void RepeaterSender::RefreshSnapshot(uint32_t eventtype)
+{
+  if(RecordInSnapshot(eventtype))
+    m_StateVersion++;
+}
+
+void RepeaterSender::BroadcastSnapshot()
+{
+  m_snapshot.messagenumber = m_StateVersion;
+  esp_err_t result = esp_now_send(m_broadcastAddress, (uint8_t *) &m_snapshot, sizeof(m_snapshot));
+}
+
 void RepeaterSender::update (FencingStateMachine *subject, uint32_t eventtype)
+{
+  // Repeaters already have this value (or get it from the next snapshot)
+  if(!RecordInSnapshot(eventtype))
+    return;
+  SendDelta(eventtype);
+}
+
+void RepeaterSender::update (FencingStateMachine *subject, const EventBatch &batch, const EventMask &mask)
+{
+  int changedSlots = 0;
+  uint32_t lastChange = 0;
+  for(size_t i = 0; i < batch.size(); i++){
+    uint32_t eventtype = batch[i];
+    if(!mask.contains(eventtype))
+      continue;
+    if(RepeaterSlot(eventtype) < 0)
+      update(subject, eventtype);
+    else if(RecordInSnapshot(eventtype)){
+      changedSlots++;
+      lastChange = eventtype;
+    }
+  }
+  if(changedSlots == 1){
+    SendDelta(lastChange);
+  }
+  else if(changedSlots > 1){
+    // One frame instead of a delta per slot; the version moves by one, which
+    // receivers accept from a snapshot
+    m_StateVersion++;
+    BroadcastSnapshot();
+    m_ResendSnapshot = true;
+    m_resendCount = MESSAGE_REPETITION_FACTOR;
+    m_nextResendTime = 0;
+  }
+}
+
+void RepeaterSender::SendDelta(uint32_t eventtype)
 {
   // Send message via ESP-NOW
-  m_message.messagenumber = currentNewMessageCount++;
+  m_message.messagenumber = ++m_StateVersion;
   m_message.event = eventtype;
   m_message.type = EVENT;
   //esp_err_t result = esp_now_send(m_receiverAddress, (uint8_t *) &m_message, sizeof(m_message));
   esp_err_t result = esp_now_send(m_broadcastAddress, (uint8_t *) &m_message, sizeof(m_message));
   m_nextResendTime = 0;
-  if(eventtype && MAIN_TYPE_MASK == EVENT_TIMER){
-    if(eventtype && DATA_BYTE0_MASK)  // don't resend hundreths
-      m_resendCount = 0;
-      return;
-  }
-  if(eventtype && MAIN_TYPE_MASK == EVENT_LIGHTS)
-    m_resendCount = 7;
+  // Resending the snapshot instead of the event itself carries every
+  // change since, so a newer event never cancels the resends of an older one
+  if(RepeaterSlot(eventtype) >= 0)
+    m_ResendSnapshot = true;
   else
-    m_resendCount = MESSAGE_REPETITION_FACTOR;
+    m_ResendMessage = true;
+  int resends = RepeaterResends(eventtype);
+  if(resends >= 0)
+    m_resendCount = resends;
 }
 
 void RepeaterSender::RepeatLastMessage(){
   if(m_resendCount){
     if(millis() > m_nextResendTime){
-      esp_err_t result = esp_now_send(m_broadcastAddress, (uint8_t *) &m_message, sizeof(m_message));
+      if(m_ResendSnapshot)
+        BroadcastSnapshot();
+      if(m_ResendMessage)
+        esp_now_send(m_broadcastAddress, (uint8_t *) &m_message, sizeof(m_message));
       m_resendCount--;
       m_nextResendTime = millis() + m_ResendDelta[m_resendCount];
     }
   }
+  else{
+    m_ResendSnapshot = false;
+    m_ResendMessage = false;
+  }
 }
@@ -15,6 +15,11 @@ class RepeaterSender : public Observer<FencingStateMachine>, public SingletonMix
         /** Default destructor */
         virtual ~RepeaterSender();
         void update (FencingStateMachine *subject, uint32_t eventtype);
+        // One tick of events: several snapshot changes go out as one snapshot
+        void update (FencingStateMachine *subject, const EventBatch &batch, const EventMask &mask);
+        // Stores an event in the snapshot without sending a delta frame
+        void RefreshSnapshot(uint32_t eventtype);
+        void BroadcastSnapshot();
         void RegisterRepeater(uint8_t *broadcastAddress);
         void BroadcastHeartBeat();
         void RepeatLastMessage();
@@ -27,15 +32,20 @@ class RepeaterSender : public Observer<FencingStateMachine>, public SingletonMix
     friend class SingletonMixin<RepeaterSender>;
     /** Default constructor */
     RepeaterSender();  // tickPeriod in miliseconds
+    bool RecordInSnapshot(uint32_t eventtype);
+    void SendDelta(uint32_t eventtype);
     esp_now_peer_info_t peerInfo;
     struct_message m_message;
+    struct_snapshot m_snapshot = {};
     uint8_t m_receiverAddress[6] = {0x24,0xDC,0xC3,0x45,0xCD,0xA0};
     uint8_t m_broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
     uint32_t m_HeartbeatCounter = 0;
     long TimeToNextHeartbeat = 0;
     long HeartPeriod = 60000/HEART_RATE;
-    long currentNewMessageCount = 0;
+    long m_StateVersion = 0;  // bumped on every change of the sent state
     int m_resendCount = MESSAGE_REPETITION_FACTOR;
+    bool m_ResendSnapshot = false; // a snapshot slot changed, resend snapshot
+    bool m_ResendMessage = false;  // an event outside the snapshot, resend it
     long m_nextResendTime = 0;
     uint8_t m_ResendDelta[7]={5,3,2,1,2,1,2};
 
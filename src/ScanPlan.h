@@ -0,0 +1,62 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "FastADC1.h"
+#include "FastGPIOSettings.h"
+#include "RawCapture.h"
+
+// A scan plan declares the probes of a weapon as tables instead of a
+// sequence of hand-written Set_IODirectionAndValue() /
+// fast_adc1_get_raw_inline() pairs. RunScanPlan() executes the table of
+// probes run on every scan back to back and returns the outcome of every
+// probe packed in a bitmask (bit i = probe i), with the raw ADC readings
+// available for weapons that filter them (epee averages two consecutive
+// samples). The conditional probes (guard, piste, leak, parry, ...) are a
+// second table per weapon, run one entry at a time with RunProbe().
+//
+// Thresholds are calibrated at runtime (ResistorSetting.h), so a probe stores
+// a pointer to the threshold, not its value.
+
+struct ScanProbe {
+  uint8_t IODirection;
+  uint8_t IOValues;
+  uint8_t ADChannel;
+  bool ActiveBelow; // true: raw < threshold (closed wire), else raw > threshold
+  const int *Threshold;
+};
+
+inline bool EvaluateProbe(const ScanProbe &probe, int raw) {
+  return probe.ActiveBelow ? (raw < *probe.Threshold)
+                           : (raw > *probe.Threshold);
+}
+
+// Every sensor probe goes through here, so RawCapture sees all of them.
+inline int SampleProbe(uint8_t direction, uint8_t values, uint8_t channel) {
+  Set_IODirectionAndValue(direction, values);
+  int raw = fast_adc1_get_raw_inline((adc1_channel_t)channel);
+  RawCapture::record(direction, values, channel, raw);
+  return raw;
+}
+
+inline int SampleProbe(const ScanProbe &probe) {
+  return SampleProbe(probe.IODirection, probe.IOValues, probe.ADChannel);
+}
+
+inline bool RunProbe(const ScanProbe &probe) {
+  return EvaluateProbe(probe, SampleProbe(probe));
+}
+
+template <size_t N>
+inline uint32_t RunScanPlan(const ScanProbe (&plan)[N], int (&raw)[N]) {
+  static_assert(N <= 32, "a scan plan result must fit in 32 bits");
+  uint32_t result = 0;
+  for (size_t i = 0; i < N; i++) {
+    raw[i] = SampleProbe(plan[i]);
+    if (EvaluateProbe(plan[i], raw[i]))
+      result |= (1u << i);
+  }
+  return result;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "ScanTimingStats.h"
+#include "TimingConstants.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+ScanTimingStats::ScanTimingStats() { clear(); }
+
+void ScanTimingStats::clear() {
+  memset(&data_, 0, sizeof(data_));
+  last_start_us_ = 0;
+}
+
+void ScanTimingStats::add(Histogram &h, uint32_t value_us, uint32_t bucket_us) {
+  uint32_t idx = value_us / bucket_us;
+  if (idx >= NUM_BUCKETS)
+    idx = NUM_BUCKETS - 1;
+  h.bucket[idx] = h.bucket[idx] + 1;
+  if (value_us > h.max_us)
+    h.max_us = value_us;
+}
+
+void ScanTimingStats::record(int64_t start_us, uint32_t exec_cycles,
+                             weapon_t weapon, bool debouncing) {
+  if (reset_requested_.load(std::memory_order_relaxed)) {
+    reset_requested_.store(false, std::memory_order_relaxed);
+    clear();
+  }
+
+  if (last_start_us_ != 0) {
+    uint32_t interval = (uint32_t)(start_us - last_start_us_);
+    add(data_.interval, interval, INTERVAL_BUCKET_US);
+    if (interval > 2 * scanloop_us)
+      data_.late = data_.late + 1;
+  }
+  last_start_us_ = start_us;
+
+  if (weapon < NUM_WEAPONS)
+    add(data_.exec[weapon][debouncing ? 1 : 0], exec_cycles / cpu_mhz_,
+        EXEC_BUCKET_US);
+}
+
+void ScanTimingStats::snapshot(Snapshot &out) const {
+  memcpy(&out, &data_, sizeof(out));
+}
+
+static size_t appendHistogram(char *buffer, size_t size, size_t pos,
+                              const char *name,
+                              const ScanTimingStats::Histogram &h) {
+  if (pos >= size)
+    return pos;
+  pos += snprintf(buffer + pos, size - pos, "\"%s\":{\"max\":%" PRIu32 ",\"h\":[",
+                  name, h.max_us);
+  for (int i = 0; i < ScanTimingStats::NUM_BUCKETS && pos < size; i++) {
+    pos += snprintf(buffer + pos, size - pos, i ? ",%" PRIu32 : "%" PRIu32,
+                    h.bucket[i]);
+  }
+  if (pos < size)
+    pos += snprintf(buffer + pos, size - pos, "]}");
+  return pos;
+}
+
+size_t ScanTimingStats::toJson(char *buffer, size_t size) const {
+  static const char *weaponNames[NUM_WEAPONS] = {"foil", "epee", "sabre"};
+  static const char *phaseNames[NUM_PHASES] = {"idle", "deb"};
+  Snapshot snap;
+  snapshot(snap);
+
+  size_t pos = snprintf(buffer, size,
+                        "{\"period_us\":%d,\"interval_bucket_us\":%" PRIu32
+                        ",\"exec_bucket_us\":%" PRIu32 ",\"late\":%" PRIu32 ",",
+                        scanloop_us, INTERVAL_BUCKET_US, EXEC_BUCKET_US,
+                        snap.late);
+  pos = appendHistogram(buffer, size, pos, "interval", snap.interval);
+  for (int w = 0; w < NUM_WEAPONS; w++) {
+    for (int p = 0; p < NUM_PHASES; p++) {
+      char name[16];
+      snprintf(name, sizeof(name), "%s_%s", weaponNames[w], phaseNames[p]);
+      if (pos < size)
+        pos += snprintf(buffer + pos, size - pos, ",");
+      pos = appendHistogram(buffer, size, pos, name, snap.exec[w][p]);
+    }
+  }
+  if (pos < size)
+    pos += snprintf(buffer + pos, size - pos, "}");
+  return pos < size ? pos : size - 1;
+}
@@ -0,0 +1,70 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include "weaponenum.h"
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+// ScanTimingStats keeps always-on histograms of the sensor scan loop:
+//   - the interval between two scan_timer_callback invocations (jitter /
+//     starvation of the esp_timer task), and
+//   - the execution time of MultiWeaponSensor::DoFullScan, split per weapon
+//     and per weapon state (IDLE or DEBOUNCING).
+//
+// Threading:
+//   - record() is only called from the esp_timer task (single writer). It does
+//     plain loads/stores on 32-bit counters, no locks and no atomic RMW.
+//   - snapshot() / toJson() may be called from any task. A reader can see a
+//     histogram that is one sample "behind" on another bucket, which is fine
+//     for statistics. Counters wrap after 2^32 samples (~7 days at 150 µs).
+//   - requestReset() only raises a flag; the writer clears the counters on its
+//     next record() so there is never a second writer.
+
+class ScanTimingStats {
+public:
+  static constexpr int NUM_BUCKETS = 16;
+  static constexpr uint32_t INTERVAL_BUCKET_US = 25; // 0..375+ µs
+  static constexpr uint32_t EXEC_BUCKET_US = 8;      // 0..120+ µs
+  static constexpr int NUM_WEAPONS = 3;              // FOIL, EPEE, SABRE
+  static constexpr int NUM_PHASES = 2;               // IDLE, DEBOUNCING
+
+  struct Histogram {
+    uint32_t bucket[NUM_BUCKETS];
+    uint32_t max_us;
+  };
+
+  struct Snapshot {
+    Histogram interval;
+    uint32_t late;   // intervals longer than 2 scan periods
+    Histogram exec[NUM_WEAPONS][NUM_PHASES];
+  };
+
+  ScanTimingStats();
+
+  // Cycle counter frequency, needed to convert execution cycles to µs.
+  void setCpuMhz(uint32_t mhz) { cpu_mhz_ = mhz ? mhz : 1; }
+
+  // Called once per scan from the esp_timer task.
+  // start_us    : esp_timer_get_time() at callback entry
+  // exec_cycles : CPU cycles spent in DoFullScan
+  void record(int64_t start_us, uint32_t exec_cycles, weapon_t weapon,
+              bool debouncing);
+
+  void requestReset() { reset_requested_.store(true); }
+
+  void snapshot(Snapshot &out) const;
+
+  // Compact JSON rendering of a snapshot, for MQTT diagnostics.
+  // Returns the number of characters written (excluding the terminator).
+  size_t toJson(char *buffer, size_t size) const;
+
+private:
+  static void add(Histogram &h, uint32_t value_us, uint32_t bucket_us);
+  void clear();
+
+  Snapshot data_;
+  int64_t last_start_us_ = 0;
+  uint32_t cpu_mhz_ = 240;
+  std::atomic<bool> reset_requested_{false};
+};
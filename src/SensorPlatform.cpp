@@ -0,0 +1,234 @@
+// Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
+// Firmware side of MultiWeaponSensor: NVS settings, ADC and GPIO setup,
+// resistor threshold calibration and the esp_timer that runs the scan. The
+// scan itself (3WeaponSensor.cpp, foil.cpp, epee.cpp, sabre.cpp) does not
+// depend on this file, so the host simulator in test/host links without it.
+#include "3WeaponSensor.h"
+#include "FastADC1.h"
+#include "FastGPIOSettings.h"
+#include "FlashWriteGuard.h"
+#include "RawCapture.h"
+#include "ResistorSetting.h"
+#include "adc_calibrator.h"
+#include "driver/adc.h"
+#include "driver/gpio.h" // Required for gpio_pad_select_gpio()
+#include "esp_adc_cal.h"
+#include "esp_clk.h"
+#include "esp_timer.h"
+#include "hal/cpu_hal.h"
+#include <Preferences.h>
+
+static const char *CORE_SCORING_MACHINE_TAG = "Core Scoring machine";
+static esp_timer_handle_t s_ScanTimer = nullptr;
+static esp_adc_cal_characteristics_t s_AdcChars;
+/*float MultiWeaponSensor::GetVcc() {
+  Set_IODirectionAndValue(IODirection_br_br, IOValues_br_br);
+  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
+  return esp_adc_cal_raw_to_voltage(tempADValue, &s_AdcChars) / 1000.0f;
+}
+*/
+ResistorDividerCalibrator MyCalibrator;
+void MultiWeaponSensor::initializeResistorThresholds() {
+  // MyCalibrator.begin((adc1_channel_t)br_analog, (adc1_channel_t)cr_analog);
+  bool success = true;
+  // Normal boot: a stored calibration of the current version with plausible
+  // values is used as is, without taking any samples
+  bool calibrated = MyCalibrator.begin((adc1_channel_t)br_analog,
+                                       (adc1_channel_t)cr_analog) &&
+                    MyCalibrator.is_calibration_plausible();
+  if (!calibrated && ForceThresholdCalibration) {
+    printf("\nCalibration will be done on the connector of the right fencer "
+           "(Left on view from the back, Green light\n");
+    printf("The calibration will be done in 2 phases.\n");
+    printf("If both are successful, the results will be stored in flash.\n");
+    printf("First phase: between the outer pins\n");
+    printf("    O          0     0     \n");
+    printf("    |                |     \n");
+    printf("    ______  100 Ω ____     \n");
+    success &= MyCalibrator.calibrate_interactively(98.0);
+    Set_IODirectionAndValue(IODirection_ar_cr, IOValues_ar_cr);
+    printf("Second phase: between the central and close pin\n");
+    printf("Connect the correct pins before continuing!\n");
+    printf("    O          0     0     \n");
+    printf("               |     |    \n");
+    printf("                100 Ω      \n");
+    if (success) {
+      success &= MyCalibrator.calibrate_r1_only(98.0);
+    }
+    // Only save result is calibration was successful
+    if (success) {
+      MyCalibrator.save_calibration_to_nvs(CALIBRATION_VERSION);
+    }
+    calibrated = success;
+  }
+  if (!calibrated)
+    MyCalibrator.set_default_calibration();
+  constexpr int sdev = 7;
+  // During calibration we have measured a sdev of 6-7 ADC raw units (constant
+  // over the entire range) I'm not adding extra correction factors here. These
+  // are just the calculated thresholds for a given R If you need margin, add it
+  // either by using a different resistor value, or by adding margin in the
+  // comparison code itself, such that it is done in the right direction Values
+  // for Epee It is important to verify the real values, and compare to the
+  // programmed ones.
+
+  AxXy_160_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(160);
+  AxXy_250_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(250);
+
+  // Values for Sabre
+  AxXy_280_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(280);
+  BxCy_200_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(220);
+
+  BxCy_280_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(280);
+  // Values for Foil
+  AxXy_125_Ohm =
+      MyCalibrator.get_adc_threshold_for_resistance_Tip(125); // Hit on Guard
+  AxXy_200_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(200);
+  AxXy_300_Ohm = MyCalibrator.get_adc_threshold_for_resistance_Tip(
+      300); // Normally closed circuit up to 300 Ohm
+  AxXy_430_Ohm =
+      MyCalibrator.get_adc_threshold_for_resistance_Tip(430); // Colored lights
+  AxXy_450_Ohm =
+      MyCalibrator.get_adc_threshold_for_resistance_Tip(450); // Hit on Piste
+  BxCy_450_Ohm = MyCalibrator.get_adc_threshold_for_resistance_NonTip(
+      450); // Yellow lights
+  printf("Resistor thresholds (%s calibration v%d): Tip 125/160/200/250/280/"
+         "300/430/450 = %d/%d/%d/%d/%d/%d/%d/%d, NonTip 220/280/450 = "
+         "%d/%d/%d\n",
+         calibrated ? "stored" : "default", MyCalibrator.get_CalVersion(),
+         AxXy_125_Ohm, AxXy_160_Ohm, AxXy_200_Ohm, AxXy_250_Ohm, AxXy_280_Ohm,
+         AxXy_300_Ohm, AxXy_430_Ohm, AxXy_450_Ohm, BxCy_200_Ohm, BxCy_280_Ohm,
+         BxCy_450_Ohm);
+}
+
+// Timer callback (runs in timer task context, not ISR)
+// Every invocation is recorded in ScanTimingStats: the interval since the
+// previous call shows esp_timer task starvation, the cycle count shows the
+// cost of DoFullScan per weapon and weapon state.
+void scan_timer_callback(void *arg) {
+  MultiWeaponSensor &MyLocalSensor = MultiWeaponSensor::getInstance();
+  int64_t start = esp_timer_get_time();
+  uint32_t startCycles = cpu_hal_get_cycle_count();
+  RawCapture::beginScan((uint32_t)start);
+  MyLocalSensor.DoFullScan(start);
+  uint32_t cycles = cpu_hal_get_cycle_count() - startCycles;
+  MyLocalSensor.getScanTimingStats().record(
+      start, cycles, MyLocalSensor.GetActualWeapon(),
+      MyLocalSensor.IsScanDebouncing());
+  vTaskDelay(0);
+}
+
+void MultiWeaponSensor::begin() {
+  gpio_pad_select_gpio(GPIO_NUM_33); // Route pin to GPIO (not peripheral)
+  gpio_set_direction(GPIO_NUM_33, GPIO_MODE_INPUT_OUTPUT);
+  Preferences mypreferences;
+  uint32_t rawCaptureSamples = 0;
+  uint32_t longHitMs, doubleHitMinMs, doubleHitMaxMs, doubleHitGapMs;
+  {
+    FlashWriteGuard guard; // enable brownout detection while NVS may write
+    mypreferences.begin("scoringdevice", false);
+    LightsDuration = mypreferences.getInt("LIGHTS_MS", 0);
+    if (!LightsDuration) {
+      mypreferences.putInt("LIGHTS_MS", LIGHTS_DURATION_MS);
+      LightsDuration = LIGHTS_DURATION_MS;
+    }
+    ForceThresholdCalibration = mypreferences.getBool("ForceCal", false);
+    // Raw ADC capture around hits, for post-mortem analysis. Number of
+    // samples (8 bytes each); 0 = off.
+    rawCaptureSamples = mypreferences.getUInt("RAW_CAPTURE", 0);
+    // Long/double hit detector timing; 0 (or absent) = compiled default.
+    longHitMs = mypreferences.getUInt("LONGHIT_MS", 0);
+    doubleHitMinMs = mypreferences.getUInt("DBLHIT_MIN_MS", 0);
+    doubleHitMaxMs = mypreferences.getUInt("DBLHIT_MAX_MS", 0);
+    doubleHitGapMs = mypreferences.getUInt("DBLHIT_GAP_MS", 0);
+    uint8_t storedweapon = mypreferences.getUChar("START_WEAPON", 99);
+    if (99 == storedweapon) {
+      mypreferences.putUChar("START_WEAPON", 0);
+      storedweapon = 0;
+    }
+    switch (storedweapon) {
+    case 0:
+      m_ActualWeapon = FOIL;
+      break;
+
+    case 1:
+      m_ActualWeapon = EPEE;
+      break;
+
+    case 2:
+      m_ActualWeapon = SABRE;
+      break;
+    default:
+      m_ActualWeapon = EPEE;
+    }
+    SelectWeaponScan();
+    mypreferences.end();
+  } // guard destroyed here: brownout detection disabled again
+  if (rawCaptureSamples)
+    RawCapture::enable(rawCaptureSamples);
+  if (longHitMs)
+    LongHitDetector_.setDurationUs((int64_t)longHitMs * 1000);
+  if (doubleHitMinMs)
+    DoubleHitDetector_.setMinHitUs((int64_t)doubleHitMinMs * 1000);
+  if (doubleHitMaxMs)
+    DoubleHitDetector_.setMaxHitUs((int64_t)doubleHitMaxMs * 1000);
+  if (doubleHitGapMs)
+    DoubleHitDetector_.setMaxGapUs((int64_t)doubleHitGapMs * 1000);
+
+  adc1_fast_register_channel(ADC1_CHANNEL_0);
+  adc1_fast_register_channel(ADC1_CHANNEL_3);
+  adc1_fast_register_channel(ADC1_CHANNEL_4);
+  adc1_fast_register_channel(ADC1_CHANNEL_6);
+  adc1_fast_register_channel(ADC1_CHANNEL_7);
+
+  adc1_fast_begin_unsafe();
+  gpio_reset_pin(GPIO_NUM_33); // Reset function to digital
+  gpio_set_direction(GPIO_NUM_33, GPIO_MODE_OUTPUT);
+  gpio_set_level(GPIO_NUM_33, 0); // or 1, as needed
+  disable_gpio33_pull();          // Set_IODirectionAndValue only toggles OE
+  gpio_reset_pin(GPIO_NUM_2);     // Reset function to digital
+  gpio_set_direction(GPIO_NUM_2, GPIO_MODE_INPUT);
+
+  Set_IODirectionAndValue(IODirection_br_cr, IOValues_br_cr);
+  printf("\nI'm going to initialize the resistorThresholds\n");
+  initializeResistorThresholds();
+  printf("\nresistorThresholds initialized\n");
+  // int fast_raw = fast_adc1_get_raw(ADC1_CHANNEL_3);
+  /*int64_t t0 = esp_timer_get_time();
+  volatile int sum1 = 0;
+  int samples = 10000; // Number of samples to take
+  FullScanCounter = 1;
+  for (int i = 0; i < samples; ++i) {
+    if (FullScanCounter)
+      FullScanCounter--;
+    else
+      FullScanCounter = SABRE_SCANCOUNTER_INIT;
+    DoFoil();
+  }
+  // fast_adc1_get_raw_inline(ADC1_CHANNEL_6);
+  int64_t t1 = esp_timer_get_time();
+  printf("Total time: %lld us\n", t1 - t0);
+  printf("Total samples: %d\n", samples);
+  printf("Average time per sample: %lld us\n", (t1 - t0) / samples);*/
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100,
+                           &s_AdcChars);
+  ScanTimingStats_.setCpuMhz(esp_clk_cpu_freq() / 1000000);
+  // The first scan resets, so the initial lights event is pushed from the
+  // scan task like all others
+  PostRequest(REQUEST_RESET, 0);
+
+  // Timer config
+  const esp_timer_create_args_t scan_timer_args = {
+      .callback = &scan_timer_callback,
+      .arg = nullptr,
+      .dispatch_method =
+          ESP_TIMER_TASK, // Use ESP_TIMER_TASK for longer callbacks
+      .name = "scan_timer"};
+  esp_timer_create(&scan_timer_args, &s_ScanTimer);
+  // calibrator.begin(ADC1_CHANNEL_6);
+  // calibrator.calibrate_interactively(ADC1_CHANNEL_6);
+}
+
+void MultiWeaponSensor::start() {
+  esp_timer_start_periodic(s_ScanTimer, scanloop_us); // 250 us interval
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// What the sensor scan (3WeaponSensor.cpp, foil.cpp, epee.cpp, sabre.cpp)
+// needs from the RTOS. The GPIO and ADC primitives are declared in
+// FastGPIOSettings.h and FastADC1.h; everything else that touches ESP-IDF or
+// Arduino (NVS settings, ADC/GPIO setup, calibration, the scan timer) lives in
+// SensorPlatform.cpp. Built with -DSENSOR_HOST_SIM the scan compiles with the
+// host compiler, see test/host.
+#include <stdint.h>
+
+#ifndef SENSOR_HOST_SIM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Let other ready tasks on the scan core run
+inline void SensorYield() { vTaskDelay(0); }
+// Wake the task that pops HitEvents
+inline void SensorNotify(TaskHandle_t task) { xTaskNotifyGive(task); }
+
+// The timer value DoFullScan() takes once and the whole scan uses
+typedef int64_t ScanTimestamp;
+#else
+typedef void *TaskHandle_t;
+
+inline void SensorYield() {}
+inline void SensorNotify(TaskHandle_t) {}
+
+// Counts its reads. Each read is a place where the scan used to read the
+// timer itself; SensorSim uses the count, and the optional s_OnRead hook, to
+// measure what taking one timestamp per scan saves.
+class ScanTimestamp {
+public:
+  static uint64_t s_Reads;
+  static void (*s_OnRead)();
+
+  ScanTimestamp &operator=(int64_t us) {
+    m_Us = us;
+    return *this;
+  }
+  operator int64_t() const {
+    s_Reads++;
+    if (s_OnRead)
+      s_OnRead();
+    return m_Us;
+  }
+
+private:
+  int64_t m_Us = 0;
+};
+#endif
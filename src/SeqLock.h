@@ -0,0 +1,46 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Sequence lock around a copy of a plain-data struct.
+//
+// One writer at a time calls store() (callers serialize writers themselves,
+// e.g. with the mutex that protects the original). Any number of readers on
+// either core call tryRead() without taking a lock: the sequence counter is
+// odd while a store is in progress, and a reader that saw it change retries.
+//
+// A reader that preempted the writer on the same core would spin forever, so
+// tryRead() gives up after a few attempts and the caller falls back to the
+// writer's lock.
+template <typename T> class SeqLock {
+public:
+  void store(const T &value) {
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    value_ = value;
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Calls read(const T &) on the protected copy until it sees a stable
+  // version. read() must only copy data out: it may run on a torn value,
+  // which is then discarded. Returns false if no stable version was seen.
+  template <typename F> bool tryRead(F read, int attempts = 4) const {
+    while (attempts-- > 0) {
+      uint32_t before = seq_.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;
+      read(value_);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == before)
+        return true;
+    }
+    return false;
+  }
+
+private:
+  std::atomic<uint32_t> seq_{0};
+  T value_;
+};
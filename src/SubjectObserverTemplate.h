@@ -3,9 +3,102 @@
 #define SUBJECTOBSERVERTEMPLATE_H
 
 #include "EventDefinitions.h"
+#include <cstdio>
 #include <iostream>
 #include <string>
-#include <vector>
+
+// Set of main event types (bits 31..24 of an event) an observer handles.
+// Build it with EventMask().add(EVENT_LIGHTS).add(EVENT_TIMER)...
+class EventMask {
+public:
+  EventMask() {
+    for (int i = 0; i < 8; i++)
+      m_Bits[i] = 0;
+  }
+  static EventMask All() {
+    EventMask mask;
+    for (int i = 0; i < 8; i++)
+      mask.m_Bits[i] = 0xffffffff;
+    return mask;
+  }
+  EventMask &add(uint32_t maintype) {
+    uint32_t type = maintype >> 24;
+    m_Bits[type >> 5] |= 1u << (type & 31);
+    return *this;
+  }
+  bool contains(uint32_t eventtype) const {
+    uint32_t type = eventtype >> 24;
+    return m_Bits[type >> 5] & (1u << (type & 31));
+  }
+
+private:
+  uint32_t m_Bits[8];
+};
+
+// Events a subject raised during one step (e.g. one state machine tick), in
+// order. A state event (lights, timer, score, ...) replaces an earlier event
+// of the same main type, so each observer only sees the latest value; other
+// events are kept as they come.
+class EventBatch {
+public:
+  static constexpr size_t MaxEvents = 16;
+
+  // Returns false when the batch is full; the caller flushes and retries.
+  bool add(uint32_t eventtype) {
+    if (coalesces(eventtype)) {
+      uint32_t mainType = eventtype & MAIN_TYPE_MASK;
+      size_t kept = 0;
+      for (size_t i = 0; i < m_count; i++) {
+        if ((m_events[i] & MAIN_TYPE_MASK) != mainType)
+          m_events[kept++] = m_events[i];
+      }
+      m_count = kept;
+    }
+    if (m_count >= MaxEvents)
+      return false;
+    m_events[m_count++] = eventtype;
+    return true;
+  }
+  void clear() { m_count = 0; }
+  bool empty() const { return m_count == 0; }
+  size_t size() const { return m_count; }
+  uint32_t operator[](size_t i) const { return m_events[i]; }
+  bool intersects(const EventMask &mask) const {
+    for (size_t i = 0; i < m_count; i++) {
+      if (mask.contains(m_events[i]))
+        return true;
+    }
+    return false;
+  }
+
+private:
+  static bool coalesces(uint32_t eventtype) {
+    switch (eventtype & MAIN_TYPE_MASK) {
+    case EVENT_LIGHTS:
+    case EVENT_TIMER:
+    case EVENT_ROUND:
+    case EVENT_WEAPON:
+    case EVENT_SCORE_LEFT:
+    case EVENT_SCORE_RIGHT:
+    case EVENT_PRIO:
+    case EVENT_YELLOW_CARD_LEFT:
+    case EVENT_YELLOW_CARD_RIGHT:
+    case EVENT_RED_CARD_LEFT:
+    case EVENT_RED_CARD_RIGHT:
+    case EVENT_BLACK_CARD_LEFT:
+    case EVENT_BLACK_CARD_RIGHT:
+    case EVENT_TIMER_STATE:
+    case EVENT_P_CARD:
+    case EVENT_UW2F_TIMER:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  uint32_t m_events[MaxEvents];
+  size_t m_count = 0;
+};
 
 template <class T> class Observer {
 public:
@@ -13,26 +106,61 @@ public:
   virtual ~Observer() {}
   virtual void update(T *subject, uint32_t eventtype) = 0;
   virtual void update(T *subject, const std::string &eventtype) { return; };
+  // All events of one batch at once. The default hands the events in mask
+  // over one by one; override it to combine them into a single update.
+  virtual void update(T *subject, const EventBatch &batch,
+                      const EventMask &mask) {
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (mask.contains(batch[i]))
+        update(subject, batch[i]);
+    }
+  }
 };
 
-template <class T> class Subject {
+// Observers live in a fixed table filled at startup, so notify() never
+// allocates and skips observers whose mask does not contain the event's main
+// type. String events go to every observer.
+template <class T, size_t MaxObservers = 8> class Subject {
 public:
   Subject() {}
   virtual ~Subject() {}
-  void attach(Observer<T> &observer) { m_observers.push_back(&observer); }
+  bool attach(Observer<T> &observer,
+              const EventMask &mask = EventMask::All()) {
+    if (m_count >= MaxObservers) {
+      printf("Subject: observer table full (%u), observer not attached\n",
+             (unsigned)MaxObservers);
+      return false;
+    }
+    m_observers[m_count].observer = &observer;
+    m_observers[m_count].mask = mask;
+    m_count++;
+    return true;
+  }
   void notify(uint32_t eventtype = EVENT_ALL) {
-    typename std::vector<Observer<T> *>::iterator it;
-    for (it = m_observers.begin(); it != m_observers.end(); it++)
-      (*it)->update(static_cast<T *>(this), eventtype);
+    for (size_t i = 0; i < m_count; i++) {
+      if (m_observers[i].mask.contains(eventtype))
+        m_observers[i].observer->update(static_cast<T *>(this), eventtype);
+    }
+  }
+  void notify(const EventBatch &batch) {
+    for (size_t i = 0; i < m_count; i++) {
+      if (batch.intersects(m_observers[i].mask))
+        m_observers[i].observer->update(static_cast<T *>(this), batch,
+                                        m_observers[i].mask);
+    }
   }
   void notify(const std::string &eventtype) {
-    typename std::vector<Observer<T> *>::iterator it;
-    for (it = m_observers.begin(); it != m_observers.end(); it++)
-      (*it)->update(static_cast<T *>(this), eventtype);
+    for (size_t i = 0; i < m_count; i++)
+      m_observers[i].observer->update(static_cast<T *>(this), eventtype);
   }
 
 private:
-  std::vector<Observer<T> *> m_observers;
+  struct Registration {
+    Observer<T> *observer;
+    EventMask mask;
+  };
+  Registration m_observers[MaxObservers];
+  size_t m_count = 0;
 };
 
 #endif // SUBJECTOBSERVERTEMPLATE_H
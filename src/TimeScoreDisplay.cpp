@@ -259,13 +259,56 @@ void TimeScoreDisplay::DisplayMatchCount(uint8_t match, uint8_t maxmatch) {
   SetChar(21 + diff / 2, digit1);
 }
 
+EventMask TimeScoreDisplay::StateMachineEvents() {
+  return EventMask()
+      .add(EVENT_IDLE)
+      .add(EVENT_UI_INPUT)
+      .add(EVENT_ROUND)
+      .add(EVENT_PRIO)
+      .add(EVENT_SCORE_LEFT)
+      .add(EVENT_SCORE_RIGHT)
+      .add(EVENT_TIMER_STATE)
+      .add(EVENT_TIMER)
+      .add(EVENT_WEAPON);
+}
+
 void TimeScoreDisplay::update(FencingStateMachine *subject,
                               uint32_t eventtype) {
-  xQueueSend(queue, &eventtype, portMAX_DELAY);
+  PostEvent(eventtype);
 }
 
 void TimeScoreDisplay::update(RepeaterReceiver *subject, uint32_t eventtype) {
-  xQueueSend(queue, &eventtype, portMAX_DELAY);
+  PostEvent(eventtype);
+}
+
+// Called from the notifying task: never waits for the display
+void TimeScoreDisplay::PostEvent(uint32_t eventtype) {
+  switch (eventtype & MAIN_TYPE_MASK) {
+  case EVENT_TIMER_STATE:
+    m_Mailbox.post(SLOT_TIMER_STATE, eventtype);
+    return;
+  case EVENT_TIMER:
+    m_Mailbox.post(SLOT_TIMER, eventtype);
+    return;
+  case EVENT_SCORE_LEFT:
+    m_Mailbox.post(SLOT_SCORE_LEFT, eventtype);
+    return;
+  case EVENT_SCORE_RIGHT:
+    m_Mailbox.post(SLOT_SCORE_RIGHT, eventtype);
+    return;
+  case EVENT_ROUND:
+    m_Mailbox.post(SLOT_ROUND, eventtype);
+    return;
+  case EVENT_PRIO:
+    m_Mailbox.post(SLOT_PRIO, eventtype);
+    return;
+  case EVENT_WEAPON:
+    m_Mailbox.post(SLOT_WEAPON, eventtype);
+    return;
+  default:
+    if (queue == NULL || xQueueSend(queue, &eventtype, 0) != pdTRUE)
+      m_DroppedEvents++;
+  }
 }
 
 constexpr uint32_t MASK_RED_OR_GREEN = MASK_GREEN | MASK_RED;
@@ -273,10 +316,15 @@ constexpr uint32_t MASK_RED_OR_GREEN = MASK_GREEN | MASK_RED;
 void TimeScoreDisplay::ProcessEvents() {
   if (queue == NULL)
     return;
-  if (uxQueueMessagesWaiting(queue) == 0)
-    return;
+  // Commands in order first, then the latest value of each state
+  uint32_t command;
+  while (xQueueReceive(queue, &command, 0) == pdTRUE)
+    HandleEvent(command);
+  m_Mailbox.take([this](uint32_t event) { HandleEvent(event); });
+}
 
-  xQueueReceive(queue, &m_LastEvent, portMAX_DELAY);
+void TimeScoreDisplay::HandleEvent(uint32_t event) {
+  m_LastEvent = event;
   uint32_t event_data = m_LastEvent & SUB_TYPE_MASK;
   uint32_t maineventtype = m_LastEvent & MAIN_TYPE_MASK;
   uint32_t tempevent = m_LastEvent;
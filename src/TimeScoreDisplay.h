@@ -3,6 +3,7 @@
 #define TIMESCOREDISPLAY_H
 
 #include "EventDefinitions.h"
+#include "EventMailbox.h"
 #include "FencingStateMachine.h"
 #include "RepeaterReceiver.h"
 #include "SubjectObserverTemplate.h"
@@ -49,9 +50,15 @@ public:
   virtual ~TimeScoreDisplay();
   void begin();
   void update(FencingStateMachine *subject, uint32_t eventtype);
+  // Main event types handled by update(FencingStateMachine *, uint32_t)
+  static EventMask StateMachineEvents();
   void update(RepeaterReceiver *subject, uint32_t eventtype);
   void update(WS2812B_LedStrip *subject, uint32_t eventtype) { ShowTime(); };
   void ProcessEvents();
+  // Events replaced by a newer one of the same kind before being shown
+  uint32_t GetOverwrittenEvents() const { return m_Mailbox.overwritten(); }
+  // Events lost because the command queue was full
+  uint32_t GetDroppedEvents() const { return m_DroppedEvents.load(); }
   void DisplayScore(uint8_t scoreLeft, uint8_t scoreRight);
   void DisplayTime(uint8_t minutes, uint8_t seconds, uint8_t hundreths,
                    bool TenthsOnly = true);
@@ -112,12 +119,28 @@ private:
   long NextTimeToSwitchBetweenScoreAndTime = 0;
   long NextTimeToTogglecolon = 0;
   uint32_t m_LastEvent = 0;
+  // State events (timer, score, ...) only need their latest value and go to
+  // the mailbox; commands (idle, UI input) keep their order in the queue.
+  enum MailboxSlot_t {
+    SLOT_TIMER_STATE,
+    SLOT_TIMER,
+    SLOT_SCORE_LEFT,
+    SLOT_SCORE_RIGHT,
+    SLOT_ROUND,
+    SLOT_PRIO,
+    SLOT_WEAPON,
+    NUM_MAILBOX_SLOTS
+  };
+  EventMailbox<NUM_MAILBOX_SLOTS> m_Mailbox;
   QueueHandle_t queue = NULL;
+  std::atomic<uint32_t> m_DroppedEvents{0};
   int m_Brightness = TEXT_BRIGHTNESS_NORMAL;
   int PisteId = -1;
   bool m_Idle = false;
 
   int calculateTimeStartPosition();
+  void PostEvent(uint32_t eventtype);
+  void HandleEvent(uint32_t event);
 };
 
 #endif // TIMESCOREDISPLAY_H
@@ -0,0 +1,11 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+enum TimerState_t {
+  FIGHTING,
+  BREAK,
+  INJURY,
+  ADDITIONAL_MINUTE,
+  MATCH_ENDED,
+  UNDEFINED
+};
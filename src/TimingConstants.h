@@ -1,9 +1,15 @@
 // Copyright (c) Piet Wauters 2022 <piet.wauters@gmail.com>
+#pragma once
 /************************************************************************************************/
 /* Timing Constants for ESP32 implementation */
 /************************************************************************************************/
 // Below values are in microseconds
 
+// Period of the esp_timer driven sensor scan (MultiWeaponSensor::DoFullScan).
+// All debounce times below are effectively quantised to this period. A host
+// simulation of the scan must advance its clock by this amount per scan.
+constexpr int scanloop_us = 150;
+
 // Times in ms, spec in ms
 constexpr int FOIL_LOCK_TIME = 300;  // 300 +/- 25 ms
 constexpr int EPEE_LOCK_TIME = 45;   // 40-50 ms or 45 +/- 5 ms
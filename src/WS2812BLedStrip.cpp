@@ -121,7 +121,7 @@ WS2812B_LedStrip::WS2812B_LedStrip() {
   m_pixels->fill(m_pixels->Color(0, 0, 0),0,NUMPIXELS);
   SetBrightness(BRIGHTNESS_NORMAL);*/
 
-  queue = xQueueCreate(QUEUE_DEPTH_LED_STRIP, sizeof(uint32_t));
+  m_EventsPosted = xSemaphoreCreateBinary();
   Animationqueue = xQueueCreate(QUEUE_DEPTH_LED_ANIMATION, sizeof(uint32_t));
 }
 void WS2812B_LedStrip::begin() {
@@ -139,6 +139,14 @@ void WS2812B_LedStrip::begin() {
   m_pixels->clear();
   m_pixels->show();
   // m_pixels->fill(m_pixels->Color(0, 0, 0),0,NUMPIXELS);
+  m_Red = NeoPixelRMT::Color(255, 0, 0);
+  m_Green = NeoPixelRMT::Color(0, 255, 0);
+  m_White = NeoPixelRMT::Color(200, 200, 200);
+  m_Orange = NeoPixelRMT::Color(160, 60, 0);
+  m_Yellow = NeoPixelRMT::Color(204, 168, 0);
+  m_Blue = NeoPixelRMT::Color(0, 0, 255);
+  m_NumberColor = NeoPixelRMT::Color(170, 70, 0);
+  m_Off = NeoPixelRMT::Color(0, 0, 0);
   SetBrightness(BRIGHTNESS_NORMAL);
   // m_pixels->fill(m_pixels->Color(0, 0, 0),0,NUMPIXELS);
   m_pixels->show();
@@ -162,16 +170,9 @@ void WS2812B_LedStrip::begin() {
 }
 
 void WS2812B_LedStrip::SetBrightness(uint8_t val) {
+  // The palette stays at full intensity; NeoPixelRMT scales it when encoding
   m_Brightness = val;
-  m_Red = NeoPixelRMT::Color(255, 0, 0, m_Brightness);
-  m_Green = NeoPixelRMT::Color(0, 255, 0, m_Brightness);
-  m_White = NeoPixelRMT::Color(200, 200, 200, m_Brightness);
-  m_Orange = NeoPixelRMT::Color(160, 60, 0, m_Brightness);
-  m_Yellow = NeoPixelRMT::Color(204, 168, 0, m_Brightness);
-  m_Blue = NeoPixelRMT::Color(0, 0, 255, m_Brightness);
-  m_NumberColor = NeoPixelRMT::Color(170, 70, 0, m_Brightness);
-
-  m_Off = NeoPixelRMT::Color(0, 0, 0, m_Brightness);
+  m_pixels->setBrightness(m_Brightness);
 }
 
 WS2812B_LedStrip::~WS2812B_LedStrip() {
@@ -369,6 +370,25 @@ void WS2812B_LedStrip::setRedCardLeft(bool Value) {
   m_pixels->fill(theFillColor, 2 + 7 * 8, 2);
 }
 
+EventMask WS2812B_LedStrip::StateMachineEvents() {
+  return EventMask()
+      .add(EVENT_LIGHTS)
+      .add(EVENT_UI_INPUT)
+      .add(EVENT_SCORE_LEFT)
+      .add(EVENT_SCORE_RIGHT) // also carries the EVENT_WS2812_* sub-types
+      .add(EVENT_PRIO)
+      .add(EVENT_YELLOW_CARD_LEFT)
+      .add(EVENT_YELLOW_CARD_RIGHT)
+      .add(EVENT_RED_CARD_LEFT)
+      .add(EVENT_RED_CARD_RIGHT)
+      .add(EVENT_BLACK_CARD_LEFT)
+      .add(EVENT_BLACK_CARD_RIGHT)
+      .add(EVENT_P_CARD)
+      .add(EVENT_TOGGLE_BUZZER)
+      .add(EVENT_UW2F_TIMER)
+      .add(EVENT_TIMER);
+}
+
 void WS2812B_LedStrip::update(FencingStateMachine *subject,
                               uint32_t eventtype) {
   updateHelper(eventtype);
@@ -382,17 +402,21 @@ void WS2812B_LedStrip::startAnimation(uint32_t eventtype) {
   m_animPhase1Status =
       m_LedStatus;           // capture display state before FSM can change it
   m_animationRunning = true; // suppress LED queue rendering immediately
-  xQueueSend(Animationqueue, &eventtype, portMAX_DELAY);
+  if (xQueueSend(Animationqueue, &eventtype, 0) != pdTRUE)
+    m_DroppedAnimations++;
 }
 
+// Called from the notifying task (state machine tick or repeater): never
+// renders, so it never waits for the strip. Animations go to the animator;
+// every state the LED task shows goes to its mailbox slot.
 void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
   uint32_t event_data = eventtype & SUB_TYPE_MASK;
   uint32_t maineventtype = eventtype & MAIN_TYPE_MASK;
-  if (EVENT_LIGHTS == maineventtype) {
-    // SetLedStatus(event_data);
-    xQueueSend(queue, &eventtype, portMAX_DELAY);
-  }
   switch (maineventtype) {
+  case EVENT_LIGHTS:
+    PostEvent(SLOT_LIGHTS, eventtype);
+    break;
+
   case EVENT_UI_INPUT:
     switch (event_data) {
     case UI_CYCLE_BRIGHTNESS:
@@ -413,21 +437,22 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       default:
         SetBrightness(BRIGHTNESS_NORMAL);
       }
-      SetLedStatus(0xff);
+      // The LED task's next show() re-encodes the frame at the new brightness
+      PostEvent(SLOT_BRIGHTNESS, eventtype);
       break;
     }
 
     break;
   case EVENT_SCORE_LEFT:
     if (event_data != m_LeftScore) {
-      SetLeftScore(event_data);
+      m_LeftScore = event_data; // the flash ends with a full redraw
       startAnimation(EVENT_WS2812_FLASH_SCORE | 0x0001);
     }
     break;
 
   case EVENT_SCORE_RIGHT:
     if (event_data != m_RightScore) {
-      SetRightScore(event_data);
+      m_RightScore = event_data; // the flash ends with a full redraw
       startAnimation(EVENT_WS2812_FLASH_SCORE | 0x0002);
     }
     break;
@@ -455,6 +480,70 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
 
     break;
 
+  case EVENT_YELLOW_CARD_LEFT:
+    PostEvent(SLOT_YELLOW_CARD_LEFT, eventtype);
+    break;
+
+  case EVENT_YELLOW_CARD_RIGHT:
+    PostEvent(SLOT_YELLOW_CARD_RIGHT, eventtype);
+    break;
+
+  case EVENT_RED_CARD_LEFT:
+    PostEvent(SLOT_RED_CARD_LEFT, eventtype);
+    break;
+
+  case EVENT_RED_CARD_RIGHT:
+    PostEvent(SLOT_RED_CARD_RIGHT, eventtype);
+    break;
+
+  case EVENT_BLACK_CARD_LEFT:
+    PostEvent(SLOT_BLACK_CARD_LEFT, eventtype);
+    break;
+
+  case EVENT_BLACK_CARD_RIGHT:
+    PostEvent(SLOT_BLACK_CARD_RIGHT, eventtype);
+    break;
+
+  case EVENT_P_CARD:
+    PostEvent(SLOT_P_CARD, eventtype);
+    break;
+
+  case EVENT_UW2F_TIMER:
+    PostEvent(SLOT_UW2F, eventtype);
+    break;
+
+  case EVENT_TOGGLE_BUZZER:
+    m_Loudness = !m_Loudness;
+    break;
+
+  case EVENT_TIMER:
+    if (!event_data)
+      // StartWarning(11);
+      startAnimation(EVENT_WS2812_WARNING | 0x0000000b);
+    break;
+  }
+}
+
+void WS2812B_LedStrip::PostEvent(MailboxSlot_t slot, uint32_t eventtype) {
+  m_Mailbox.post(slot, eventtype);
+  xSemaphoreGive(m_EventsPosted);
+}
+
+// Runs in the LED task. Card, P-card and UW2F changes only update the state
+// and set redraw; ProcessEvents() repaints once for all of them.
+void WS2812B_LedStrip::HandleEvent(uint32_t event, bool &redraw) {
+  uint32_t event_data = event & SUB_TYPE_MASK;
+  uint32_t maineventtype = event & MAIN_TYPE_MASK;
+  switch (maineventtype) {
+  case EVENT_LIGHTS:
+    m_LastEvent = event;
+    SetLedStatus(event_data);
+    break;
+
+  case EVENT_UI_INPUT:
+    myShow(); // re-encodes the current frame at the new brightness
+    break;
+
   case EVENT_YELLOW_CARD_LEFT:
     if (event_data) {
       m_YellowCardLeft = true;
@@ -463,7 +552,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_YellowCardLeft = false;
     }
     setYellowCardLeft(m_YellowCardLeft);
-    SetLedStatus(0xff);
+    redraw = true;
     break;
 
   case EVENT_YELLOW_CARD_RIGHT:
@@ -473,7 +562,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_YellowCardRight = false;
     }
     setYellowCardRight(m_YellowCardRight);
-    SetLedStatus(0xff);
+    redraw = true;
     break;
 
   case EVENT_RED_CARD_LEFT:
@@ -484,7 +573,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_RedCardLeft = false;
     }
     setRedCardLeft(m_RedCardLeft);
-    SetLedStatus(0xff);
+    redraw = true;
     break;
 
   case EVENT_RED_CARD_RIGHT:
@@ -495,7 +584,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_RedCardRight = false;
     }
     setRedCardRight(m_RedCardRight);
-    SetLedStatus(0xff);
+    redraw = true;
     break;
 
   case EVENT_BLACK_CARD_RIGHT:
@@ -506,7 +595,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_BlackCardRight = false;
     }
     setWhiteRight(true, true);
-    SetLedStatus(0xff);
+    redraw = true;
     break;
 
   case EVENT_BLACK_CARD_LEFT:
@@ -517,11 +606,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       m_BlackCardLeft = false;
     }
     setWhiteLeft(true, true);
-    SetLedStatus(0xff);
-    break;
-
-  case EVENT_TOGGLE_BUZZER:
-    m_Loudness = !m_Loudness;
+    redraw = true;
     break;
 
   case EVENT_UW2F_TIMER:
@@ -537,13 +622,7 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
     m_UW2Ftens = (TimeInfo.theBytes[2] * 60 + TimeInfo.theBytes[1]) / 10;
     setUWFTimeLeft(m_UW2Ftens);
     setUWFTimeRight(m_UW2Ftens);
-    SetLedStatus(0xff);
-    break;
-
-  case EVENT_TIMER:
-    if (!event_data)
-      // StartWarning(11);
-      startAnimation(EVENT_WS2812_WARNING | 0x0000000b);
+    redraw = true;
     break;
 
   case EVENT_P_CARD:
@@ -594,28 +673,22 @@ void WS2812B_LedStrip::updateHelper(uint32_t eventtype) {
       break;
     }
 
-    SetLedStatus(0xff);
+    redraw = true;
     break;
   }
 }
 
 void WS2812B_LedStrip::ProcessEvents() {
-  if (queue == NULL)
-    return;
-  if (uxQueueMessagesWaiting(queue) == 0)
-    return;
-
-  xQueueReceive(queue, &m_LastEvent, portMAX_DELAY);
-  uint32_t event_data = m_LastEvent & SUB_TYPE_MASK;
-
-  SetLedStatus(event_data);
+  bool redraw = false;
+  m_Mailbox.take(
+      [this, &redraw](uint32_t event) { HandleEvent(event, redraw); });
+  if (redraw)
+    SetLedStatus(0xff);
 }
 
 void WS2812B_LedStrip::ProcessEventsBlocking() {
-  if (xQueueReceive(queue, &m_LastEvent, 4 / portTICK_PERIOD_MS) == pdPASS) {
-    uint32_t event_data = m_LastEvent & SUB_TYPE_MASK;
-    SetLedStatus(event_data);
-  }
+  if (xSemaphoreTake(m_EventsPosted, 4 / portTICK_PERIOD_MS) == pdPASS)
+    ProcessEvents();
 }
 
 void WS2812B_LedStrip::SetLedStatus(uint32_t val) {
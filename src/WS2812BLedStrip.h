@@ -2,6 +2,7 @@
 #ifndef WS2812B_LEDSTRIP_H
 #define WS2812B_LEDSTRIP_H
 #include "EventDefinitions.h"
+#include "EventMailbox.h"
 #include "FencingStateMachine.h"
 #include "NeoPixelRMT.h"
 #include "RepeaterReceiver.h"
@@ -30,9 +31,6 @@
 #define END_OF_WELCOME_ANIMATION 1
 #define END_OF_PRIO_ANIMATION 2
 
-// New events for confirmation wait animation
-#define EVENT_WS2812_CONFIRMATION_WAIT 0x00FF0000
-#define EVENT_WS2812_CONFIRMATION_END 0x00FF0001
 // How many NeoPixels are attached to the Arduino?
 #define NUMPIXELS 128
 
@@ -80,10 +78,17 @@ public:
   void myShow() { m_pixels->show(); };
   void SetBrightness(uint8_t val);
   void update(FencingStateMachine *subject, uint32_t eventtype);
+  // Main event types handled by update(FencingStateMachine *, uint32_t)
+  static EventMask StateMachineEvents();
   void update(RepeaterReceiver *subject, uint32_t eventtype);
   // void update(MultiWeaponSensor *subject, uint32_t eventtype);
   void ProcessEvents();
   void ProcessEventsBlocking();
+  // Lights, card and brightness states replaced by a newer one before being
+  // shown
+  uint32_t GetOverwrittenEvents() const { return m_Mailbox.overwritten(); }
+  // Animations lost because the animation queue was full
+  uint32_t GetDroppedAnimations() const { return m_DroppedAnimations.load(); }
   void setGreenPrio(bool Value, bool bReverse = false);
   void setRedPrio(bool Value, bool bReverse = false);
   void AnimateWarning();
@@ -138,6 +143,7 @@ private:
   WS2812B_LedStrip();
 
   void updateHelper(uint32_t eventtype);
+  void HandleEvent(uint32_t event, bool &redraw);
   void setUWFTime(uint8_t tens, uint8_t bottom);
   void drawDigit3x5(uint8_t panelOffset, uint8_t digit, uint8_t startRow,
                     uint8_t startCol, uint32_t color);
@@ -175,8 +181,27 @@ private:
   uint8_t m_LeftScore = 0;
   uint8_t m_RightScore = 0;
 
-  QueueHandle_t queue = NULL;
+  // Everything the state machine tick asks the strip to show is rendered by
+  // the LED task. Only the latest state of each slot matters; the semaphore
+  // wakes the LED task.
+  enum MailboxSlot_t {
+    SLOT_LIGHTS,
+    SLOT_YELLOW_CARD_LEFT,
+    SLOT_YELLOW_CARD_RIGHT,
+    SLOT_RED_CARD_LEFT,
+    SLOT_RED_CARD_RIGHT,
+    SLOT_BLACK_CARD_LEFT,
+    SLOT_BLACK_CARD_RIGHT,
+    SLOT_P_CARD,
+    SLOT_UW2F,
+    SLOT_BRIGHTNESS,
+    NUM_MAILBOX_SLOTS
+  };
+  void PostEvent(MailboxSlot_t slot, uint32_t eventtype);
+  EventMailbox<NUM_MAILBOX_SLOTS> m_Mailbox;
+  SemaphoreHandle_t m_EventsPosted = NULL;
   QueueHandle_t Animationqueue = NULL;
+  std::atomic<uint32_t> m_DroppedAnimations{0};
   uint32_t m_NextTimeToTogglePrioLights;
   bool m_Animating = false;
   volatile bool m_animationRunning =
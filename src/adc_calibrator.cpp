@@ -7,16 +7,15 @@
 #include "freertos/task.h"
 #include "nvs.h"
 #include "nvs_flash.h"
-#include <algorithm> // Add this
+#include <algorithm>
 #include <cmath>     // Add this for sqrtf
 #include <driver/uart.h>
 #include <math.h>
 #include <string.h>
-#include <vector> // Add this
 
 void ResistorDividerCalibrator::set_default_calibration() {
   v_gpio = 3.3643f;
-  r1_eff = 495, 6;
+  r1_eff = 495.6f;
   r1_Ax_eff = 87.94;
   r3_eff = 503.79;
   CalVersion = 6;
@@ -24,100 +23,215 @@ void ResistorDividerCalibrator::set_default_calibration() {
          "from FIE requirements!\n");
 }
 
-// Enhanced statistics calculation function
-void ResistorDividerCalibrator::calc_enhanced_adc_stats(adc1_channel_t channel,
-                                                        int samples,
-                                                        ADCStatistics &stats) {
-  // Collect all samples
-  std::vector<int> raw_values(samples);
-  float sum = 0, sum_sq = 0;
+void ADCStatsAccumulator::clear() {
+  n = 0;
+  m1 = m2 = m3 = m4 = 0;
+  min_raw = max_raw = 0;
+  centred = false;
+  base = 0;
+  memset(bins, 0, sizeof(bins));
+  below.count = below.kept = above.count = above.kept = 0;
+  below.spill_sum = above.spill_sum = 0;
+}
 
-  for (int i = 0; i < samples; ++i) {
-    raw_values[i] = fast_adc1_get_raw_inline(channel);
-    sum += raw_values[i];
-    sum_sq += raw_values[i] * raw_values[i];
-    vTaskDelay(pdMS_TO_TICKS(2));
+void ADCStatsAccumulator::add(int raw) {
+  if (n == 0)
+    min_raw = max_raw = raw;
+  min_raw = std::min(min_raw, raw);
+  max_raw = std::max(max_raw, raw);
+
+  // Welford / Terriberry update of the central moments
+  int n1 = n++;
+  float delta = raw - m1;
+  float delta_n = delta / n;
+  float delta_n2 = delta_n * delta_n;
+  float term1 = delta * delta_n * n1;
+  m1 += delta_n;
+  m4 += term1 * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * m2 -
+        4 * delta_n * m3;
+  m3 += term1 * delta_n * (n - 2) - 3 * delta_n * m2;
+  m2 += term1;
+
+  if (centred) {
+    bin(raw);
+  } else {
+    first[n1] = raw;
+    if (n == CentreSamples)
+      centre();
   }
+}
 
-  // Sort for median and percentile calculations
-  std::sort(raw_values.begin(), raw_values.end());
+// Place the histogram around the median of the samples held back so far, so
+// one early outlier cannot push the bulk of the samples out of it
+void ADCStatsAccumulator::centre() {
+  int sorted[CentreSamples];
+  memcpy(sorted, first, n * sizeof(int));
+  std::sort(sorted, sorted + n);
+  base = (n ? sorted[n / 2] : 0) - HistogramBins / 2;
+  centred = true;
+  for (int i = 0; i < n; ++i)
+    bin(first[i]);
+}
 
-  // Basic statistics
-  stats.mean = sum / samples;
-  stats.median =
-      (samples % 2 == 0)
-          ? (raw_values[samples / 2 - 1] + raw_values[samples / 2]) / 2.0f
-          : raw_values[samples / 2];
+void ADCStatsAccumulator::bin(int raw) {
+  int i = raw - base;
+  if (i < 0)
+    below.add(raw);
+  else if (i >= HistogramBins)
+    above.add(raw);
+  else
+    bins[i]++;
+}
 
-  float variance = (sum_sq / samples) - (stats.mean * stats.mean);
-  stats.stddev = sqrtf(variance > 0 ? variance : 0);
+void ADCStatsAccumulator::Side::add(int raw) {
+  count++;
+  if (kept == MaxOutliers) {
+    spill_sum += raw;
+    return;
+  }
+  int i = kept++;
+  for (; i > 0 && values[i - 1] > raw; --i)
+    values[i] = values[i - 1];
+  values[i] = raw;
+}
 
-  stats.min_val = raw_values[0];
-  stats.max_val = raw_values[samples - 1];
+// The spilled samples sit, at their mean, between the kept values
+float ADCStatsAccumulator::Side::value_at(int k) const {
+  int spilled = count - kept;
+  if (spilled == 0)
+    return values[k];
+  float spill = spill_sum / spilled;
+  int at = std::lower_bound(values, values + kept, spill) - values;
+  if (k < at)
+    return values[k];
+  if (k < at + spilled)
+    return spill;
+  return values[k - spilled];
+}
 
-  // Skewness and Kurtosis
-  float sum_cubed = 0, sum_fourth = 0;
-  stats.outlier_count = 0;
-  float outlier_threshold = 2.5f * stats.stddev; // 2.5 sigma rule
+float ADCStatsAccumulator::Side::sum_of_smallest(int k) const {
+  float sum = 0;
+  for (int i = 0; i < k; ++i)
+    sum += value_at(i);
+  return sum;
+}
 
-  for (int i = 0; i < samples; ++i) {
-    float deviation = raw_values[i] - stats.mean;
-    if (stats.stddev > 0) { // Avoid division by zero
-      float normalized_dev = deviation / stats.stddev;
+// Fewer than CentreSamples samples are not binned yet; query a binned copy
+const ADCStatsAccumulator &
+ADCStatsAccumulator::binned(ADCStatsAccumulator &tmp) const {
+  if (centred)
+    return *this;
+  tmp = *this;
+  tmp.centre();
+  return tmp;
+}
 
-      sum_cubed += normalized_dev * normalized_dev * normalized_dev;
-      sum_fourth +=
-          normalized_dev * normalized_dev * normalized_dev * normalized_dev;
-    }
+float ADCStatsAccumulator::value_at(int k) const {
+  if (k < below.count)
+    return below.value_at(k);
+  k -= below.count;
+  for (int i = 0; i < HistogramBins; ++i) {
+    if (k < bins[i])
+      return base + i;
+    k -= bins[i];
+  }
+  return above.value_at(k);
+}
 
-    if (fabs(deviation) > outlier_threshold) {
-      stats.outlier_count++;
-    }
+float ADCStatsAccumulator::sum_of_smallest(int k) const {
+  if (k <= below.count)
+    return below.sum_of_smallest(k);
+  float sum = below.sum_of_smallest(below.count);
+  k -= below.count;
+  for (int i = 0; i < HistogramBins && k > 0; ++i) {
+    int take = std::min<int>(k, bins[i]);
+    sum += (float)take * (base + i);
+    k -= take;
+  }
+  if (k > 0)
+    sum += above.sum_of_smallest(k);
+  return sum;
+}
+
+float ADCStatsAccumulator::median() const {
+  if (n == 0)
+    return 0;
+  ADCStatsAccumulator tmp;
+  const ADCStatsAccumulator &a = binned(tmp);
+  return (n % 2 == 0) ? (a.value_at(n / 2 - 1) + a.value_at(n / 2)) / 2.0f
+                      : a.value_at(n / 2);
+}
+
+float ADCStatsAccumulator::trimmed_mean(float trim_percent) const {
+  if (n == 0)
+    return 0;
+  int trim_count = (int)(n * trim_percent / 100.0f);
+  // Ensure we don't trim more than we have
+  if (trim_count * 2 >= n)
+    trim_count = (n - 1) / 2; // Leave at least 1 sample
+  int used = n - 2 * trim_count;
+  ADCStatsAccumulator tmp;
+  const ADCStatsAccumulator &a = binned(tmp);
+  return (a.sum_of_smallest(n - trim_count) - a.sum_of_smallest(trim_count)) /
+         used;
+}
+
+void ADCStatsAccumulator::get(ADCStatistics &stats) const {
+  stats.mean = m1;
+  stats.median = median();
+  float variance = n ? m2 / n : 0;
+  stats.stddev = sqrtf(variance > 0 ? variance : 0);
+  stats.min_val = min_raw;
+  stats.max_val = max_raw;
+
+  if (stats.stddev > 0) {
+    stats.skewness = (m3 / n) / (variance * stats.stddev);
+    stats.kurtosis = (m4 / n) / (variance * variance) - 3.0f; // Excess
+  } else {
+    stats.skewness = 0;
+    stats.kurtosis = 0;
   }
 
-  stats.skewness = (stats.stddev > 0) ? sum_cubed / samples : 0;
-  stats.kurtosis =
-      (stats.stddev > 0) ? (sum_fourth / samples) - 3.0f : 0; // Excess kurtosis
+  float outlier_threshold = 2.5f * stats.stddev; // 2.5 sigma rule
+  ADCStatsAccumulator tmp;
+  const ADCStatsAccumulator &a = binned(tmp);
+  stats.outlier_count = a.below.count + a.above.count;
+  for (int i = 0; i < HistogramBins; ++i) {
+    if (a.bins[i] && fabsf(a.base + i - stats.mean) > outlier_threshold)
+      stats.outlier_count += a.bins[i];
+  }
 
   // Normality test (simplified)
   stats.is_normal_distribution =
       (fabs(stats.skewness) < 0.5f) && (fabs(stats.kurtosis) < 0.5f) &&
-      (stats.outlier_count < samples * 0.05f); // < 5% outliers
+      (stats.outlier_count < n * 0.05f); // < 5% outliers
 }
-// Add this function after read_voltage_robust()
 
-float ResistorDividerCalibrator::read_voltage_trimmed_average(
-    adc1_channel_t channel, int samples, float trim_percent) {
-  // Collect all samples
-  std::vector<int> raw_values(samples);
+// Samples are spaced 2 ms apart so they are not all taken within one burst
+// of noise
+void ResistorDividerCalibrator::sample_adc(adc1_channel_t channel, int samples,
+                                           ADCStatsAccumulator &acc) {
   for (int i = 0; i < samples; ++i) {
-    raw_values[i] = fast_adc1_get_raw_inline(channel);
+    acc.add(fast_adc1_get_raw_inline(channel));
     esp_task_wdt_reset();
     vTaskDelay(pdMS_TO_TICKS(2));
   }
+}
 
-  // Sort the values
-  std::sort(raw_values.begin(), raw_values.end());
-
-  // Calculate how many samples to trim from each end
-  int trim_count = (int)(samples * trim_percent / 100.0f);
-
-  // Ensure we don't trim more than we have
-  if (trim_count * 2 >= samples) {
-    trim_count = (samples - 1) / 2; // Leave at least 1 sample
-  }
-
-  // Calculate the sum of the middle samples
-  uint32_t sum = 0;
-  int used_samples = samples - (2 * trim_count);
-
-  for (int i = trim_count; i < samples - trim_count; ++i) {
-    sum += raw_values[i];
-  }
-
-  // Calculate average of trimmed samples
-  uint32_t avg_raw = sum / used_samples;
+// Enhanced statistics calculation function
+void ResistorDividerCalibrator::calc_enhanced_adc_stats(adc1_channel_t channel,
+                                                        int samples,
+                                                        ADCStatistics &stats) {
+  ADCStatsAccumulator acc;
+  sample_adc(channel, samples, acc);
+  acc.get(stats);
+}
 
+float ResistorDividerCalibrator::read_voltage_trimmed_average(
+    adc1_channel_t channel, int samples, float trim_percent) {
+  ADCStatsAccumulator acc;
+  sample_adc(channel, samples, acc);
+  uint32_t avg_raw = (uint32_t)acc.trimmed_mean(trim_percent);
   return esp_adc_cal_raw_to_voltage(avg_raw, &adc_chars) / 1000.0f;
 }
 // Enhanced voltage reading with statistical choice
@@ -125,19 +239,9 @@ float ResistorDividerCalibrator::read_voltage_robust(
     adc1_channel_t channel, int samples,
     bool use_median) { // Remove default value here
   if (use_median || samples >= 100) {
-    std::vector<int> raw_values(samples); // Now std::vector is available
-    for (int i = 0; i < samples; ++i) {
-      raw_values[i] = fast_adc1_get_raw_inline(channel);
-      vTaskDelay(pdMS_TO_TICKS(2));
-    }
-
-    std::sort(raw_values.begin(),
-              raw_values.end()); // Now std::sort is available
-    int median_raw =
-        (samples % 2 == 0)
-            ? (raw_values[samples / 2 - 1] + raw_values[samples / 2]) / 2
-            : raw_values[samples / 2];
-
+    ADCStatsAccumulator acc;
+    sample_adc(channel, samples, acc);
+    int median_raw = (int)acc.median();
     return esp_adc_cal_raw_to_voltage(median_raw, &adc_chars) / 1000.0f;
   } else {
     // Use existing mean-based approach
@@ -571,6 +675,16 @@ bool ResistorDividerCalibrator::load_calibration_from_nvs(
   return (err == ESP_OK && !(CALIBRATION_VERSION > CalVersion));
 }
 
+// A corrupted or half-written NVS entry can pass the version check; these
+// bounds are wide around the nominal divider (3.3 V, 2 x 499 Ohm, 88 Ohm)
+bool ResistorDividerCalibrator::is_calibration_plausible() const {
+  return std::isfinite(v_gpio) && std::isfinite(r1_eff) &&
+         std::isfinite(r3_eff) && std::isfinite(r1_Ax_eff) &&
+         v_gpio > 3.0f && v_gpio < 3.6f && r1_eff > 350.0f &&
+         r1_eff < 650.0f && r3_eff > 350.0f && r3_eff < 650.0f &&
+         r1_Ax_eff > 40.0f && r1_Ax_eff < 150.0f;
+}
+
 bool ResistorDividerCalibrator::save_calibration_to_nvs(
     int version, const char *nvs_namespace) {
   nvs_handle_t handle;
@@ -6,6 +6,7 @@
 #include "nvs_flash.h"
 #include <algorithm> // Add this for std::sort
 #include <cstring>
+#include <stdint.h>
 #include <stdio.h>
 #include <vector> // Add this
 constexpr int CALIBRATION_VERSION = 6;
@@ -23,6 +24,61 @@ struct ADCStatistics {
   bool is_normal_distribution;
 };
 
+// Single-pass statistics of raw ADC samples, without heap use.
+//
+// Mean and the central moments for stddev, skewness and kurtosis are updated
+// per sample (Welford). Median, trimmed mean and outliers come from a
+// histogram of one-unit bins centred on the median of the first samples.
+// Samples outside it are far beyond the 6-7 units of noise seen on a divider
+// and are counted as outliers; up to MaxOutliers per side are kept sorted,
+// so median and trimmed mean equal those of a full sort. Outliers beyond
+// that only add to a count and sum and take their mean as value. The result
+// is then approximate: each of them is off by at most max_val - min_val, so
+// the trimmed mean is off by at most that times spilled / (samples used).
+class ADCStatsAccumulator {
+public:
+  static constexpr int HistogramBins = 256;
+  static constexpr int CentreSamples = 16; // held back to centre the bins
+  static constexpr int MaxOutliers = 64;   // kept per side of the histogram
+
+  ADCStatsAccumulator() { clear(); }
+  void clear();
+  void add(int raw);
+  int count() const { return n; }
+  float mean() const { return m1; }
+  float median() const;
+  float trimmed_mean(float trim_percent) const;
+  void get(ADCStatistics &stats) const;
+
+private:
+  // Samples on one side of the histogram: the kept values in ascending
+  // order and those that did not fit
+  struct Side {
+    int count; // all samples on this side
+    int kept;  // of which in values[]
+    uint16_t values[MaxOutliers];
+    float spill_sum; // sum of the count - kept others
+    void add(int raw);
+    float value_at(int k) const; // k-th smallest on this side, 0-based
+    float sum_of_smallest(int k) const;
+  };
+
+  float value_at(int k) const; // k-th smallest sample, 0-based
+  float sum_of_smallest(int k) const;
+  void centre();
+  void bin(int raw);
+  const ADCStatsAccumulator &binned(ADCStatsAccumulator &tmp) const;
+
+  int n;
+  float m1, m2, m3, m4;
+  int min_raw, max_raw;
+  bool centred;
+  int base; // raw value of bins[0]
+  int first[CentreSamples];
+  uint16_t bins[HistogramBins];
+  Side below, above;
+};
+
 class ResistorDividerCalibrator {
 public:
   bool begin(adc1_channel_t adc_channel_top, adc1_channel_t adc_channel_bottom);
@@ -36,6 +92,8 @@ public:
 
   // NVS support
   bool load_calibration_from_nvs(const char *nvs_namespace = "calib");
+  // True when the values are in the range a real divider can produce
+  bool is_calibration_plausible() const;
   void set_default_calibration();
   bool save_calibration_to_nvs(int version = CALIBRATION_VERSION,
                                const char *nvs_namespace = "calib");
@@ -69,6 +127,8 @@ private:
   int voltage_to_adc_raw(float voltage);
   float read_voltage(adc1_channel_t channel);
   float read_voltage_average(adc1_channel_t channel, int samples);
+  void sample_adc(adc1_channel_t channel, int samples,
+                  ADCStatsAccumulator &acc);
   void wait_for_enter();
   char wait_for_key();
 
@@ -3,102 +3,95 @@
 #include "FastADC1.h"
 #include "FastGPIOSettings.h"
 #include "ResistorSetting.h"
-
-inline bool HitOnLame_l() {
-  Set_IODirectionAndValue(IODirection_al_cr, IOValues_al_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > AxXy_160_Ohm);
-};
-inline bool HitOnGuard_l() {
-  Set_IODirectionAndValue(IODirection_al_br, IOValues_al_br);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  return (tempADValue > AxXy_250_Ohm);
-};
-inline bool HitOnPiste_l() {
-  Set_IODirectionAndValue(IODirection_al_piste, IOValues_al_piste);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)piste_analog);
-  return (tempADValue > AxXy_250_Ohm);
+#include "ScanPlan.h"
+
+// Probes run on every scan. Left and right contact are always measured so
+// LongHitDetector_ tracks uninterrupted contact even after a normal hit has
+// set SignalLeft / SignalRight. The raw values are filtered in DoEpee.
+enum EpeePlanProbe { EPEE_CL, EPEE_CR, EPEE_PLAN_SIZE };
+static constexpr ScanProbe EpeePlan[EPEE_PLAN_SIZE] = {
+    {IODirection_al_cl, IOValues_al_cl, cl_analog, false, &AxXy_160_Ohm},
+    {IODirection_ar_cr, IOValues_ar_cr, cr_analog, false, &AxXy_160_Ohm},
 };
 
-inline bool WeaponLeak_l() {
-  Set_IODirectionAndValue(IODirection_al_bl, IOValues_al_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue > AxXy_250_Ohm);
+// Probes the scan state machine runs one at a time: the optional checks
+// while idle and the validity checks while debouncing.
+enum EpeeCheck {
+  EPEE_LAME_L, // tip on the opponent's lame (foil-style contact)
+  EPEE_GUARD_L,
+  EPEE_PISTE_L,
+  EPEE_LEAK_L, // tip wire touching the weapon
+  EPEE_LAME_R,
+  EPEE_GUARD_R,
+  EPEE_PISTE_R,
+  EPEE_LEAK_R,
+  EPEE_CHECKS
 };
-
-inline bool HitOnLame_r() {
-  Set_IODirectionAndValue(IODirection_ar_cl, IOValues_ar_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > AxXy_160_Ohm);
-};
-inline bool HitOnGuard_r() {
-  Set_IODirectionAndValue(IODirection_ar_bl, IOValues_ar_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue > AxXy_250_Ohm);
-};
-inline bool HitOnPiste_r() {
-  Set_IODirectionAndValue(IODirection_ar_piste, IOValues_ar_piste);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)piste_analog);
-  return (tempADValue > AxXy_250_Ohm);
+static constexpr ScanProbe EpeeChecks[EPEE_CHECKS] = {
+    {IODirection_al_cr, IOValues_al_cr, cr_analog, false, &AxXy_160_Ohm},
+    {IODirection_al_br, IOValues_al_br, br_analog, false, &AxXy_250_Ohm},
+    {IODirection_al_piste, IOValues_al_piste, piste_analog, false,
+     &AxXy_250_Ohm},
+    {IODirection_al_bl, IOValues_al_bl, bl_analog, false, &AxXy_250_Ohm},
+    {IODirection_ar_cl, IOValues_ar_cl, cl_analog, false, &AxXy_160_Ohm},
+    {IODirection_ar_bl, IOValues_ar_bl, bl_analog, false, &AxXy_250_Ohm},
+    {IODirection_ar_piste, IOValues_ar_piste, piste_analog, false,
+     &AxXy_250_Ohm},
+    {IODirection_ar_br, IOValues_ar_br, br_analog, false, &AxXy_250_Ohm},
 };
 
-inline bool WeaponLeak_r() {
-  Set_IODirectionAndValue(IODirection_ar_br, IOValues_ar_br);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  return (tempADValue > AxXy_250_Ohm);
-};
-
-enum EpeeState { IDLE, DEBOUNCING, DEBOUNCED, LOCKING, LOCKED };
-
 void MultiWeaponSensor::DoEpee(void) {
   bool cl, cr;
-  static EpeeState state = IDLE;
-  static int SubsampleCounter = 0;
-  static int ADCL_0;
-  static int ADCR_0;
-  { // Always measure left contact so LongHitDetector_ tracks uninterrupted
-    // contact even after a normal hit has set SignalLeft.
-    Set_IODirectionAndValue(IODirection_al_cl, IOValues_al_cl);
-    tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-    if (!SignalLeft) {
-      cl = ((tempADValue + ADCL_0) >> 1 > AxXy_160_Ohm);
-      Debounce_c1.update(cl);
-      ADCL_0 = tempADValue;
-    } else {
-      cl = (tempADValue > AxXy_160_Ohm); // LongHit tracking (unaveraged)
-    }
+  ScanState &state = m_Scan.state;
+  uint8_t &SubsampleCounter = m_Scan.subsample;
+  int &ADCL_0 = m_Scan.ADCL_0;
+  int &ADCR_0 = m_Scan.ADCR_0;
+  int raw[EPEE_PLAN_SIZE];
+  uint32_t probes = RunScanPlan(EpeePlan, raw);
+  tempADValue = raw[EPEE_CR];
+  uint32_t channels = 0;
+  uint32_t conditions = 0;
+
+  if (!SignalLeft) {
+    cl = ((raw[EPEE_CL] + ADCL_0) >> 1 > AxXy_160_Ohm);
+    channels |= DEBOUNCE_BIT(DB_C1);
+    if (cl)
+      conditions |= DEBOUNCE_BIT(DB_C1);
+    ADCL_0 = raw[EPEE_CL];
+  } else {
+    cl = probes & (1u << EPEE_CL); // LongHit tracking (unaveraged)
   }
 
-  { // Always measure right contact so LongHitDetector_ tracks uninterrupted
-    // contact even after a normal hit has set SignalRight.
-    Set_IODirectionAndValue(IODirection_ar_cr, IOValues_ar_cr);
-    tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-    if (!SignalRight) {
-      cr = ((tempADValue + ADCR_0) >> 1 > AxXy_160_Ohm);
-      Debounce_c2.update(cr);
-      ADCR_0 = tempADValue;
-    } else {
-      cr = (tempADValue > AxXy_160_Ohm); // LongHit tracking (unaveraged)
-    }
+  if (!SignalRight) {
+    cr = ((raw[EPEE_CR] + ADCR_0) >> 1 > AxXy_160_Ohm);
+    channels |= DEBOUNCE_BIT(DB_C2);
+    if (cr)
+      conditions |= DEBOUNCE_BIT(DB_C2);
+    ADCR_0 = raw[EPEE_CR];
+  } else {
+    cr = probes & (1u << EPEE_CR); // LongHit tracking (unaveraged)
   }
+  m_Debounce.update(channels, conditions, m_ScanNowUs);
 
   // Epee has no invalid hits; guard/piste checks remain in DEBOUNCING only.
-  LongHitDetector_.update(cl, cr);
-  DoubleHitDetector_.update(cl, cr);
+  LongHitDetector_.update(m_ScanNowUs, cl, cr);
+  DoubleHitDetector_.update(m_ScanNowUs, cl, cr);
 
+  m_ScanDebouncing = (state == SCAN_DEBOUNCING);
   switch (state) {
-  case IDLE:
+  case SCAN_IDLE:
 
     if (cl || cr) {
-      state = DEBOUNCING;
+      state = SCAN_DEBOUNCING;
       break;
     } else {
       // Do one of the optional checks
-      vTaskDelay(0);
+      SensorYield();
       switch (SubsampleCounter) {
       case 0:
         SubsampleCounter = 1;
-        if (Debounce_b1.update(WeaponLeak_l())) {
+        if (m_Debounce.update(DB_B1, RunProbe(EpeeChecks[EPEE_LEAK_L]),
+                              m_ScanNowUs)) {
           OrangeL = true;
         } else {
           OrangeL = false;
@@ -106,7 +99,8 @@ void MultiWeaponSensor::DoEpee(void) {
         break;
       case 1:
         SubsampleCounter = 2;
-        if (Debounce_b2.update(WeaponLeak_r())) {
+        if (m_Debounce.update(DB_B2, RunProbe(EpeeChecks[EPEE_LEAK_R]),
+                              m_ScanNowUs)) {
           OrangeR = true;
         } else {
           OrangeR = false;
@@ -114,51 +108,54 @@ void MultiWeaponSensor::DoEpee(void) {
         break;
       case 2:
         SubsampleCounter = 3;
-        DebounceLong_al_cr.update(HitOnLame_l());
+        m_Debounce.update(DB_LONG_AL_CR, RunProbe(EpeeChecks[EPEE_LAME_L]),
+                          m_ScanNowUs);
         break;
       case 3:
         SubsampleCounter = 0;
-        DebounceLong_ar_cl.update(HitOnLame_r());
+        m_Debounce.update(DB_LONG_AR_CL, RunProbe(EpeeChecks[EPEE_LAME_R]),
+                          m_ScanNowUs);
         break;
       }
     }
     break;
 
-  case DEBOUNCING:
+  case SCAN_DEBOUNCING:
 
     if (!cl && !cr) {
       // no longer conditions to debounce-> go back to IDLE
-      state = IDLE;
+      state = SCAN_IDLE;
       break;
     }
 
     // Trick to satisfy Dos Santos. Not Sure if still needed
-    if (Debounce_c1.isOK()) {
-      Debounce_c2.applyDosSantosMarginUs();
+    if (m_Debounce.isOK(DB_C1)) {
+      m_Debounce.applyDosSantosMarginUs(DB_C2, m_ScanNowUs);
     }
-    if (Debounce_c2.isOK()) {
-      Debounce_c1.applyDosSantosMarginUs();
+    if (m_Debounce.isOK(DB_C2)) {
+      m_Debounce.applyDosSantosMarginUs(DB_C1, m_ScanNowUs);
     }
 
     // if (Debounce_c1.isOK())
     {
 
       // check validity
-      if (HitOnGuard_l()) {
-        Debounce_c1.reset();
+      if (RunProbe(EpeeChecks[EPEE_GUARD_L])) {
+        m_Debounce.reset(DB_C1);
         // Serial.println("Guard");
       } else {
-        if (HitOnPiste_l()) {
-          Debounce_c1.reset();
+        if (RunProbe(EpeeChecks[EPEE_PISTE_L])) {
+          m_Debounce.reset(DB_C1);
           // Serial.println("Piste");
         } else {
           // Serial.println("Red");
-          if (Debounce_c1.isOK()) {
+          if (m_Debounce.isOK(DB_C1)) {
             Red = true;
             Buzz = true;
             SignalLeft = true;
+            m_ContactStartLeftUs = m_Debounce.startTime(DB_C1);
             StartLock(EPEE_LOCK_TIME);
-            Debounce_c1.reset();
+            m_Debounce.reset(DB_C1);
           }
         }
       }
@@ -167,21 +164,22 @@ void MultiWeaponSensor::DoEpee(void) {
     {
 
       // check validity
-      if (HitOnGuard_r()) {
-        Debounce_c2.reset();
+      if (RunProbe(EpeeChecks[EPEE_GUARD_R])) {
+        m_Debounce.reset(DB_C2);
         // Serial.println("Guard");
       } else {
-        if (HitOnPiste_r()) {
-          Debounce_c2.reset();
+        if (RunProbe(EpeeChecks[EPEE_PISTE_R])) {
+          m_Debounce.reset(DB_C2);
           // Serial.println("Piste");
         } else {
           // Serial.println("Green");
-          if (Debounce_c2.isOK()) {
+          if (m_Debounce.isOK(DB_C2)) {
             Green = true;
             Buzz = true;
             SignalRight = true;
+            m_ContactStartRightUs = m_Debounce.startTime(DB_C2);
             StartLock(EPEE_LOCK_TIME);
-            Debounce_c2.reset();
+            m_Debounce.reset(DB_C2);
           }
         }
       }
@@ -8,135 +8,113 @@
 #include "FastADC1.h"
 #include "FastGPIOSettings.h"
 #include "ResistorSetting.h"
-
-inline bool HitOnLame_l() {
-  Set_IODirectionAndValue(IODirection_al_cr, IOValues_al_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > AxXy_300_Ohm);
-};
-inline bool HitOnGuard_l() {
-  Set_IODirectionAndValue(IODirection_al_br, IOValues_al_br);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  return (tempADValue > AxXy_300_Ohm);
-};
-inline bool HitOnPiste_l() {
-  Set_IODirectionAndValue(IODirection_al_piste, IOValues_al_piste);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)piste_analog);
-  return (tempADValue > AxXy_450_Ohm);
-};
-
-// For the leak I test both al-cl and bl-cl. This allows me to re-use this test
-// to check if I should switch to epee
-inline bool LameLeak_l() {
-  Set_IODirectionAndValue(IODirection_bl_cl & IODirection_al_cl,
-                          IOValues_bl_cl | IOValues_al_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > BxCy_450_Ohm);
-};
-
-inline bool EpeeHit_l() {
-  Set_IODirectionAndValue(IODirection_al_cl, IOValues_al_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > AxXy_430_Ohm);
-};
-
-inline bool HitOnLame_r() {
-  Set_IODirectionAndValue(IODirection_ar_cl, IOValues_ar_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > AxXy_430_Ohm);
+#include "ScanPlan.h"
+
+// Probes run on every scan. Left and right contact are always measured so
+// LongHitDetector_ tracks uninterrupted contact even after a normal hit has
+// set SignalLeft / SignalRight.
+enum FoilPlanProbe {
+  FOIL_BL,
+  FOIL_VALID_L,
+  FOIL_BR,
+  FOIL_VALID_R,
+  FOIL_PLAN_SIZE
 };
-inline bool HitOnGuard_r() {
-  Set_IODirectionAndValue(IODirection_ar_bl, IOValues_ar_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue > AxXy_430_Ohm);
-};
-inline bool HitOnPiste_r() {
-  Set_IODirectionAndValue(IODirection_ar_piste, IOValues_ar_piste);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)piste_analog);
-  return (tempADValue > AxXy_450_Ohm);
+static constexpr ScanProbe FoilPlan[FOIL_PLAN_SIZE] = {
+    {IODirection_al_bl, IOValues_al_bl, bl_analog, true, &AxXy_300_Ohm},
+    {IODirection_al_cr, IOValues_al_cr, cr_analog, false, &AxXy_300_Ohm},
+    {IODirection_ar_br, IOValues_ar_br, br_analog, true, &AxXy_300_Ohm},
+    {IODirection_ar_cl, IOValues_ar_cl, cl_analog, false, &AxXy_430_Ohm},
 };
 
-inline bool LameLeak_r() {
-  Set_IODirectionAndValue(IODirection_br_cr & IODirection_ar_cr,
-                          IOValues_br_cr | IOValues_ar_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > BxCy_450_Ohm);
+// Probes the scan state machine runs one at a time: the optional checks
+// while idle and the validity checks while debouncing.
+enum FoilCheck {
+  FOIL_GUARD_L, // tip on the opponent's guard
+  FOIL_PISTE_L,
+  // For the leak I test both al-cl and bl-cl. This allows me to re-use this
+  // test to check if I should switch to epee
+  FOIL_LEAK_L,
+  FOIL_GUARD_R,
+  FOIL_PISTE_R,
+  FOIL_LEAK_R,
+  FOIL_PARRY,
+  FOIL_CHECKS
 };
-
-inline bool EpeeHit_r() {
-  Set_IODirectionAndValue(IODirection_ar_cr, IOValues_ar_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > AxXy_430_Ohm);
+static constexpr ScanProbe FoilChecks[FOIL_CHECKS] = {
+    {IODirection_al_br, IOValues_al_br, br_analog, false, &AxXy_300_Ohm},
+    {IODirection_al_piste, IOValues_al_piste, piste_analog, false,
+     &AxXy_450_Ohm},
+    {IODirection_bl_cl & IODirection_al_cl, IOValues_bl_cl | IOValues_al_cl,
+     cl_analog, false, &BxCy_450_Ohm},
+    {IODirection_ar_bl, IOValues_ar_bl, bl_analog, false, &AxXy_430_Ohm},
+    {IODirection_ar_piste, IOValues_ar_piste, piste_analog, false,
+     &AxXy_450_Ohm},
+    {IODirection_br_cr & IODirection_ar_cr, IOValues_br_cr | IOValues_ar_cr,
+     cr_analog, false, &BxCy_450_Ohm},
+    {IODirection_br_bl, IOValues_br_bl, bl_analog, false, &BxCy_280_Ohm},
 };
 
-inline bool Parry() {
-  Set_IODirectionAndValue(IODirection_br_bl, IOValues_br_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue > BxCy_280_Ohm);
-};
-
-enum FoilState { IDLE, DEBOUNCING, DEBOUNCED, LOCKING, LOCKED };
-
 void MultiWeaponSensor::DoFoil(void) {
   bool bl, br;
   bool leak;
   bool Valid_l, Valid_r;
-
-  static FoilState state = IDLE;
-  static int SubsampleCounter = 0;
-  // This is needed in case we need to apply the Dos Santos trick
-  static bool lastValid_l = false;
-  static bool lastValid_r = false;
-
-  // Always measure left contact so LongHitDetector_ tracks uninterrupted
-  // contact even after a normal hit has set SignalLeft.
-  Set_IODirectionAndValue(IODirection_al_bl, IOValues_al_bl);
-  tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  bl = (tempADValue < AxXy_300_Ohm);
-  Valid_l = HitOnLame_l();
+  ScanState &state = m_Scan.state;
+  uint8_t &SubsampleCounter = m_Scan.subsample;
+
+  int raw[FOIL_PLAN_SIZE];
+  uint32_t probes = RunScanPlan(FoilPlan, raw);
+  tempADValue = raw[FOIL_VALID_R];
+  bl = probes & (1u << FOIL_BL);
+  Valid_l = probes & (1u << FOIL_VALID_L);
+  br = probes & (1u << FOIL_BR);
+  Valid_r = probes & (1u << FOIL_VALID_R);
+
+  // b1/b2 always run (held false while the side is signalled), the long
+  // cross checks only while the side is free.
+  uint32_t channels = DEBOUNCE_BIT(DB_B1) | DEBOUNCE_BIT(DB_B2);
+  uint32_t conditions = 0;
   if (!SignalLeft) {
     NotConnectedLeft = bl;
-    Debounce_b1.update(bl);
-    DebounceLong_al_cr.update(Valid_l && !bl);
-  } else {
-    Debounce_b1.update(false);
+    channels |= DEBOUNCE_BIT(DB_LONG_AL_CR);
+    if (bl)
+      conditions |= DEBOUNCE_BIT(DB_B1);
+    if (Valid_l && !bl)
+      conditions |= DEBOUNCE_BIT(DB_LONG_AL_CR);
   }
 
-  // Always measure right contact so LongHitDetector_ tracks uninterrupted
-  // contact even after a normal hit has set SignalRight.
-  Set_IODirectionAndValue(IODirection_ar_br, IOValues_ar_br);
-  tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  br = (tempADValue < AxXy_300_Ohm);
-  Valid_r = HitOnLame_r();
   if (!SignalRight) {
     NotConnectedRight = br;
-    Debounce_b2.update(br);
-    DebounceLong_ar_cl.update(Valid_r && !br);
-  } else {
-    Debounce_b2.update(false);
+    channels |= DEBOUNCE_BIT(DB_LONG_AR_CL);
+    if (br)
+      conditions |= DEBOUNCE_BIT(DB_B2);
+    if (Valid_r && !br)
+      conditions |= DEBOUNCE_BIT(DB_LONG_AR_CL);
   }
+  m_Debounce.update(channels, conditions, m_ScanNowUs);
 
   // validL/R = tip contact on lame; invalidL/R = tip contact but off-target
-  LongHitDetector_.update(bl && Valid_l, br && Valid_r, bl && !Valid_l,
-                          br && !Valid_r);
-  DoubleHitDetector_.update(bl && Valid_l, br && Valid_r, bl && !Valid_l,
-                            br && !Valid_r);
+  LongHitDetector_.update(m_ScanNowUs, bl && Valid_l, br && Valid_r,
+                          bl && !Valid_l, br && !Valid_r);
+  DoubleHitDetector_.update(m_ScanNowUs, bl && Valid_l, br && Valid_r,
+                            bl && !Valid_l, br && !Valid_r);
 
+  m_ScanDebouncing = (state == SCAN_DEBOUNCING);
   switch (state) {
-  case IDLE:
+  case SCAN_IDLE:
 
     if (bl || br) {
-      state = DEBOUNCING;
+      state = SCAN_DEBOUNCING;
       break;
     } else {
       // Do one of the optional checks
-      vTaskDelay(0);
+      SensorYield();
       switch (SubsampleCounter) {
       case 0:
         SubsampleCounter = 1;
-        leak = LameLeak_l();
-        DebounceLong_al_cl.update(leak);
-        if (Debounce_c1.update(leak)) {
+        leak = RunProbe(FoilChecks[FOIL_LEAK_L]);
+        m_Debounce.update(DB_LONG_AL_CL, leak, m_ScanNowUs);
+        if (m_Debounce.update(DB_C1, leak, m_ScanNowUs)) {
           OrangeL = true;
         } else {
           OrangeL = false;
@@ -144,9 +122,9 @@ void MultiWeaponSensor::DoFoil(void) {
         break;
       case 1:
         SubsampleCounter = 2;
-        leak = LameLeak_r();
-        DebounceLong_ar_cr.update(leak);
-        if (Debounce_c2.update(leak)) {
+        leak = RunProbe(FoilChecks[FOIL_LEAK_R]);
+        m_Debounce.update(DB_LONG_AR_CR, leak, m_ScanNowUs);
+        if (m_Debounce.update(DB_C2, leak, m_ScanNowUs)) {
           OrangeR = true;
         } else {
           OrangeR = false;
@@ -164,52 +142,54 @@ void MultiWeaponSensor::DoFoil(void) {
         break;
       case 4:
         SubsampleCounter = 0;
-        Debounce_Parry.update(Parry());
+        Debounce_Parry.update(RunProbe(FoilChecks[FOIL_PARRY]), m_ScanNowUs);
         break;
       }
     }
     break;
 
-  case DEBOUNCING:
+  case SCAN_DEBOUNCING:
 
     if (!bl && !br) {
       // no longer conditions to debounce-> go back to IDLE
-      state = IDLE;
+      state = SCAN_IDLE;
       break;
     }
     // Trick to satisfy Dos Santos. Not Sure if still needed
-    if (Debounce_b1.isOK()) {
-      Debounce_b2.applyDosSantosMarginUs();
+    if (m_Debounce.isOK(DB_B1)) {
+      m_Debounce.applyDosSantosMarginUs(DB_B2, m_ScanNowUs);
     }
-    if (Debounce_b2.isOK()) {
-      Debounce_b1.applyDosSantosMarginUs();
+    if (m_Debounce.isOK(DB_B2)) {
+      m_Debounce.applyDosSantosMarginUs(DB_B1, m_ScanNowUs);
     }
 
     // if (Debounce_b1.isOK())
     {
       // check validity
-      if (lastValid_l) {
+      if (m_Scan.lastValid_l) {
         // Serial.println("Red");
-        if (Debounce_b1.isOK()) {
+        if (m_Debounce.isOK(DB_B1)) {
           Red = true;
           Buzz = true;
           SignalLeft = true;
+          m_ContactStartLeftUs = m_Debounce.startTime(DB_B1);
           StartLock(FOIL_LOCK_TIME);
         }
       } else {
-        if (HitOnGuard_l()) {
-          Debounce_b1.reset();
+        if (RunProbe(FoilChecks[FOIL_GUARD_L])) {
+          m_Debounce.reset(DB_B1);
           // Serial.println("Guard");
         } else {
-          if (HitOnPiste_l()) {
-            Debounce_b1.reset();
+          if (RunProbe(FoilChecks[FOIL_PISTE_L])) {
+            m_Debounce.reset(DB_B1);
             // Serial.println("Piste");
           } else {
             // Serial.println("WhiteL");
-            if (Debounce_b1.isOK()) {
+            if (m_Debounce.isOK(DB_B1)) {
               WhiteL = true;
               Buzz = true;
               SignalLeft = true;
+              m_ContactStartLeftUs = m_Debounce.startTime(DB_B1);
               StartLock(FOIL_LOCK_TIME);
             }
           }
@@ -220,28 +200,30 @@ void MultiWeaponSensor::DoFoil(void) {
     {
 
       // check validity
-      if (lastValid_r) {
+      if (m_Scan.lastValid_r) {
         // Serial.println("Green");
-        if (Debounce_b2.isOK()) {
+        if (m_Debounce.isOK(DB_B2)) {
           Green = true;
           Buzz = true;
           SignalRight = true;
+          m_ContactStartRightUs = m_Debounce.startTime(DB_B2);
           StartLock(FOIL_LOCK_TIME);
         }
       } else {
-        if (HitOnGuard_r()) {
-          Debounce_b1.reset();
+        if (RunProbe(FoilChecks[FOIL_GUARD_R])) {
+          m_Debounce.reset(DB_B1);
           // Serial.println("Guard");
         } else {
-          if (HitOnPiste_r()) {
-            Debounce_b1.reset();
+          if (RunProbe(FoilChecks[FOIL_PISTE_R])) {
+            m_Debounce.reset(DB_B1);
             // Serial.println("Piste");
           } else {
             // Serial.println("WhiteR");
-            if (Debounce_b2.isOK()) {
+            if (m_Debounce.isOK(DB_B2)) {
               WhiteR = true;
               Buzz = true;
               SignalRight = true;
+              m_ContactStartRightUs = m_Debounce.startTime(DB_B2);
               StartLock(FOIL_LOCK_TIME);
             }
           }
@@ -251,6 +233,7 @@ void MultiWeaponSensor::DoFoil(void) {
 
     break;
   }
-  lastValid_l = Valid_l;
-  lastValid_r = Valid_r;
+  // This is needed in case we need to apply the Dos Santos trick
+  m_Scan.lastValid_l = Valid_l;
+  m_Scan.lastValid_r = Valid_r;
 }
\ No newline at end of file
@@ -7,5 +7,38 @@
 #define SECOND_PROTO 1
 #define PowerPin 12
 
+// If you have different pins, change below defines
+/*#define cl_analog 36
+#define bl_analog 39
+#define piste_analog 34
+#define cr_analog 35
+#define br_analog 32*/
+// Below table uses AD channels and not pin numbers
+#define cl_analog 0
+#define bl_analog 3
+#define piste_analog 6
+#define cr_analog 7
+#define br_analog 4
+
+#ifdef FIRST_PROTO
+#define al_driver 22
+#define bl_driver 21
+#define cl_driver 23
+#define ar_driver 05
+#define br_driver 04
+#define cr_driver 18
+#define piste_driver 19
+#endif
+
+#ifdef SECOND_PROTO
+#define al_driver 33
+#define bl_driver 21
+#define cl_driver 23
+#define ar_driver 25
+#define br_driver 05
+#define cr_driver 18
+#define piste_driver 19
+#endif
+
 
 #endif
@@ -138,7 +138,8 @@ void setup() {
     MyCyranoHandler = &CyranoHandler::getInstance();
     MyStatemachine->ResetAll();
     MyFPA422Handler->StartWiFi();
-    MyStatemachine->attach(*MyFPA422Handler);   // FPA422: raw display events (score/time/cards)
+    MyStatemachine->attach(*MyFPA422Handler,    // FPA422: raw display events (score/time/cards)
+                           FPA422Handler::StateMachineEvents());
     MyUDPIOHandler->attach(*MyStatemachine);
     MyStatemachine->attach(*MyUDPIOHandler);
     MyUDPIOHandler->attach(*MyCyranoHandler);
@@ -148,12 +149,13 @@ void setup() {
     MyStatemachine->begin();
     MySensor->begin();
 
-    MyStatemachine->attach(*MyTimeScoreDisplay);
+    MyStatemachine->attach(*MyTimeScoreDisplay,
+                           TimeScoreDisplay::StateMachineEvents());
     MyCyranoHandler->Begin();
 
     // Initialize OPP2 Handler (parallel with CyranoHandler)
     MyOpp2Handler = &Opp2Handler::getInstance();
-    MyStatemachine->attach(*MyOpp2Handler);
+    MyStatemachine->attach(*MyOpp2Handler, Opp2Handler::StateMachineEvents());
     MyOpp2Handler->setFSM(MyStatemachine);
     MyUDPIOHandler->attach(*MyOpp2Handler);
     MyOpp2Handler->attach(
@@ -165,7 +167,7 @@ void setup() {
     MyRepeaterSender = &RepeaterSender::getInstance();
     MyRepeaterSender->begin();
     MyStatemachine->attach(*MyRepeaterSender);
-    MyStatemachine->attach(*MyLedStrip);
+    MyStatemachine->attach(*MyLedStrip, WS2812B_LedStrip::StateMachineEvents());
     MyStatemachine->SetMachineWeapon(MySensor->GetActualWeapon());
     switch (MySensor->GetActualWeapon()) {
     case FOIL:
@@ -178,7 +180,8 @@ void setup() {
       MyStatemachine->StateChanged(EVENT_WEAPON | WEAPON_MASK_SABRE);
       break;
     }
-    MyStatemachine->attach(AutoRef::getInstance());
+    MyStatemachine->attach(AutoRef::getInstance(),
+                           AutoRef::StateMachineEvents());
     AutoRef::getInstance().begin();
     AutoRef::getInstance().setEnabled(false);
     MySensor->getLongHitDetector().attach(AutoRef::getInstance());
@@ -3,88 +3,72 @@
 #include "FastADC1.h"
 #include "FastGPIOSettings.h"
 #include "ResistorSetting.h"
+#include "ScanPlan.h"
 
-inline bool WireOK_l() {
-  Set_IODirectionAndValue(IODirection_al_bl, IOValues_al_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue < AxXy_280_Ohm);
+// Probes run on every scan: blade contact on the opponent's mask/lame.
+enum SabrePlanProbe { SABRE_CL, SABRE_CR, SABRE_PLAN_SIZE };
+static constexpr ScanProbe SabrePlan[SABRE_PLAN_SIZE] = {
+    {IODirection_bl_cr, IOValues_bl_cr, cr_analog, false, &BxCy_200_Ohm},
+    {IODirection_br_cl, IOValues_br_cl, cl_analog, false, &BxCy_200_Ohm},
 };
 
-inline bool EpeeHit_l() {
-  Set_IODirectionAndValue(IODirection_al_cl, IOValues_al_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > AxXy_280_Ohm);
+// Probes the idle sequence runs one at a time
+enum SabreCheck {
+  SABRE_WIRE_L, // al-bl continuity: white light when open
+  SABRE_WIRE_R,
+  SABRE_EPEE_L, // al-cl and ar-cr: epee tip contact, for weapon detection
+  SABRE_EPEE_R,
+  SABRE_FOIL_R, // al-cr and ar-cl: foil touch on the lame, weapon detection
+  SABRE_FOIL_L,
+  SABRE_PARRY,
+  SABRE_PISTE, // result unused, see the sequence below
+  SABRE_CHECKS
 };
-
-inline bool WireOK_r() {
-  Set_IODirectionAndValue(IODirection_ar_br, IOValues_ar_br);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)br_analog);
-  return (tempADValue < AxXy_280_Ohm);
-};
-
-inline bool EpeeHit_r() {
-  Set_IODirectionAndValue(IODirection_ar_cr, IOValues_ar_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > AxXy_280_Ohm);
-};
-
-inline bool Parry() {
-  Set_IODirectionAndValue(IODirection_br_bl, IOValues_br_bl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)bl_analog);
-  return (tempADValue > BxCy_280_Ohm);
-};
-
-inline bool FoilHit_l() {
-  Set_IODirectionAndValue(IODirection_ar_cl, IOValues_ar_cl);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  return (tempADValue > AxXy_280_Ohm);
-};
-
-inline bool FoilHit_r() {
-  Set_IODirectionAndValue(IODirection_al_cr, IOValues_al_cr);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  return (tempADValue > AxXy_280_Ohm);
-};
-
-inline bool DummyPisteCheck() {
-  Set_IODirectionAndValue(IODirection_al_piste, IOValues_al_piste);
-  int tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)piste_analog);
-  return (false);
+static constexpr ScanProbe SabreChecks[SABRE_CHECKS] = {
+    {IODirection_al_bl, IOValues_al_bl, bl_analog, true, &AxXy_280_Ohm},
+    {IODirection_ar_br, IOValues_ar_br, br_analog, true, &AxXy_280_Ohm},
+    {IODirection_al_cl, IOValues_al_cl, cl_analog, false, &AxXy_280_Ohm},
+    {IODirection_ar_cr, IOValues_ar_cr, cr_analog, false, &AxXy_280_Ohm},
+    {IODirection_al_cr, IOValues_al_cr, cr_analog, false, &AxXy_280_Ohm},
+    {IODirection_ar_cl, IOValues_ar_cl, cl_analog, false, &AxXy_280_Ohm},
+    {IODirection_br_bl, IOValues_br_bl, bl_analog, false, &BxCy_280_Ohm},
+    {IODirection_al_piste, IOValues_al_piste, piste_analog, false,
+     &AxXy_280_Ohm},
 };
 
 // ToDo: add a check for piste. This is logically not needed, but it avoids
 // building up out of bound voltages
-enum SabreState { IDLE, DEBOUNCING, DEBOUNCED, LOCKING, LOCKED };
-static const int sequence[] = {0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8};
-static const int sequence_length = 16;
-static int sequence_index = 0;
+static constexpr uint8_t sequence[] = {0, 1, 0, 2, 0, 3, 0, 4,
+                                       0, 5, 0, 6, 0, 7, 0, 8};
+static constexpr uint8_t sequence_length = sizeof(sequence);
 void MultiWeaponSensor::DoSabre(void) {
   bool cl, cr;
-  static SabreState state = IDLE;
-  static int SubsampleCounter = 0;
+  ScanState &state = m_Scan.state;
+  uint8_t &sequence_index = m_Scan.subsample;
   bool tempRed = false;
   bool tempGreen = false;
 
-  Set_IODirectionAndValue(IODirection_bl_cr, IOValues_bl_cr);
-  tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cr_analog);
-  cl = (tempADValue > BxCy_200_Ohm);
-
-  Set_IODirectionAndValue(IODirection_br_cl, IOValues_br_cl);
-  tempADValue = fast_adc1_get_raw_inline((adc1_channel_t)cl_analog);
-  cr = (tempADValue > BxCy_200_Ohm);
+  int raw[SABRE_PLAN_SIZE];
+  uint32_t probes = RunScanPlan(SabrePlan, raw);
+  tempADValue = raw[SABRE_CR];
+  cl = probes & (1u << SABRE_CL);
+  cr = probes & (1u << SABRE_CR);
 
-  Debounce_c1.update(cl);
-  Debounce_c2.update(cr);
+  m_Debounce.update(DEBOUNCE_BIT(DB_C1) | DEBOUNCE_BIT(DB_C2),
+                    (cl ? DEBOUNCE_BIT(DB_C1) : 0) |
+                        (cr ? DEBOUNCE_BIT(DB_C2) : 0),
+                    m_ScanNowUs);
 
   // Sabre has no invalid hits.
-  LongHitDetector_.update(cl, cr);
-  DoubleHitDetector_.update(cl, cr);
+  LongHitDetector_.update(m_ScanNowUs, cl, cr);
+  DoubleHitDetector_.update(m_ScanNowUs, cl, cr);
 
+  m_ScanDebouncing = (state == SCAN_DEBOUNCING);
   switch (state) {
-  case IDLE:
+  case SCAN_IDLE:
 
     if (cl || cr) {
-      state = DEBOUNCING;
+      state = SCAN_DEBOUNCING;
       break;
     } else {
       // Do one of the optional checks
@@ -92,13 +76,15 @@ void MultiWeaponSensor::DoSabre(void) {
       case 0:
         // SubsampleCounter = 1;
         if (bAutoDetect) {
-          Debounce_Parry.update(Parry());
+          Debounce_Parry.update(RunProbe(SabreChecks[SABRE_PARRY]),
+                                m_ScanNowUs);
         }
         break;
 
       case 1:
         // SubsampleCounter = 2;
-        if (Debounce_SabreWhite_l.update(WireOK_l())) {
+        if (Debounce_SabreWhite_l.update(RunProbe(SabreChecks[SABRE_WIRE_L]),
+                                         m_ScanNowUs)) {
           WhiteL = true;
         } else {
           WhiteL = false;
@@ -106,7 +92,8 @@ void MultiWeaponSensor::DoSabre(void) {
         break;
       case 2:
         // SubsampleCounter = 3;
-        if (Debounce_SabreWhite_r.update(WireOK_r())) {
+        if (Debounce_SabreWhite_r.update(RunProbe(SabreChecks[SABRE_WIRE_R]),
+                                         m_ScanNowUs)) {
           WhiteR = true;
         } else {
           WhiteR = false;
@@ -115,53 +102,57 @@ void MultiWeaponSensor::DoSabre(void) {
       case 3:
         // You can also show Yellow here
         // SubsampleCounter = 4;
-        DebounceLong_al_cl.update(EpeeHit_l());
+        m_Debounce.update(DB_LONG_AL_CL, RunProbe(SabreChecks[SABRE_EPEE_L]),
+                          m_ScanNowUs);
 
         break;
       case 4:
         // You can also show Yellow here
         // SubsampleCounter = 5;
-        DebounceLong_ar_cr.update(EpeeHit_r());
+        m_Debounce.update(DB_LONG_AR_CR, RunProbe(SabreChecks[SABRE_EPEE_R]),
+                          m_ScanNowUs);
         break;
 
       case 6:
         // SubsampleCounter = 7;
         if (bAutoDetect) {
-          DebounceLong_al_cr.update(FoilHit_r());
+          m_Debounce.update(DB_LONG_AL_CR, RunProbe(SabreChecks[SABRE_FOIL_R]),
+                            m_ScanNowUs);
         }
         break;
 
       case 7:
         // SubsampleCounter = 0;
         if (bAutoDetect) {
-          DebounceLong_ar_cl.update(FoilHit_l());
+          m_Debounce.update(DB_LONG_AR_CL, RunProbe(SabreChecks[SABRE_FOIL_L]),
+                            m_ScanNowUs);
         }
         break;
 
       case 8:
-        DummyPisteCheck();
+        SampleProbe(SabreChecks[SABRE_PISTE]);
         break;
       }
     }
     sequence_index = (sequence_index + 1) % sequence_length;
     break;
 
-  case DEBOUNCING:
+  case SCAN_DEBOUNCING:
 
     if (!cl && !cr) {
       // no longer conditions to debounce-> go back to IDLE
-      state = IDLE;
+      state = SCAN_IDLE;
       break;
     }
     // Trick to satisfy Dos Santos. Not Sure if still needed
-    /*if (Debounce_c1.isOK()) {
-      Debounce_c2.applyDosSantosMarginUs(false);
+    /*if (m_Debounce.isOK(DB_C1)) {
+      m_Debounce.applyDosSantosMarginUs(DB_C2, m_ScanNowUs, false);
     }
-    if (Debounce_c2.isOK()) {
-      Debounce_c1.applyDosSantosMarginUs(false);
+    if (m_Debounce.isOK(DB_C2)) {
+      m_Debounce.applyDosSantosMarginUs(DB_C1, m_ScanNowUs, false);
     }*/
 
-    if (Debounce_c1.isOK() && !SignalLeft) {
+    if (m_Debounce.isOK(DB_C1) && !SignalLeft) {
       // reduce required time for b2
       // check validity
 
@@ -169,9 +160,10 @@ void MultiWeaponSensor::DoSabre(void) {
       Red = true;
       Buzz = true;
       SignalLeft = true;
+      m_ContactStartLeftUs = m_Debounce.startTime(DB_C1);
       StartLock(SABRE_LOCK_TIME);
     }
-    if (Debounce_c2.isOK() && !SignalRight) {
+    if (m_Debounce.isOK(DB_C2) && !SignalRight) {
       // reduce required time for b2
       // check validity
 
@@ -179,6 +171,7 @@ void MultiWeaponSensor::DoSabre(void) {
       Green = true;
       Buzz = true;
       SignalRight = true;
+      m_ContactStartRightUs = m_Debounce.startTime(DB_C2);
       StartLock(SABRE_LOCK_TIME);
     }
 
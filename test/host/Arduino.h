@@ -0,0 +1,33 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for the part of Arduino-ESP32 and FreeRTOS the state machine
+// uses (FencingStateMachine, UW2FTimer). There is one task, the test program:
+// millis() reads the same virtual clock as esp_timer_get_time(), which the
+// test program defines, and task notifications go nowhere.
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#define IRAM_ATTR
+
+typedef struct hw_timer_s hw_timer_t;
+
+// On the ESP32 millis() is esp_timer_get_time() / 1000 in 32 bits
+inline unsigned long millis() {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static int task;
+  return &task;
+}
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline uint32_t ulTaskNotifyTake(int, TickType_t) { return 0; }
+inline int xSemaphoreGiveFromISR(SemaphoreHandle_t, void *) { return pdTRUE; }
+inline int xTaskCreatePinnedToCore(void (*)(void *), const char *, uint32_t,
+                                   void *, int, TaskHandle_t *task, int) {
+  *task = nullptr; // no task on the host: drive DoStateMachineTick() yourself
+  return pdTRUE;
+}
@@ -0,0 +1,17 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for Arduino-ESP32 Preferences: an empty NVS. Every get
+// returns its default, every put is dropped.
+#include <stddef.h>
+#include <stdint.h>
+
+class Preferences {
+public:
+  bool begin(const char *, bool = false) { return true; }
+  void end() {}
+  bool getBool(const char *, bool value = false) { return value; }
+  uint32_t getUInt(const char *, uint32_t value = 0) { return value; }
+  int32_t getInt(const char *, int32_t value = 0) { return value; }
+  size_t putInt(const char *, int32_t) { return 0; }
+};
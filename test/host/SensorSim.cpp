@@ -0,0 +1,325 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#include "SensorSim.h"
+#include "EventDefinitions.h"
+#include "FastADC1.h"
+#include "FastGPIOSettings.h"
+#include "ResistorSetting.h"
+#include "TimingConstants.h"
+#include "hardwaredefinition.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+// ResistorDividerCalibrator::set_default_calibration()
+static constexpr float V_GPIO = 3.3643f;
+static constexpr float R1_EFF = 495.6f;    // driver of a B, C or piste line
+static constexpr float R1_AX_EFF = 87.94f; // driver of an A line
+static constexpr float R3_EFF = 503.79f;   // driver of the measured line
+static constexpr float OPEN = -1.0f;
+
+static float s_Ohms[SIM_LINES][SIM_LINES];
+static uint8_t s_Direction = 0xff; // all inputs
+static uint8_t s_Values = 0;
+
+int64_t SensorSim::s_Clock = 1000000; // debouncers treat 0 as "no contact"
+SensorSim *SensorSim::s_Current = nullptr;
+
+uint64_t ScanTimestamp::s_Reads = 0;
+void (*ScanTimestamp::s_OnRead)() = nullptr;
+
+// Timestamp use: scans counted, the host times of the first and last
+// timestamp read of the current scan and the spread of each scan when
+// measuring skew
+static uint64_t s_TimestampScans = 0;
+static std::vector<float> s_Spreads;
+static bool s_ScanRead = false;
+static std::chrono::steady_clock::time_point s_FirstRead, s_LastRead;
+
+static void TimestampRead() {
+  s_LastRead = std::chrono::steady_clock::now();
+  if (!s_ScanRead)
+    s_FirstRead = s_LastRead;
+  s_ScanRead = true;
+}
+
+// Replayed capture: per probe (drive pattern and channel) the recorded
+// samples in time order, and how far the replay has got.
+struct ReplayTrack {
+  std::vector<std::pair<int64_t, int>> samples; // time since start, raw
+  size_t next = 0;
+};
+static std::map<uint32_t, ReplayTrack> s_Replay;
+static bool s_Replaying = false;
+static int64_t s_ReplayStart = 0; // s_Clock of the replaying SensorSim
+
+static uint32_t ProbeKey(uint8_t direction, uint8_t values, uint8_t channel) {
+  return (uint32_t)direction << 16 | (uint32_t)values << 8 | channel;
+}
+
+static int RawForVolts(float v) {
+  int raw = (int)(v / V_GPIO * 4095.0f);
+  return raw < 0 ? 0 : (raw > 4095 ? 4095 : raw);
+}
+
+static int ThresholdFor(float r1, float ohms) {
+  return RawForVolts(V_GPIO * R3_EFF / (r1 + ohms + R3_EFF));
+}
+
+static int LineOfChannel(uint8_t channel) {
+  switch (channel) {
+  case cl_analog:
+    return CL;
+  case bl_analog:
+    return BL;
+  case br_analog:
+    return BR;
+  case cr_analog:
+    return CR;
+  case piste_analog:
+    return PISTE;
+  }
+  return -1;
+}
+
+void SensorSim::setDefaultThresholds() {
+  AxXy_160_Ohm = ThresholdFor(R1_AX_EFF, 160);
+  AxXy_250_Ohm = ThresholdFor(R1_AX_EFF, 250);
+  AxXy_280_Ohm = ThresholdFor(R1_AX_EFF, 280);
+  BxCy_200_Ohm = ThresholdFor(R1_EFF, 220);
+  BxCy_280_Ohm = ThresholdFor(R1_EFF, 280);
+  AxXy_125_Ohm = ThresholdFor(R1_AX_EFF, 125);
+  AxXy_200_Ohm = ThresholdFor(R1_AX_EFF, 200);
+  AxXy_300_Ohm = ThresholdFor(R1_AX_EFF, 300);
+  AxXy_430_Ohm = ThresholdFor(R1_AX_EFF, 430);
+  AxXy_450_Ohm = ThresholdFor(R1_AX_EFF, 450);
+  BxCy_450_Ohm = ThresholdFor(R1_EFF, 450);
+}
+
+void SensorSim::connect(SimLine a, SimLine b, float ohms) {
+  s_Ohms[a][b] = s_Ohms[b][a] = ohms;
+}
+
+void SensorSim::disconnect(SimLine a, SimLine b) { connect(a, b, OPEN); }
+
+void SensorSim::disconnectAll() {
+  for (int a = 0; a < SIM_LINES; a++)
+    for (int b = 0; b < SIM_LINES; b++)
+      s_Ohms[a][b] = OPEN;
+}
+
+bool SensorSim::replay(const uint8_t *data, size_t size, weapon_t &weapon,
+                       int64_t &span_us) {
+  RawCapture::Header header;
+  if (size < sizeof(header))
+    return false;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, "ORC1", 4) ||
+      header.sample_size != sizeof(RawCapture::Sample) ||
+      size < header.header_size + (size_t)header.count * header.sample_size)
+    return false;
+  s_Replay.clear();
+  span_us = 0;
+  uint32_t first = 0;
+  for (uint32_t i = 0; i < header.count; i++) {
+    RawCapture::Sample sample;
+    memcpy(&sample, data + header.header_size + i * header.sample_size,
+           sizeof(sample));
+    if (i == 0)
+      first = sample.time_us;
+    int64_t at = (uint32_t)(sample.time_us - first); // low 32 bits wrap
+    uint8_t channel = (sample.raw >> 12) & 0x07;
+    s_Replay[ProbeKey(sample.direction, sample.values, channel)]
+        .samples.push_back(std::make_pair(at, sample.raw & 0x0fff));
+    span_us = at;
+  }
+  weapon = header.weapon <= SABRE ? (weapon_t)header.weapon : UNKNOWN;
+  s_Replaying = true;
+  s_ReplayStart = s_Clock;
+  return true;
+}
+
+// Only direct connections count: every driven-high line that is connected to
+// the measured line adds a parallel path into the measured line's driver.
+int SensorSim::sample(uint8_t direction, uint8_t values, uint8_t channel) {
+  if (s_Replaying) {
+    auto track = s_Replay.find(ProbeKey(direction, values, channel));
+    if (track != s_Replay.end()) {
+      ReplayTrack &t = track->second;
+      int64_t now = s_Clock - s_ReplayStart;
+      while (t.next + 1 < t.samples.size() &&
+             t.samples[t.next + 1].first <= now)
+        t.next++;
+      return t.samples[t.next].second;
+    }
+  }
+  int measured = LineOfChannel(channel);
+  if (measured < 0)
+    return 0;
+  float conductance = 0;
+  for (int line = 0; line < SIM_LINES; line++) {
+    bool high = !(direction & (1 << line)) && (values & (1 << line));
+    if (!high)
+      continue;
+    if (line == measured)
+      return 4095;
+    float ohms = s_Ohms[line][measured];
+    if (ohms < 0)
+      continue;
+    float r1 = (line == AL || line == AR) ? R1_AX_EFF : R1_EFF;
+    conductance += 1.0f / (r1 + ohms);
+  }
+  return RawForVolts(V_GPIO * conductance / (conductance + 1.0f / R3_EFF));
+}
+
+// Forwards the detector notifications to the running SensorSim. Attached
+// once: the sensor and its observer tables outlive every SensorSim.
+class SensorSim::DetectorObserver : public Observer<LongHitDetector>,
+                                    public Observer<DoubleHitDetector> {
+public:
+  void update(LongHitDetector *, uint32_t eventtype) override {
+    record(eventtype);
+  }
+  void update(DoubleHitDetector *, uint32_t eventtype) override {
+    record(eventtype);
+  }
+
+private:
+  static void record(uint32_t eventtype) {
+    if (s_Current)
+      s_Current->m_DetectorEvents.push_back(
+          {s_Clock - s_Current->m_Start, eventtype});
+  }
+};
+
+SensorSim::SensorSim(weapon_t weapon)
+    : m_Sensor(MultiWeaponSensor::getInstance()), m_Start(s_Clock) {
+  static DetectorObserver observer;
+  static bool attached = false;
+  if (!attached) {
+    m_Sensor.getLongHitDetector().attach(observer);
+    m_Sensor.getDoubleHitDetector().attach(observer);
+    attached = true;
+  }
+  s_Current = this;
+  // A replay loaded just before this SensorSim belongs to it; an older one
+  // ends here.
+  if (s_Replaying && s_ReplayStart != s_Clock) {
+    s_Replaying = false;
+    s_Replay.clear();
+  }
+  disconnectAll();
+  m_Sensor.Setweapon_detection_mode(MANUAL);
+  m_Sensor.SetActualWeapon(weapon);
+  // The first scan applies the weapon and resets; lights left on by a
+  // previous SensorSim going off are not part of this run. Neither is a
+  // press the detectors still track from it (a replay can end mid-press).
+  scan();
+  m_Sensor.getLongHitDetector().reset();
+  m_Sensor.getDoubleHitDetector().reset();
+  m_Events.clear();
+  m_DetectorEvents.clear();
+}
+
+SensorSim::~SensorSim() {
+  if (s_Current == this)
+    s_Current = nullptr;
+}
+
+void SensorSim::runUntil(int64_t until_us) {
+  while (now() < until_us)
+    scan();
+}
+
+void SensorSim::printEvents() const {
+  static const struct {
+    uint32_t mask;
+    const char *name;
+  } lights[] = {{MASK_RED, "red"},           {MASK_WHITE_L, "white_l"},
+                {MASK_ORANGE_L, "orange_l"}, {MASK_GREEN, "green"},
+                {MASK_WHITE_R, "white_r"},   {MASK_ORANGE_R, "orange_r"},
+                {MASK_BUZZ, "buzz"},         {MASK_PARRY, "parry"}};
+  if (m_Events.empty())
+    printf("  no lights\n");
+  for (const HitEvent &event : m_Events) {
+    printf("  %8.2f ms  lights", event.time_us / 1000.0);
+    bool any = false;
+    for (const auto &light : lights) {
+      if (event.event & light.mask) {
+        printf(" %s", light.name);
+        any = true;
+      }
+    }
+    printf(any ? "\n" : " off\n");
+  }
+}
+
+void SensorSim::printDetectorEvents() const {
+  for (const DetectorEvent &event : m_DetectorEvents) {
+    printf("  %8.2f ms  ", event.time_us / 1000.0);
+    if ((event.event & MAIN_TYPE_MASK) == EVENT_LONGHIT)
+      LongHitDetector::printEvent(event.event);
+    else
+      DoubleHitDetector::printEvent(event.event);
+  }
+}
+
+void SensorSim::resetTimestampUse(bool measure_skew) {
+  s_TimestampScans = 0;
+  s_Spreads.clear();
+  ScanTimestamp::s_Reads = 0;
+  ScanTimestamp::s_OnRead = measure_skew ? TimestampRead : nullptr;
+}
+
+SensorSim::TimestampUse SensorSim::timestampUse() {
+  TimestampUse use = {s_TimestampScans, ScanTimestamp::s_Reads, 0, 0, 0};
+  if (s_Spreads.empty())
+    return use;
+  std::vector<float> spreads = s_Spreads;
+  double sum = 0;
+  for (float spread : spreads)
+    sum += spread;
+  use.spread_mean_ns = sum / spreads.size();
+  std::sort(spreads.begin(), spreads.end());
+  use.spread_p99_ns = spreads[spreads.size() * 99 / 100];
+  use.spread_max_ns = spreads.back();
+  return use;
+}
+
+void SensorSim::scan() {
+  RawCapture::beginScan((uint32_t)s_Clock);
+  s_ScanRead = false;
+  m_Sensor.DoFullScan(s_Clock);
+  m_Scans++;
+  s_TimestampScans++;
+  if (s_ScanRead)
+    s_Spreads.push_back(
+        std::chrono::duration<float, std::nano>(s_LastRead - s_FirstRead)
+            .count());
+  HitEvent event;
+  while (m_Sensor.PopHitEvent(event)) {
+    event.time_us -= m_Start;
+    if (event.contact_left_us)
+      event.contact_left_us -= m_Start;
+    if (event.contact_right_us)
+      event.contact_right_us -= m_Start;
+    if (event.lockout_us)
+      event.lockout_us -= m_Start;
+    m_Events.push_back(event);
+  }
+  s_Clock += scanloop_us;
+}
+
+// The primitives of FastGPIOSettings.h and FastADC1.h
+
+void Set_IODirectionAndValue(uint8_t direction, uint8_t values) {
+  s_Direction = direction;
+  s_Values = values;
+}
+
+void disable_gpio33_pull() {}
+
+int fast_adc1_get_raw_inline(adc1_channel_t channel) {
+  return SensorSim::sample(s_Direction, s_Values, (uint8_t)channel);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+#include "3WeaponSensor.h"
+#include "RawCapture.h"
+#include <stdint.h>
+#include <vector>
+
+// Host stand-in for the sensor hardware. It implements the primitives of
+// FastGPIOSettings.h and FastADC1.h on a model of the two connectors and the
+// piste: a table of resistances between lines, set by the scenario. A probe
+// reads the divider formed by the driver resistance of the high pin(s), the
+// scripted resistance and the driver resistance of the measured pin, the
+// model ResistorDividerCalibrator uses for its thresholds.
+//
+// Instead of the line table, a probe can also be answered from a RawCapture
+// dump recorded on a box (replay()): each probe returns the last value
+// recorded for the same drive pattern and channel at or before the current
+// scan time.
+//
+// Time is virtual: runUntil() calls DoFullScan() every scanloop_us, as the
+// esp_timer callback does, and pops the HitEvents like the state machine.
+// The sensor is a singleton, so the clock keeps running from one SensorSim
+// to the next; a SensorSim reports times relative to its own start.
+
+// Lines in the bit order of the IODirection_* / IOValues_* masks
+enum SimLine { AL, BL, CL, AR, BR, CR, PISTE, SIM_LINES };
+
+class SensorSim {
+public:
+  // Thresholds of ResistorSetting.h from the default calibration, like
+  // initializeResistorThresholds() without a stored calibration.
+  static void setDefaultThresholds();
+
+  static void connect(SimLine a, SimLine b, float ohms);
+  static void disconnect(SimLine a, SimLine b);
+  static void disconnectAll();
+
+  // Raw reading the model gives for one probe
+  static int sample(uint8_t direction, uint8_t values, uint8_t channel);
+
+  // Loads a serialized RawCapture ("ORC1"); probes are answered from it until
+  // the next SensorSim. Returns false if the data is not a capture. Sample
+  // times become relative to the first sample; weapon is set from the header,
+  // span_us to the time of the last sample.
+  static bool replay(const uint8_t *data, size_t size, weapon_t &weapon,
+                     int64_t &span_us);
+
+  // Clears the line table and selects the weapon with manual detection; the
+  // first scan, run here at t=0, applies it and resets the lights.
+  explicit SensorSim(weapon_t weapon);
+  ~SensorSim();
+  SensorSim(const SensorSim &) = delete;
+  SensorSim &operator=(const SensorSim &) = delete;
+
+  // Scans until `until_us` after the start
+  void runUntil(int64_t until_us);
+  int64_t now() const { return s_Clock - m_Start; }
+  uint64_t scans() const { return m_Scans; }
+
+  // Lights changes since the start; time_us and the contact/lockout times
+  // are relative to the start (0 stays 0)
+  const std::vector<HitEvent> &events() const { return m_Events; }
+  // One line per event: time in ms and the lights that are on
+  void printEvents() const;
+
+  // EVENT_LONGHIT / EVENT_DOUBLEHIT notifications of the sensor's detectors
+  // since the start, with the scan time relative to the start
+  struct DetectorEvent {
+    int64_t time_us;
+    uint32_t event;
+  };
+  const std::vector<DetectorEvent> &detectorEvents() const {
+    return m_DetectorEvents;
+  }
+  void printDetectorEvents() const;
+
+  MultiWeaponSensor &sensor() { return m_Sensor; }
+
+  // Reads of the scan timestamp (ScanTimestamp) over all scans since the
+  // last resetTimestampUse(). With skew measurement on, every read also
+  // takes the host time, and spread is the host time from the first to the
+  // last read of a scan: how far apart the instants were when each of those
+  // places read the timer itself.
+  struct TimestampUse {
+    uint64_t scans;
+    uint64_t reads;
+    double spread_mean_ns;
+    double spread_p99_ns; // the max is mostly the host preempting a scan
+    double spread_max_ns;
+  };
+  static void resetTimestampUse(bool measure_skew);
+  static TimestampUse timestampUse();
+
+private:
+  class DetectorObserver;
+  void scan();
+
+  static int64_t s_Clock;
+  static SensorSim *s_Current;
+  MultiWeaponSensor &m_Sensor;
+  int64_t m_Start;
+  uint64_t m_Scans = 0;
+  std::vector<HitEvent> m_Events;
+  std::vector<DetectorEvent> m_DetectorEvents;
+};
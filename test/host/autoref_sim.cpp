@@ -0,0 +1,686 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Bout simulator for AutoRefCore, the AutoRef referee logic.
+//
+//   autoref_sim                 run the scripted cases and 300 random bouts
+//   --bouts N --seed N          number of random bouts, first seed
+//   -v                          print every action of the random bouts
+//
+// The simulator runs AutoRefCore the way AutoRef::AutoRefHandler does: a
+// loop pass every 40 ms (or when an event arrives) calls onEvent() for the
+// event and then checkTimeouts(), both with the time read at the start of the
+// pass. The returned actions are executed against a model of the match: FSM
+// score commands change the scores the next call sees, AR_ACTION_DELAY_MS
+// advances the virtual clock as the vTaskDelay() would.
+//
+// Scripted cases cover enabling, the timer-zero contexts, UW2F, confirmation
+// timeouts, hits during the break and the reset. Random bouts draw phrases
+// (single, double, off-target, mixed, confirmations, undos, UW2F) for a
+// random weapon and bout length and check after each phrase the actions and
+// states the rules require and the score against a running tally, until the
+// match is over. Every bout is run twice from the same seed and must produce
+// the same trace.
+#include "AutoRefCore.h"
+#include "EventDefinitions.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t LOOP_MS = 40; // xQueueReceive() timeout
+static constexpr uint32_t DOUBLE_LONG_PRESS =
+    EVENT_LONGHIT | LONGHIT_VALID_LEFT | LONGHIT_VALID_RIGHT |
+    LONGHIT_IS_DOUBLE;
+static constexpr uint32_t UW2F_60S = EVENT_UW2F_TIMER | 0x00010000;
+
+static bool s_Verbose = false;
+
+static const char *StateName(AutoRefState_t state) {
+  static const char *names[] = {
+      "ARMED",      "WAITING_FOR_LIGHTS_OFF", "AWAITING_CONFIRMATION",
+      "AWARDING",   "EGPA",                   "PERIOD_END",
+      "UW2F_PCARD", "UW2F_RESUME",            "MATCH_OVER"};
+  return state <= AR_MATCH_OVER ? names[state] : "?";
+}
+
+static uint32_t TimerZero(TimerState_t state, bool lastRound, bool equal) {
+  return AUTOREF_TIMER_ZERO | (uint32_t)state << 8 | (lastRound ? 0x02 : 0) |
+         (equal ? 0x01 : 0);
+}
+
+// AutoRefCore with the task loop around it and a model of the match.
+class Bout {
+public:
+  Bout(const std::string &name, weapon_t weapon, int rounds) : m_Name(name) {
+    match.weapon = weapon;
+    match.timerState = FIGHTING;
+    match.nrOfRounds = rounds;
+  }
+
+  // One loop pass at the current time, with an event from the queue
+  void send(uint32_t event) { pass(&event); }
+  // Loop passes without events for ms
+  void run(uint32_t ms) {
+    uint32_t until = m_Now + ms;
+    while ((int32_t)(until - m_Now) > 0) {
+      uint32_t start = m_Now;
+      pass(nullptr);
+      if (m_Now == start) // no delay action advanced the clock
+        m_Now += LOOP_MS;
+    }
+  }
+  // Loop passes until the core is in state, at most max_ms (a pass at
+  // exactly max_ms included)
+  bool runUntil(AutoRefState_t state, uint32_t max_ms) {
+    uint32_t until = m_Now + max_ms;
+    while (core.state() != state && (int32_t)(until - m_Now) >= 0)
+      run(LOOP_MS);
+    return core.state() == state;
+  }
+
+  // Actions executed since the last mark()
+  void mark() { m_Actions.clear(); }
+  const std::vector<AutoRefAction> &actions() const { return m_Actions; }
+  int count(AutoRefActionType_t type, uint32_t value) const {
+    int n = 0;
+    for (const AutoRefAction &a : m_Actions)
+      n += a.type == type && a.value == value;
+    return n;
+  }
+  bool fsm(uint32_t command) const {
+    return count(AR_ACTION_FSM, EVENT_UI_INPUT | command) > 0;
+  }
+  bool animation(uint32_t event) const {
+    return count(AR_ACTION_ANIMATION, event) > 0;
+  }
+
+  void expectState(AutoRefState_t state, const char *what) {
+    if (core.state() != state)
+      fail("%s: state %s, expected %s", what, StateName(core.state()),
+           StateName(state));
+  }
+  void expect(bool condition, const char *what) {
+    if (!condition)
+      fail("%s", what);
+  }
+  void fail(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char text[256];
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (m_Ok || s_Verbose)
+      printf("  %s at %.2f s (%d-%d): %s\n", m_Name.c_str(), m_Now / 1000.0,
+             match.scoreLeft, match.scoreRight, text);
+    m_Ok = false;
+  }
+
+  bool ok() const { return m_Ok; }
+  uint32_t now() const { return m_Now; }
+  uint64_t trace() const { return m_Trace; }
+  const std::string &name() const { return m_Name; }
+
+  AutoRefCore core;
+  AutoRefMatchInfo match;
+  int pCards = 0;
+  bool priority = false;
+
+private:
+  void pass(const uint32_t *event) {
+    uint32_t now = m_Now;
+    AutoRefActions out;
+    if (event) {
+      core.onEvent(*event, now, match, out);
+      execute(out);
+      out.clear();
+    }
+    core.checkTimeouts(now, match, out);
+    execute(out);
+    hash(m_Now);
+    hash(core.state());
+  }
+
+  void execute(const AutoRefActions &out) {
+    if (out.count >= AUTOREF_MAX_ACTIONS)
+      fail("%d actions, the list may have dropped some", out.count);
+    for (int i = 0; i < out.count; i++) {
+      const AutoRefAction &a = out.list[i];
+      m_Actions.push_back(a);
+      hash(a.type);
+      hash(a.value);
+      if (s_Verbose)
+        printf("    %8.2f s  %-22s %d %08x\n", m_Now / 1000.0,
+               StateName(core.state()), a.type, a.value);
+      if (a.type == AR_ACTION_DELAY_MS)
+        m_Now += a.value;
+      else if (a.type == AR_ACTION_FSM)
+        command(a.value);
+    }
+  }
+
+  // What FencingStateMachine does with the commands AutoRef sends
+  void command(uint32_t value) {
+    if ((value & MAIN_TYPE_MASK) != EVENT_UI_INPUT) {
+      fail("FSM action %08x is not a UI input", value);
+      return;
+    }
+    switch (value & DATA_24BIT_MASK) {
+    case UI_INPUT_INCR_SCORE_LEFT:
+      match.scoreLeft++;
+      break;
+    case UI_INPUT_INCR_SCORE_RIGHT:
+      match.scoreRight++;
+      break;
+    case UI_INPUT_DECR_SCORE_LEFT:
+      if (match.scoreLeft)
+        match.scoreLeft--;
+      break;
+    case UI_INPUT_DECR_SCORE_RIGHT:
+      if (match.scoreRight)
+        match.scoreRight--;
+      break;
+    case UI_INPUT_RESET:
+      match.scoreLeft = match.scoreRight = 0;
+      match.timerState = FIGHTING;
+      pCards = 0;
+      priority = false;
+      break;
+    case UI_INPUT_P_CARD:
+      pCards++;
+      break;
+    case UI_INPUT_PRIO:
+      priority = true;
+      break;
+    case UI_INPUT_START_TIMER:
+    case UI_INPUT_STOP_TIMER:
+      break;
+    default:
+      fail("unexpected FSM command %08x", value);
+    }
+  }
+
+  // FNV-1a over everything the core did
+  void hash(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      m_Trace ^= (value >> (8 * i)) & 0xff;
+      m_Trace *= 1099511628211ULL;
+    }
+  }
+
+  std::string m_Name;
+  uint32_t m_Now = 1000;
+  bool m_Ok = true;
+  std::vector<AutoRefAction> m_Actions;
+  uint64_t m_Trace = 14695981039346656037ULL;
+};
+
+// Lights on for hold_ms, then off; each light in the list after the
+// previous one by gap_ms
+static void Lights(Bout &bout, std::initializer_list<uint32_t> lights,
+                   uint32_t gap_ms = 10, uint32_t hold_ms = 300) {
+  uint32_t on = 0;
+  for (uint32_t light : lights) {
+    on |= light;
+    bout.send(EVENT_LIGHTS | on);
+    bout.run(gap_ms);
+  }
+  bout.run(hold_ms);
+  bout.send(EVENT_LIGHTS);
+}
+
+// Double long press on a disabled core, then the EGPA and the timer start
+static void Enable(Bout &bout) {
+  bout.mark();
+  bout.send(DOUBLE_LONG_PRESS);
+  bout.expect(bout.core.isEnabled(), "double long press did not enable");
+  bout.expect(bout.count(AR_ACTION_CLEAR_LEDS, 0) == 1 &&
+                  bout.animation(EVENT_WS2812_AUTOREF_MODE),
+              "enable: no clear and AutoRef animation");
+  bout.expect(bout.runUntil(AR_ARMED, 10000), "enable: not armed in 10 s");
+  bout.expect(bout.animation(EVENT_WS2812_ENGARDE_PRETS_ALLEZ),
+              "enable: no EGPA");
+  bout.expect(bout.match.weapon == SABRE || bout.fsm(UI_INPUT_START_TIMER),
+              "enable: timer not started");
+}
+
+// Scripted cases
+
+static bool DisabledIgnoresAll() {
+  Bout bout("disabled", FOIL, 1);
+  bout.mark();
+  Lights(bout, {MASK_RED});
+  bout.send(EVENT_LONGHIT | LONGHIT_VALID_LEFT);
+  bout.send(EVENT_DOUBLEHIT | DOUBLEHIT_VALID_LEFT);
+  bout.send(UW2F_60S);
+  bout.send(TimerZero(FIGHTING, true, false));
+  bout.run(20000);
+  bout.expect(bout.actions().empty(), "actions while disabled");
+  bout.expectState(AR_ARMED, "disabled");
+  bout.expect(!bout.core.isEnabled(), "enabled by a single long press");
+  Enable(bout);
+  return bout.ok();
+}
+
+static bool ConfirmationTimeout() {
+  Bout bout("confirmation_timeout", SABRE, 1);
+  Enable(bout);
+  bout.mark();
+  Lights(bout, {MASK_RED, MASK_GREEN});
+  bout.expectState(AR_AWAITING_CONFIRMATION, "double");
+  bout.expect(bout.animation(EVENT_WS2812_CONFIRMATION_WAIT),
+              "no confirmation animation");
+  bout.run(AUTOREF_CONFIRMATION_TIMEOUT_MS - 500);
+  bout.expectState(AR_AWAITING_CONFIRMATION, "before the timeout");
+  // both lights again is no confirmation
+  Lights(bout, {MASK_RED | MASK_GREEN});
+  bout.expectState(AR_AWAITING_CONFIRMATION, "both sides again");
+  bout.run(1000);
+  bout.expect(bout.count(AR_ACTION_END_CONFIRMATION, 0) == 1,
+              "timeout did not end the confirmation");
+  bout.expectState(AR_EGPA, "after the timeout");
+  bout.expect(bout.match.scoreLeft == 0 && bout.match.scoreRight == 0,
+              "timeout scored");
+  bout.expect(bout.runUntil(AR_ARMED, 5000), "not armed after EGPA");
+  bout.expect(!bout.fsm(UI_INPUT_START_TIMER), "sabre timer started");
+  return bout.ok();
+}
+
+static bool TimerZeroContexts() {
+  struct {
+    const char *name;
+    TimerState_t state;
+    bool last, equal;
+    uint32_t fsm; // 0: no FSM command
+    AutoRefState_t next;
+  } cases[] = {
+      {"round_end", FIGHTING, false, false, UI_INPUT_START_TIMER, AR_ARMED},
+      {"last_round_tied", FIGHTING, true, true, UI_INPUT_PRIO, AR_PERIOD_END},
+      {"last_round_decided", FIGHTING, true, false, 0, AR_MATCH_OVER},
+      {"break_end", BREAK, false, false, 0, AR_PERIOD_END},
+      {"overtime_end", ADDITIONAL_MINUTE, true, false, 0, AR_MATCH_OVER},
+  };
+  bool ok = true;
+  for (const auto &c : cases) {
+    Bout bout(std::string("timer_zero/") + c.name, EPEE, 3);
+    Enable(bout);
+    bout.mark();
+    bout.send(TimerZero(c.state, c.last, c.equal));
+    bout.expect(bout.count(AR_ACTION_ANIMATION, EVENT_WS2812_WARNING | 3) == 1,
+                "no warning");
+    bout.expect(c.fsm ? bout.fsm(c.fsm)
+                      : bout.count(AR_ACTION_FSM,
+                                   EVENT_UI_INPUT | UI_INPUT_START_TIMER) == 0,
+                "FSM command");
+    bout.expectState(c.next, "after timer zero");
+    if (c.next == AR_PERIOD_END) {
+      bout.mark();
+      bout.expect(bout.runUntil(AR_ARMED, AUTOREF_PERIOD_END_DELAY_MS + 100),
+                  "period end did not arm");
+      bout.expect(bout.fsm(UI_INPUT_START_TIMER), "next period not started");
+    }
+    ok &= bout.ok();
+  }
+  return ok;
+}
+
+static bool UW2F() {
+  Bout bout("uw2f", FOIL, 3);
+  Enable(bout);
+  bout.mark();
+  bout.send(UW2F_60S);
+  bout.expect(bout.fsm(UI_INPUT_STOP_TIMER), "timer not stopped");
+  bout.expectState(AR_UW2F_PCARD_WAIT, "after 60 s");
+  bout.run(AUTOREF_UW2F_PCARD_DELAY_MS - 100);
+  bout.expect(bout.pCards == 0, "P-card too early");
+  bout.run(200);
+  bout.expect(bout.pCards == 1, "no P-card");
+  bout.expectState(AR_UW2F_RESUME_WAIT, "after the P-card");
+  bout.expect(bout.runUntil(AR_ARMED, AUTOREF_UW2F_RESUME_DELAY_MS +
+                                          AUTOREF_PERIOD_END_DELAY_MS + 100),
+              "not armed after UW2F");
+  bout.expect(bout.fsm(UI_INPUT_START_TIMER), "timer not restarted");
+  return bout.ok();
+}
+
+static bool HitDuringBreak() {
+  Bout bout("hit_in_break", EPEE, 3);
+  Enable(bout);
+  bout.match.timerState = BREAK;
+  bout.mark();
+  Lights(bout, {MASK_GREEN});
+  bout.expect(bout.match.scoreRight == 1, "hit not scored");
+  bout.expect(bout.runUntil(AR_ARMED, AUTOREF_POST_AWARD_DELAY_MS + 100),
+              "not armed");
+  bout.expect(!bout.animation(EVENT_WS2812_ENGARDE_PRETS_ALLEZ),
+              "EGPA in the break");
+  return bout.ok();
+}
+
+static bool BlackCardAndReset() {
+  Bout bout("black_card_reset", FOIL, 1);
+  Enable(bout);
+  bout.send(AUTOREF_BLACK_CARD);
+  bout.expectState(AR_MATCH_OVER, "black card");
+  bout.mark();
+  Lights(bout, {MASK_RED});
+  bout.send(UW2F_60S);
+  bout.run(10000);
+  bout.expect(bout.actions().empty(), "actions after the match");
+  bout.send(DOUBLE_LONG_PRESS);
+  bout.expect(bout.fsm(UI_INPUT_RESET), "no reset");
+  bout.expectState(AR_PERIOD_END, "after reset");
+  bout.expect(bout.runUntil(AR_ARMED, AUTOREF_PERIOD_END_DELAY_MS + 100),
+              "not armed after reset");
+  return bout.ok();
+}
+
+// Random bouts
+
+class Random {
+public:
+  explicit Random(uint32_t seed) : m_State(seed * 2654435761u + 1) {}
+  uint32_t next() {
+    m_State ^= m_State << 13;
+    m_State ^= m_State >> 17;
+    m_State ^= m_State << 5;
+    return m_State;
+  }
+  uint32_t below(uint32_t n) { return next() % n; }
+  bool chance(uint32_t percent) { return below(100) < percent; }
+
+private:
+  uint32_t m_State;
+};
+
+enum Phrase {
+  SINGLE_L,
+  SINGLE_R,
+  DOUBLE,
+  OFF_TARGET, // foil
+  MIXED_L,    // foil: left valid, right off-target
+  MIXED_R,    // foil: right valid, left off-target
+  WHITE_ONLY, // sabre: whites mean nothing
+};
+
+static Phrase DrawPhrase(Random &rnd, weapon_t weapon) {
+  static const Phrase foil[] = {SINGLE_L, SINGLE_R, DOUBLE, OFF_TARGET,
+                                MIXED_L,  MIXED_R};
+  static const Phrase epee[] = {SINGLE_L, SINGLE_R, DOUBLE};
+  static const Phrase sabre[] = {SINGLE_L, SINGLE_R, DOUBLE, WHITE_ONLY};
+  switch (weapon) {
+  case FOIL:
+    return foil[rnd.below(6)];
+  case EPEE:
+    return epee[rnd.below(3)];
+  default:
+    return sabre[rnd.below(4)];
+  }
+}
+
+static std::vector<uint32_t> PhraseLights(Random &rnd, Phrase phrase) {
+  std::vector<uint32_t> lights;
+  switch (phrase) {
+  case SINGLE_L:
+    lights = {MASK_RED};
+    if (rnd.chance(20))
+      lights.push_back(MASK_WHITE_L);
+    break;
+  case SINGLE_R:
+    lights = {MASK_GREEN};
+    if (rnd.chance(20))
+      lights.push_back(MASK_WHITE_R);
+    break;
+  case DOUBLE:
+    lights = {MASK_RED, MASK_GREEN};
+    break;
+  case OFF_TARGET:
+    lights = {rnd.chance(50) ? MASK_WHITE_L : MASK_WHITE_R};
+    if (rnd.chance(30))
+      lights.push_back(lights[0] == MASK_WHITE_L ? MASK_WHITE_R
+                                                 : MASK_WHITE_L);
+    break;
+  case MIXED_L:
+    lights = {MASK_RED, MASK_WHITE_R};
+    break;
+  case MIXED_R:
+    lights = {MASK_GREEN, MASK_WHITE_L};
+    break;
+  case WHITE_ONLY:
+    lights = {MASK_WHITE_L, MASK_WHITE_R};
+    break;
+  }
+  if (lights.size() == 2 && rnd.chance(50))
+    std::swap(lights[0], lights[1]);
+  return lights;
+}
+
+static int MaxScore(const AutoRefMatchInfo &match) {
+  return match.nrOfRounds * 5;
+}
+
+static bool MatchOver(int left, int right, int max) {
+  return (left >= max || right >= max) && left != right;
+}
+
+struct BoutStats {
+  unsigned phrases = 0;
+  unsigned confirmations = 0;
+  unsigned undos = 0;
+  unsigned uw2f = 0;
+};
+
+// One phrase from ARMED: the lights, the decision, what follows it, back to
+// ARMED or MATCH_OVER. left/right is the tally the score must match.
+static void RunPhrase(Bout &bout, Random &rnd, int &left, int &right,
+                      BoutStats &stats) {
+  weapon_t weapon = bout.match.weapon;
+  Phrase phrase = DrawPhrase(rnd, weapon);
+  std::vector<uint32_t> lights = PhraseLights(rnd, phrase);
+  uint32_t peak = 0;
+  for (uint32_t light : lights)
+    peak |= light;
+
+  bout.mark();
+  uint32_t on = 0;
+  for (uint32_t light : lights) {
+    on |= light;
+    bout.send(EVENT_LIGHTS | on);
+    bout.run(rnd.below(40));
+  }
+  bout.expectState(AR_WAITING_FOR_LIGHTS_OFF, "lights on");
+  bout.run(100 + rnd.below(1500));
+  bout.send(EVENT_LIGHTS);
+
+  int max = MaxScore(bout.match);
+  int awardL = 0, awardR = 0;
+  bool confirm = (weapon == FOIL && (phrase == DOUBLE || phrase == MIXED_L ||
+                                     phrase == MIXED_R)) ||
+                 (weapon == SABRE && phrase == DOUBLE);
+  bool timedOut = false;
+  if (phrase == WHITE_ONLY) {
+    bout.expectState(AR_ARMED, "sabre whites");
+    bout.expect(bout.actions().empty(), "sabre whites: actions");
+    return;
+  }
+  if (confirm) {
+    stats.confirmations++;
+    bout.expectState(AR_AWAITING_CONFIRMATION, "double/mixed");
+    bout.expect(bout.animation(EVENT_WS2812_CONFIRMATION_WAIT),
+                "no confirmation animation");
+    bout.expect(!bout.fsm(UI_INPUT_INCR_SCORE_LEFT) &&
+                    !bout.fsm(UI_INPUT_INCR_SCORE_RIGHT),
+                "scored before the confirmation");
+    bout.run(rnd.below(3000));
+    uint32_t draw = rnd.below(10);
+    if (draw < 2) {
+      timedOut = true;
+      bout.mark();
+      bout.expect(bout.runUntil(AR_EGPA, AUTOREF_CONFIRMATION_TIMEOUT_MS),
+                  "confirmation never timed out");
+      bout.expect(bout.count(AR_ACTION_END_CONFIRMATION, 0) == 1,
+                  "timeout without END_CONFIRMATION");
+    } else {
+      bool byLeft = draw < 6;
+      uint32_t light = byLeft ? (rnd.chance(70) ? MASK_RED : MASK_WHITE_L)
+                              : (rnd.chance(70) ? MASK_GREEN : MASK_WHITE_R);
+      bout.send(EVENT_LIGHTS | light);
+      bout.run(100 + rnd.below(300));
+      bout.send(EVENT_LIGHTS);
+      if (byLeft)
+        awardL = (peak & MASK_RED) ? 1 : 0;
+      else
+        awardR = (peak & MASK_GREEN) ? 1 : 0;
+      bout.expectState(AR_AWARDING, "after the confirmation");
+    }
+  } else if (phrase == DOUBLE) { // epee
+    bool matchPoint = left >= max - 1 && right >= max - 1;
+    if (!matchPoint)
+      awardL = awardR = 1;
+    bout.expectState(AR_AWARDING, "epee double");
+  } else if (phrase == SINGLE_L || phrase == SINGLE_R) {
+    awardL = phrase == SINGLE_L;
+    awardR = phrase == SINGLE_R;
+    bout.expectState(AR_AWARDING, "single");
+  } else { // foil off-target
+    bout.expectState(AR_AWARDING, "off-target");
+  }
+
+  left += awardL;
+  right += awardR;
+  bool scored = awardL || awardR;
+  if (bout.match.scoreLeft != (unsigned)left ||
+      bout.match.scoreRight != (unsigned)right)
+    bout.fail("score %d-%d, expected %d-%d", bout.match.scoreLeft,
+              bout.match.scoreRight, left, right);
+
+  // the referee takes a point back with a double tap
+  if (scored && !timedOut && rnd.chance(10)) {
+    stats.undos++;
+    bool undoL = awardL && (!awardR || rnd.chance(50));
+    bout.run(rnd.below(AUTOREF_POST_AWARD_DELAY_MS - 1500));
+    bout.mark();
+    bout.send(EVENT_DOUBLEHIT |
+              (undoL ? DOUBLEHIT_VALID_LEFT : DOUBLEHIT_VALID_RIGHT));
+    bout.expect(bout.fsm(undoL ? UI_INPUT_DECR_SCORE_LEFT
+                               : UI_INPUT_DECR_SCORE_RIGHT),
+                "undo did not take the point back");
+    bout.expect(bout.count(AR_ACTION_UNDO_LIGHTS,
+                           undoL ? MASK_RED | MASK_WHITE_L
+                                 : MASK_GREEN | MASK_WHITE_R) == 1,
+                "undo did not clear the lights");
+    (undoL ? left : right)--;
+  }
+
+  bout.mark();
+  if (!timedOut && scored && MatchOver(left, right, max)) {
+    bout.expect(bout.runUntil(AR_MATCH_OVER, AUTOREF_POST_AWARD_DELAY_MS),
+                "match not over");
+    bout.expect(!bout.animation(EVENT_WS2812_ENGARDE_PRETS_ALLEZ),
+                "EGPA after the last point");
+    return;
+  }
+  bout.expect(bout.runUntil(AR_ARMED, AUTOREF_POST_AWARD_DELAY_MS +
+                                          AUTOREF_EGPA_DURATION_MS + 200),
+              "not armed again");
+  bout.expect(timedOut || bout.animation(EVENT_WS2812_ENGARDE_PRETS_ALLEZ),
+              "no EGPA");
+  bout.expect(weapon == SABRE ? !bout.fsm(UI_INPUT_START_TIMER)
+                              : bout.fsm(UI_INPUT_START_TIMER),
+              "timer start after EGPA");
+}
+
+static uint64_t RunRandomBout(uint32_t seed, BoutStats &stats, bool &ok) {
+  Random rnd(seed);
+  static const weapon_t weapons[] = {FOIL, EPEE, SABRE};
+  weapon_t weapon = weapons[rnd.below(3)];
+  int rounds = rnd.chance(70) ? 1 : 3;
+  char name[48];
+  snprintf(name, sizeof(name), "bout %u (weapon %d, to %d)", seed, weapon,
+           rounds * 5);
+  Bout bout(name, weapon, rounds);
+  Enable(bout);
+
+  int left = 0, right = 0;
+  for (int i = 0; i < 400 && bout.ok(); i++) {
+    if (bout.core.state() == AR_MATCH_OVER)
+      break;
+    bout.run(200 + rnd.below(3000));
+    if (rnd.chance(3)) {
+      stats.uw2f++;
+      int pCards = bout.pCards;
+      bout.mark();
+      bout.send(UW2F_60S);
+      bout.expect(bout.fsm(UI_INPUT_STOP_TIMER), "UW2F did not stop");
+      bout.expect(bout.runUntil(AR_ARMED, 12000), "UW2F: not armed");
+      bout.expect(bout.pCards == pCards + 1, "UW2F: no P-card");
+      continue;
+    }
+    stats.phrases++;
+    RunPhrase(bout, rnd, left, right, stats);
+  }
+  bout.expectState(AR_MATCH_OVER, "end of the bout");
+  bout.expect(MatchOver(bout.match.scoreLeft, bout.match.scoreRight,
+                        MaxScore(bout.match)),
+              "match over at a score that does not end it");
+
+  // Nothing moves after the match until the reset
+  bout.mark();
+  bout.send(EVENT_LIGHTS | MASK_RED);
+  bout.send(EVENT_LIGHTS);
+  bout.run(AUTOREF_CONFIRMATION_TIMEOUT_MS);
+  bout.expect(bout.actions().empty(), "actions after the match");
+  bout.send(DOUBLE_LONG_PRESS);
+  bout.expect(bout.fsm(UI_INPUT_RESET), "no reset");
+  bout.expect(bout.runUntil(AR_ARMED, AUTOREF_PERIOD_END_DELAY_MS + 100),
+              "not armed after the reset");
+  bout.expect(bout.match.scoreLeft == 0 && bout.match.scoreRight == 0,
+              "scores after the reset");
+  ok = bout.ok();
+  return bout.trace();
+}
+
+int main(int argc, char **argv) {
+  unsigned bouts = 300;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--bouts") && i + 1 < argc)
+      bouts = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+      seed = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "-v"))
+      s_Verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--bouts N] [--seed N] [-v]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  static bool (*const cases[])() = {DisabledIgnoresAll, ConfirmationTimeout,
+                                    TimerZeroContexts,  UW2F,
+                                    HitDuringBreak,     BlackCardAndReset};
+  int failed = 0, total = 0;
+  for (auto run : cases) {
+    total++;
+    failed += !run();
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+
+  BoutStats stats;
+  unsigned boutsFailed = 0;
+  for (unsigned b = 0; b < bouts; b++) {
+    bool ok, again;
+    BoutStats ignored;
+    uint64_t trace = RunRandomBout(seed + b, stats, ok);
+    if (ok && RunRandomBout(seed + b, ignored, again) != trace) {
+      printf("  bout %u: second run gave a different trace\n", seed + b);
+      ok = false;
+    }
+    boutsFailed += !ok;
+  }
+  printf("%u of %u random bouts passed (seeds %u..%u): %u phrases, %u "
+         "confirmations, %u undos, %u UW2F\n",
+         bouts - boutsFailed, bouts, seed, seed + bouts - 1, stats.phrases,
+         stats.confirmations, stats.undos, stats.uw2f);
+  return failed || boutsFailed ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Checks and benchmarks CyranoWireCache, the INFO/NEXT/PREV strings
+// CyranoHandler sends.
+//
+//   cyrano_wire        run all cases, print rebuild vs patch timing
+//
+// Every case pushes a sequence of status updates into the cache, as
+// Opp2Handler does, and after each one compares the cached INFO string with
+// a fresh ToBuffer() of the same status, byte for byte, and NEXT/PREV with
+// MakeNext/PrevMessageString(). Each step also states whether the cache
+// should patch in place or rebuild, so a length change that is patched
+// instead of rebuilt fails even when the bytes happen to match.
+#include "CyranoWireCache.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const char *kCompetition = "CHAMP";
+
+struct Step {
+  const char *what;
+  int field; // -1: setCompetitionId(value)
+  const char *value;
+  bool patched; // expected return of update()
+};
+
+struct WireCase {
+  const char *name;
+  std::vector<Step> steps;
+};
+
+static const WireCase WireCases[] = {
+    {"clock_ticks",
+     {{"3:00 -> 2:59", StopWatch, "2:59", true},
+      {"2:59 -> 2:58", StopWatch, "2:58", true},
+      {"2:58 -> 0:59", StopWatch, "0:59", true}}},
+    {"lights",
+     {{"red on", LeftLight, "1", true},
+      {"green on", RightLight, "1", true},
+      {"white left", LeftWhiteLight, "1", true},
+      {"all off", LeftLight, "0", true},
+      {"green off", RightLight, "0", true}}},
+    {"scores",
+     {{"left 3 -> 4", LeftScore, "4", true},
+      {"right 9 -> 10", RightScore, "10", false},
+      {"right 10 -> 11", RightScore, "11", true},
+      {"right 11 -> 9", RightScore, "9", false}}},
+    {"length_changes",
+     {{"clock 3:00 -> 10:00", StopWatch, "10:00", false},
+      {"clock 10:00 -> 9:59", StopWatch, "9:59", false},
+      {"yellow card set", RightYCard, "1", false},
+      {"fencer renamed", LeftFencerName, "DUPONT Jean-Pierre", false},
+      {"state F -> H", State, "H", true}}},
+    {"header_changes",
+     {{"piste id", PisteId, "RED", false},
+      {"competition id", -1, "EURO26", false},
+      {"clock after header", StopWatch, "2:59", true},
+      {"same status again", StopWatch, "2:59", true}}},
+};
+
+static EFP1Message StartStatus() {
+  EFP1Message status;
+  status[Protocol] = "EFP1.1";
+  status[Command] = "DISP";
+  status[PisteId] = "BLUE";
+  status[CompetitionId] = "ignored";
+  status[PhaseNumber] = "1";
+  status[MatchNumber] = "12";
+  status[StopWatch] = "3:00";
+  status[Weapon] = "F";
+  status[State] = "F";
+  status[RightFencerId] = "221";
+  status[RightFencerName] = "SMITH Anna";
+  status[RightFencerNation] = "GBR";
+  status[RightScore] = "9";
+  status[RightLight] = "0";
+  status[RightWhiteLight] = "0";
+  status[LeftFencerId] = "101";
+  status[LeftFencerName] = "DUPONT Jean";
+  status[LeftFencerNation] = "FRA";
+  status[LeftScore] = "3";
+  status[LeftLight] = "0";
+  status[LeftWhiteLight] = "0";
+  return status;
+}
+
+// What CyranoHandler used to do on every update: serialize everything
+static void FullBuild(const EFP1Message &status, const std::string &competition,
+                      std::string &info, std::string &next,
+                      std::string &prev) {
+  EFP1Message msg = status;
+  msg[Command] = "INFO";
+  msg[CompetitionId] = competition;
+  msg.ToString(info);
+  next = msg.MakeNextMessageString();
+  prev = msg.MakePrevMessageString();
+}
+
+static bool RunWireCase(const WireCase &c) {
+  CyranoWireCache cache;
+  std::string competition = kCompetition;
+  cache.setCompetitionId(competition);
+  EFP1Message status = StartStatus();
+  bool ok = !cache.update(status) && cache.valid();
+  if (!ok)
+    printf("  %s: first update did not build the strings\n", c.name);
+  for (const Step &step : c.steps) {
+    bool patched;
+    if (step.field < 0) {
+      competition = step.value;
+      cache.setCompetitionId(competition);
+      patched = false;
+    } else {
+      status[step.field] = step.value;
+      patched = cache.update(status);
+    }
+    std::string info, next, prev;
+    FullBuild(status, competition, info, next, prev);
+    if (patched != step.patched) {
+      printf("  %s/%s: %s, expected %s\n", c.name, step.what,
+             patched ? "patched" : "rebuilt",
+             step.patched ? "patch" : "rebuild");
+      ok = false;
+    }
+    if (cache.info() != info) {
+      printf("  %s/%s: INFO differs\n    got  %s\n    want %s\n", c.name,
+             step.what, cache.info().c_str(), info.c_str());
+      ok = false;
+    }
+    if (cache.next() != next || cache.prev() != prev) {
+      printf("  %s/%s: NEXT/PREV differ: %s %s, want %s %s\n", c.name,
+             step.what, cache.next().c_str(), cache.prev().c_str(),
+             next.c_str(), prev.c_str());
+      ok = false;
+    }
+  }
+  printf("%-16s %s\n", c.name, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// A bout's worth of updates: a clock tick each second, a light or score
+// change every few seconds, scores into double figures.
+static std::vector<EFP1Message> BoutUpdates() {
+  std::vector<EFP1Message> updates;
+  EFP1Message status = StartStatus();
+  int left = 0, right = 0;
+  char text[16];
+  for (int round = 0; round < 3; round++) {
+    for (int s = 180; s >= 0; s--) {
+      snprintf(text, sizeof(text), "%d:%02d", s / 60, s % 60);
+      status[StopWatch] = text;
+      updates.push_back(status);
+      if (s % 7 == 0) {
+        status.SetRed(true);
+        updates.push_back(status);
+        snprintf(text, sizeof(text), "%d", ++left);
+        status[LeftScore] = text;
+        status.SetRed(false);
+        updates.push_back(status);
+      } else if (s % 11 == 0) {
+        status.SetGreen(true);
+        updates.push_back(status);
+        snprintf(text, sizeof(text), "%d", ++right);
+        status[RightScore] = text;
+        status.SetGreen(false);
+        updates.push_back(status);
+      }
+    }
+  }
+  return updates;
+}
+
+static void Benchmark() {
+  std::vector<EFP1Message> updates = BoutUpdates();
+  const int repeats = 200;
+  std::string info, next, prev;
+  size_t bytes = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    for (const EFP1Message &status : updates) {
+      FullBuild(status, kCompetition, info, next, prev);
+      bytes += info.size();
+    }
+  }
+  double full = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+  CyranoWireCache cache;
+  cache.setCompetitionId(kCompetition);
+  unsigned patched = 0;
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    for (const EFP1Message &status : updates) {
+      patched += cache.update(status);
+      bytes += cache.info().size();
+    }
+  }
+  double cached = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  double n = (double)updates.size() * repeats;
+  printf("%zu updates per bout, %.1f%% patched (%zu bytes checksum)\n",
+         updates.size(), 100.0 * patched / n, bytes);
+  printf("full rebuild: %.0f ns/update\n", full * 1e9 / n);
+  printf("wire cache:   %.0f ns/update (%.1fx)\n", cached * 1e9 / n,
+         full / cached);
+}
+
+int main() {
+  int failed = 0, total = 0;
+  for (const WireCase &c : WireCases) {
+    total++;
+    failed += !RunWireCase(c);
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+  Benchmark();
+  return failed ? 1 : 0;
+}
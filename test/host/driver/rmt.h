@@ -0,0 +1,54 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for the part of ESP-IDF's legacy RMT driver NeoPixelRMT
+// uses. Nothing is sent: the test program that links it defines
+// rmt_write_items() and so sees every frame show() hands to the driver.
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum { GPIO_NUM_NC = -1 } gpio_num_t;
+typedef enum { RMT_CHANNEL_0 } rmt_channel_t;
+typedef enum { RMT_MODE_TX } rmt_mode_t;
+typedef enum { RMT_IDLE_LEVEL_LOW, RMT_IDLE_LEVEL_HIGH } rmt_idle_level_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t duration0 : 15;
+      uint32_t level0 : 1;
+      uint32_t duration1 : 15;
+      uint32_t level1 : 1;
+    };
+    uint32_t val;
+  };
+} rmt_item32_t;
+
+typedef struct {
+  bool loop_en;
+  bool carrier_en;
+  bool idle_output_en;
+  rmt_idle_level_t idle_level;
+} rmt_tx_config_t;
+
+typedef struct {
+  rmt_mode_t rmt_mode;
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  uint8_t mem_block_num;
+  rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+inline esp_err_t rmt_config(const rmt_config_t *) { return ESP_OK; }
+inline esp_err_t rmt_driver_install(rmt_channel_t, size_t, int) {
+  return ESP_OK;
+}
+inline esp_err_t rmt_driver_uninstall(rmt_channel_t) { return ESP_OK; }
+// Frames are "sent" inside rmt_write_items(), so there is never one to wait for
+inline esp_err_t rmt_wait_tx_done(rmt_channel_t, TickType_t) { return ESP_OK; }
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *items,
+                          int item_num, bool wait_tx_done);
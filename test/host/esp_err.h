@@ -0,0 +1,22 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_err.h: a failed ESP_ERROR_CHECK aborts,
+// as it does on the board
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define ESP_ERROR_CHECK(x)                                                     \
+  do {                                                                         \
+    esp_err_t err_rc_ = (x);                                                   \
+    if (err_rc_ != ESP_OK) {                                                   \
+      printf("ESP_ERROR_CHECK failed: %d at %s:%d\n", err_rc_, __FILE__,      \
+             __LINE__);                                                        \
+      abort();                                                                 \
+    }                                                                          \
+  } while (0)
@@ -0,0 +1,12 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for ESP-IDF's heap_caps: one heap, capabilities ignored
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+inline void *heap_caps_calloc(size_t n, size_t size, uint32_t) {
+  return calloc(n, size);
+}
@@ -0,0 +1,12 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_now.h, so headers that hold ESP-NOW state
+// (RepeaterSender.h) compile. Nothing is sent on the host.
+#include <stdint.h>
+
+typedef struct {
+  uint8_t peer_addr[6];
+  uint8_t channel;
+  bool encrypt;
+} esp_now_peer_info_t;
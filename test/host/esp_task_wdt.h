@@ -0,0 +1,8 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for ESP-IDF's task watchdog: nothing to feed
+#include "Arduino.h"
+
+inline int esp_task_wdt_add(TaskHandle_t) { return 0; }
+inline int esp_task_wdt_reset() { return 0; }
@@ -0,0 +1,9 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_timer.h, for firmware units that only read
+// the clock. The test program that links them defines esp_timer_get_time(),
+// usually as a virtual clock it advances itself.
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
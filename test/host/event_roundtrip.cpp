@@ -0,0 +1,305 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Round-trip checks of Event and the repeater decisions built on it.
+//
+//   event_roundtrip    run all cases
+//
+// Every named constructor is checked against the word packed by hand, over
+// its whole range, and every accessor must give back what went in. The
+// mirror cases check Event::mirrored() and RepeaterMirrored() against the
+// receiver's old code: they must agree wherever the old code was right, and
+// differ exactly where it had the `||` bug. The resend case does the same
+// for RepeaterResends() and the sender's old `&&` tests.
+#include "Event.h"
+#include "RepeaterDefs.h"
+#include <cstdio>
+
+static const uint32_t CardTypes[] = {
+    EVENT_YELLOW_CARD_LEFT, EVENT_YELLOW_CARD_RIGHT, EVENT_RED_CARD_LEFT,
+    EVENT_RED_CARD_RIGHT,   EVENT_BLACK_CARD_LEFT,   EVENT_BLACK_CARD_RIGHT};
+
+static const uint32_t LightBits[] = {
+    MASK_REVERSE_COLORS, MASK_BUZZ,     MASK_GREEN,    MASK_WHITE_R,
+    MASK_ORANGE_R,       MASK_ORANGE_L, MASK_WHITE_L,  MASK_RED,
+    MASK_PARRY,          MASK_POWER_PROBLEM};
+
+static const uint32_t SideBits = MASK_RED | MASK_GREEN | MASK_WHITE_L |
+                                 MASK_WHITE_R | MASK_ORANGE_L | MASK_ORANGE_R;
+
+static int s_Reported;
+
+static bool Check(bool ok, const char *what, uint32_t word) {
+  if (!ok && s_Reported++ < 10)
+    printf("  %s: 0x%08x\n", what, word);
+  return ok;
+}
+
+// The receiver's mirrored lights before Event::mirrored()
+static uint32_t LegacySwapLights(uint32_t event) {
+  uint32_t result = EVENT_LIGHTS || MASK_REVERSE_COLORS;
+  if (event & MASK_RED)
+    result |= MASK_GREEN;
+  if (event & MASK_GREEN)
+    result |= MASK_RED;
+  if (event & MASK_WHITE_L)
+    result |= MASK_WHITE_R;
+  if (event & MASK_WHITE_R)
+    result |= MASK_WHITE_L;
+  if (event & MASK_ORANGE_L)
+    result |= MASK_ORANGE_R;
+  if (event & MASK_ORANGE_R)
+    result |= MASK_ORANGE_L;
+  return result;
+}
+
+// The receiver's mirroring switch before RepeaterMirrored()
+static uint32_t LegacyMirror(uint32_t event) {
+  uint32_t data = event & SUB_TYPE_MASK;
+  switch (event & MAIN_TYPE_MASK) {
+  case EVENT_LIGHTS: return LegacySwapLights(event);
+  case EVENT_SCORE_LEFT: return EVENT_SCORE_RIGHT | data;
+  case EVENT_SCORE_RIGHT: return EVENT_SCORE_LEFT | data;
+  case EVENT_PRIO:
+    if (data == 1)
+      data = 2;
+    else if (data == 2)
+      data = 1;
+    return EVENT_PRIO | data;
+  case EVENT_YELLOW_CARD_LEFT: return EVENT_YELLOW_CARD_RIGHT | data;
+  case EVENT_YELLOW_CARD_RIGHT: return EVENT_YELLOW_CARD_LEFT | data;
+  case EVENT_RED_CARD_LEFT: return EVENT_RED_CARD_RIGHT | data;
+  case EVENT_RED_CARD_RIGHT: return EVENT_RED_CARD_LEFT | data;
+  case EVENT_P_CARD:
+    return EVENT_P_CARD | (data & 0xff0000) | (data & 0xff) << 8 |
+           (data >> 8 & 0xff);
+  default: return event;
+  }
+}
+
+// The sender's resend count before RepeaterResends(), -1 for "keep"
+static int LegacyResends(uint32_t eventtype) {
+  if (eventtype && MAIN_TYPE_MASK == EVENT_TIMER) {
+    return (eventtype && DATA_BYTE0_MASK) ? 0 : -1;
+  }
+  if (eventtype && MAIN_TYPE_MASK == EVENT_LIGHTS)
+    return 7;
+  return MESSAGE_REPETITION_FACTOR;
+}
+
+static bool TimerRoundTrip() {
+  bool ok = true;
+  for (uint32_t m = 0; m < 256; m++)
+    for (uint32_t s = 0; s < 256; s++)
+      for (uint32_t h = 0; h < 256; h++) {
+        Event e = Event::Timer(m, s, h);
+        uint32_t want = EVENT_TIMER | m << 16 | s << 8 | h;
+        ok &= Check(e.word() == want && (uint32_t)e == want &&
+                        e.is(EVENT_TIMER) && e.data() == (want & 0xffffff) &&
+                        e.minutes() == m && e.seconds() == s &&
+                        e.hundredths() == h,
+                    "timer", want);
+      }
+  for (uint32_t sec = 0; sec < 100 * 60; sec++) {
+    Event e = Event::UW2FTimer(sec);
+    uint32_t want = EVENT_UW2F_TIMER | (sec / 60) << 16 | (sec % 60) << 8;
+    ok &= Check(e == want && e.is(EVENT_UW2F_TIMER) &&
+                    e.minutes() * 60 + e.seconds() == sec &&
+                    e.hundredths() == 0,
+                "UW2F timer", want);
+  }
+  // bytes above the field are dropped, not carried into the next one
+  ok &= Check(Event::Timer(0x101, 0x102, 0x103) == Event::Timer(1, 2, 3),
+              "timer overflow", Event::Timer(0x101, 0x102, 0x103));
+  return ok;
+}
+
+static bool ScoresAndCards() {
+  bool ok = true;
+  for (uint32_t n = 0; n < 1000; n++) {
+    Event l = Event::ScoreLeft(n), r = Event::ScoreRight(n);
+    ok &= Check(l == (EVENT_SCORE_LEFT | n) && l.is(EVENT_SCORE_LEFT) &&
+                    l.score() == n,
+                "score left", l);
+    ok &= Check(r == (EVENT_SCORE_RIGHT | n) && r.is(EVENT_SCORE_RIGHT) &&
+                    r.score() == n,
+                "score right", r);
+  }
+  for (uint32_t type : CardTypes)
+    for (uint32_t n = 0; n < 256; n++) {
+      // the card type may come with data of its own, it is dropped
+      Event c = Event::Card(type | 0x55, n);
+      ok &= Check(c == (type | n) && c.is(type) && c.type() == type &&
+                      c.count() == n,
+                  "card", c);
+    }
+  return ok;
+}
+
+static bool PCardsAndRounds() {
+  bool ok = true;
+  for (uint32_t a = 0; a < 256; a++)
+    for (uint32_t b = 0; b < 256; b++) {
+      Event p = Event::PCards(a, b);
+      ok &= Check(p == (EVENT_P_CARD | b << 8 | a) && p.is(EVENT_P_CARD) &&
+                      p.pCardLeft() == a && p.pCardRight() == b,
+                  "P-cards", p);
+      Event swapped(RepeaterMirrored(p));
+      ok &= Check(swapped == Event::PCards(b, a) &&
+                      swapped == LegacyMirror(p) &&
+                      RepeaterMirrored(swapped) == p,
+                  "P-card swap", p);
+      Event r = Event::Round(a, b);
+      ok &= Check(r == (EVENT_ROUND | b << 8 | a) && r.is(EVENT_ROUND) &&
+                      r.round() == a && r.rounds() == b &&
+                      RepeaterMirrored(r) == r,
+                  "round", r);
+    }
+  return ok;
+}
+
+static bool LightsMirror() {
+  bool ok = true;
+  int legacyWrong = 0;
+  for (uint32_t mask = 0; mask < 0x2000; mask++) {
+    Event e = Event::Lights(mask);
+    ok &= Check(e == mask && e.is(EVENT_LIGHTS), "lights", mask);
+    for (uint32_t bit : LightBits)
+      ok &= Check(e.has(bit) == ((mask & bit) != 0), "has()", mask);
+
+    Event m = e.mirrored();
+    ok &= Check(m == RepeaterMirrored(e) && m.is(EVENT_LIGHTS) &&
+                    m.has(MASK_REVERSE_COLORS),
+                "mirrored type", mask);
+    ok &= Check(m.has(MASK_RED) == e.has(MASK_GREEN) &&
+                    m.has(MASK_GREEN) == e.has(MASK_RED) &&
+                    m.has(MASK_WHITE_L) == e.has(MASK_WHITE_R) &&
+                    m.has(MASK_WHITE_R) == e.has(MASK_WHITE_L) &&
+                    m.has(MASK_ORANGE_L) == e.has(MASK_ORANGE_R) &&
+                    m.has(MASK_ORANGE_R) == e.has(MASK_ORANGE_L),
+                "mirrored sides", mask);
+    // buzzer, parry, power and anything else stays as it was
+    ok &= Check((m & ~(SideBits | MASK_REVERSE_COLORS)) ==
+                    (mask & ~(SideBits | MASK_REVERSE_COLORS)),
+                "mirrored kept bits", mask);
+    ok &= Check(m.mirrored() == (mask | MASK_REVERSE_COLORS),
+                "mirrored twice", mask);
+
+    // the old code agreed only on lights that were all side colours
+    bool sidesOnly = !(mask & ~(SideBits | MASK_REVERSE_COLORS));
+    bool same = LegacySwapLights(mask) == m;
+    ok &= Check(same == sidesOnly, "legacy swapLights", mask);
+    legacyWrong += !same;
+  }
+  // e.g. a buzzing red light lost its buzzer on a mirrored repeater
+  ok &= Check(LegacySwapLights(MASK_RED | MASK_BUZZ) == (MASK_GREEN | 1) &&
+                  RepeaterMirrored(MASK_RED | MASK_BUZZ) ==
+                      (MASK_GREEN | MASK_BUZZ | MASK_REVERSE_COLORS),
+              "buzzer mirrored", MASK_RED | MASK_BUZZ);
+  printf("  %d of %d light masks were mirrored wrong before\n", legacyWrong,
+         0x2000);
+  return ok;
+}
+
+static bool SidesMirror() {
+  bool ok = true;
+  static const uint32_t Pairs[][2] = {
+      {EVENT_SCORE_LEFT, EVENT_SCORE_RIGHT},
+      {EVENT_YELLOW_CARD_LEFT, EVENT_YELLOW_CARD_RIGHT},
+      {EVENT_RED_CARD_LEFT, EVENT_RED_CARD_RIGHT}};
+  for (const auto &pair : Pairs)
+    for (uint32_t n = 0; n < 1000; n++) {
+      uint32_t l = pair[0] | n, r = pair[1] | n;
+      ok &= Check(RepeaterMirrored(l) == r && RepeaterMirrored(r) == l &&
+                      LegacyMirror(l) == r && LegacyMirror(r) == l,
+                  "side swap", l);
+    }
+  for (uint32_t n = 0; n < 256; n++) {
+    uint32_t prio = EVENT_PRIO | n;
+    uint32_t want = n == 1 || n == 2 ? EVENT_PRIO | (3 - n) : prio;
+    ok &= Check(RepeaterMirrored(prio) == want &&
+                    RepeaterMirrored(want) == prio &&
+                    LegacyMirror(prio) == want,
+                "priority", prio);
+  }
+  // black cards, timers and the rest show the same from both sides
+  static const uint32_t Unchanged[] = {
+      EVENT_BLACK_CARD_LEFT | 1, EVENT_BLACK_CARD_RIGHT | 1,
+      Event::Timer(2, 59, 40), Event::UW2FTimer(61), Event::Round(2, 3)};
+  for (uint32_t event : Unchanged)
+    ok &= Check(RepeaterMirrored(event) == event &&
+                    LegacyMirror(event) == event,
+                "unchanged", event);
+  return ok;
+}
+
+static bool Resends() {
+  bool ok = true;
+  struct {
+    const char *what;
+    uint32_t event;
+    int resends; // -1: keep those due for an older change
+    bool legacyRight;
+  } cases[] = {
+      {"lights", Event::Lights(MASK_RED), LIGHTS_REPETITION_FACTOR, false},
+      {"lights off", Event::Lights(0), LIGHTS_REPETITION_FACTOR, false},
+      {"running 2:59.40", Event::Timer(2, 59, 40), -1, false},
+      {"whole 2:59", Event::Timer(2, 59, 0), MESSAGE_REPETITION_FACTOR, true},
+      {"score", Event::ScoreLeft(3), MESSAGE_REPETITION_FACTOR, true},
+      {"card", Event::Card(EVENT_RED_CARD_RIGHT, 1),
+       MESSAGE_REPETITION_FACTOR, true},
+      {"P-cards", Event::PCards(1, 0), MESSAGE_REPETITION_FACTOR, true},
+  };
+  for (const auto &c : cases) {
+    int got = RepeaterResends(c.event), legacy = LegacyResends(c.event);
+    if (got != c.resends || (legacy == c.resends) != c.legacyRight) {
+      printf("  %s: %d resends, want %d (old code %d)\n", c.what, got,
+             c.resends, legacy);
+      ok = false;
+    }
+  }
+
+  // A score change followed by running ticks: the ticks must not cancel the
+  // score's resends. The old code restarted the count on every tick, so
+  // they went on for as long as the clock ran.
+  int count = RepeaterResends(Event::ScoreLeft(4));
+  int legacy = LegacyResends(Event::ScoreLeft(4));
+  for (uint32_t h = 90; h > 0; h -= 10) {
+    int next = RepeaterResends(Event::Timer(2, 58, h));
+    if (next >= 0)
+      count = next;
+    if (count)
+      count--; // one resend between two ticks
+    next = LegacyResends(Event::Timer(2, 58, h));
+    if (next >= 0)
+      legacy = next;
+  }
+  ok &= Check(count == 0 && legacy == MESSAGE_REPETITION_FACTOR,
+              "resends across ticks", (uint32_t)count);
+  return ok;
+}
+
+struct RoundTripCase {
+  const char *name;
+  bool (*run)();
+};
+
+static const RoundTripCase RoundTripCases[] = {
+    {"timers", TimerRoundTrip},
+    {"scores_cards", ScoresAndCards},
+    {"pcards_rounds", PCardsAndRounds},
+    {"lights_mirror", LightsMirror},
+    {"sides_mirror", SidesMirror},
+    {"resends", Resends},
+};
+
+int main() {
+  int failed = 0, total = 0;
+  for (const RoundTripCase &c : RoundTripCases) {
+    total++;
+    s_Reported = 0;
+    bool ok = c.run();
+    printf("%-16s %s\n", c.name, ok ? "ok" : "FAILED");
+    failed += !ok;
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in for FreeRTOS mutexes. With one task a mutex is never
+// contended, so taking one that is already held would deadlock the firmware:
+// the stand-in reports it and aborts instead.
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct HostMutex {
+  bool held;
+};
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostMutex{false};
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete (HostMutex *)semaphore;
+}
+inline int xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t) {
+  HostMutex *mutex = (HostMutex *)semaphore;
+  if (mutex->held) {
+    printf("xSemaphoreTake: mutex already held by this task\n");
+    abort();
+  }
+  mutex->held = true;
+  return pdTRUE;
+}
+inline int xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  ((HostMutex *)semaphore)->held = false;
+  return pdTRUE;
+}
@@ -0,0 +1,498 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Replays InputJournal recordings through FencingStateMachine on the host.
+//
+//   fsm_replay                 record and replay all cases
+//   fsm_replay journal.bin     replay chunks collected from
+//                              diag/input_journal, print what it notified
+//
+// Every case records a scripted session with the journal on: remote and
+// Cyrano commands, EFP1 messages, lights and hits, and the setters OPP2/FPA
+// call. A second run then replays the serialized journal through
+// ReplayInput(). Each entry is applied at its own time_us, and the ticks
+// run in between as the state machine task runs them. The replay must
+// notify the same events at the same times and end in the same state. It
+// must also add nothing to the journal. The state machine is a singleton,
+// so each run gets a process of its own.
+//
+// Sessions start 20 s before the 32-bit µs time in the entries wraps, so
+// the replay also has to follow the times across the wrap.
+#include "FencingStateMachine.h"
+#include "FlashWriteGuard.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static int64_t s_Now;
+
+int64_t esp_timer_get_time() { return s_Now; }
+
+// The state machine links against these; nothing here sends to repeaters or
+// writes flash
+void RepeaterSender::RefreshSnapshot(uint32_t) {}
+void RepeaterSender::BroadcastSnapshot() {}
+FlashWriteGuard::FlashWriteGuard() {}
+FlashWriteGuard::~FlashWriteGuard() {}
+
+static constexpr int64_t SESSION_START_US = (1LL << 32) - 20000000;
+
+// The state machine task: a tick after every input (Wake()), and otherwise
+// at the deadline TicksUntilNextDeadline() asks for
+class StateMachineTask {
+public:
+  explicit StateMachineTask(int64_t now) : m_NextTick(now) { s_Now = now; }
+  void runUntil(int64_t until_us) {
+    FencingStateMachine &fsm = FencingStateMachine::getInstance();
+    while (m_NextTick <= until_us) {
+      s_Now = m_NextTick;
+      fsm.DoStateMachineTick();
+      m_NextTick = s_Now + (int64_t)fsm.TicksUntilNextDeadline() * 1000;
+    }
+    s_Now = until_us;
+  }
+  void wake() { m_NextTick = s_Now; }
+
+private:
+  int64_t m_NextTick;
+};
+
+// Every event the state machine notifies, with its time from the start
+class Tracer : public Observer<FencingStateMachine> {
+public:
+  explicit Tracer(int64_t start) : m_Start(start) {
+    FencingStateMachine::getInstance().attach(*this);
+  }
+  using Observer<FencingStateMachine>::update;
+  void update(FencingStateMachine *, uint32_t event) override {
+    char line[32];
+    snprintf(line, sizeof(line), "%10.3f %08x\n", (s_Now - m_Start) / 1e3,
+             event);
+    m_Text += line;
+  }
+  // What the state machine holds at the end
+  void finish() {
+    FencingStateMachine &fsm = FencingStateMachine::getInstance();
+    char clock[32], line[160];
+    fsm.GetFormattedStringTime(clock, 1, 1);
+    snprintf(line, sizeof(line),
+             "state: score %u-%u, prio %d, yellow %d/%d, red %d/%d, "
+             "clock %s, timer state %d, round %d of %d, weapon %d\n",
+             fsm.GetScoreLeft(), fsm.GetScoreRight(), fsm.GetPriority(),
+             fsm.GetYellowCardLeft(), fsm.GetYellowCardRight(),
+             fsm.GetRedCardLeft(), fsm.GetRedCardRight(), clock,
+             fsm.GetTimerstate(), fsm.GetCurrentRound(), fsm.GetNrOfRounds(),
+             fsm.GetMachineWeapon());
+    m_Text += line;
+  }
+  void add(const std::string &text) { m_Text += text; }
+  const std::string &text() const { return m_Text; }
+
+private:
+  int64_t m_Start;
+  std::string m_Text;
+};
+
+enum StepKind {
+  REMOTE,      // update(UDPIOHandler *), EVENT_UI_INPUT | value
+  CYRANO,      // update(CyranoHandler *, uint32_t)
+  CYRANO_TEXT, // update(CyranoHandler *, std::string)
+  LIGHTS,      // update(MultiWeaponSensor *), EVENT_LIGHTS | value
+  HIT,         // a lights change popped from the sensor ring
+  SET,         // the setter for the state event in value
+  SET_CLOCK,   // SetClockFromMs
+  SET_UW2F     // SetUW2FSecondsFromMs
+};
+
+struct Step {
+  int64_t at_ms; // from the start; the first step is at 0
+  StepKind kind;
+  uint32_t value;
+  std::string text;
+};
+
+struct ReplayCase {
+  const char *name;
+  std::vector<Step> steps;
+  int64_t end_ms;
+};
+
+static std::string HitLine(const HitEvent &hit) {
+  char line[80];
+  snprintf(line, sizeof(line), "hit: %08x at %08x, %08x %08x %08x\n",
+           hit.event, (uint32_t)hit.time_us, (uint32_t)hit.contact_left_us,
+           (uint32_t)hit.contact_right_us, (uint32_t)hit.lockout_us);
+  return line;
+}
+
+static void Apply(const Step &step, HitEvent &lastHit) {
+  FencingStateMachine &fsm = FencingStateMachine::getInstance();
+  uint32_t data = step.value & SUB_TYPE_MASK;
+  switch (step.kind) {
+  case REMOTE:
+    fsm.update((UDPIOHandler *)nullptr, EVENT_UI_INPUT | step.value);
+    break;
+  case CYRANO:
+    fsm.update((CyranoHandler *)nullptr, step.value);
+    break;
+  case CYRANO_TEXT:
+    fsm.update((CyranoHandler *)nullptr, step.text);
+    break;
+  case LIGHTS:
+    fsm.update((MultiWeaponSensor *)nullptr, EVENT_LIGHTS | step.value);
+    break;
+  case HIT: {
+    // What DoStateMachineTick() does with a HitEvent from the sensor
+    lastHit.event = step.value;
+    lastHit.time_us = s_Now;
+    lastHit.contact_left_us = step.value & MASK_RED ? s_Now - 1800 : 0;
+    lastHit.contact_right_us = step.value & MASK_GREEN ? s_Now - 900 : 0;
+    lastHit.lockout_us = s_Now + 300000;
+    uint32_t times[InputJournal::HIT_TIMES] = {
+        (uint32_t)lastHit.time_us, (uint32_t)lastHit.contact_left_us,
+        (uint32_t)lastHit.contact_right_us, (uint32_t)lastHit.lockout_us};
+    InputJournal::recordHit(lastHit.event, times);
+    fsm.SetMachineLights(lastHit.event);
+    break;
+  }
+  case SET:
+    switch (step.value & MAIN_TYPE_MASK) {
+    case EVENT_PRIO: fsm.SetPriority((Priority_t)data); break;
+    case EVENT_SCORE_LEFT: fsm.SetScoreLeft(data); break;
+    case EVENT_SCORE_RIGHT: fsm.SetScoreRight(data); break;
+    case EVENT_YELLOW_CARD_LEFT: fsm.SetYellowCardLeft(data); break;
+    case EVENT_YELLOW_CARD_RIGHT: fsm.SetYellowCardRight(data); break;
+    case EVENT_RED_CARD_LEFT: fsm.SetRedCardLeft(data); break;
+    case EVENT_RED_CARD_RIGHT: fsm.SetRedCardRight(data); break;
+    case EVENT_P_CARD:
+      fsm.SetPCardLeft(Event(step.value).pCardLeft());
+      fsm.SetPCardRight(Event(step.value).pCardRight());
+      break;
+    }
+    break;
+  case SET_CLOCK:
+    fsm.SetClockFromMs(step.value);
+    break;
+  case SET_UW2F:
+    fsm.SetUW2FSecondsFromMs(step.value);
+    break;
+  }
+}
+
+// An EFP1 DISP message as Cyrano sends it; empty fields are left alone
+static std::string Disp(const char *stopwatch, const char *left,
+                        const char *right, const char *round) {
+  EFP1Message msg;
+  msg[Protocol] = "EFP1.1";
+  msg[Command] = "DISP";
+  msg[PisteId] = "BLUE";
+  msg[StopWatch] = stopwatch;
+  msg[LeftScore] = left;
+  msg[RightScore] = right;
+  msg[RoundNumber] = round;
+  std::string text;
+  msg.ToString(text);
+  return text;
+}
+
+static std::vector<ReplayCase> ReplayCases() {
+  return {
+      {"remote_bout",
+       {{0, REMOTE, UI_INPUT_RESET},
+        {1000, REMOTE, UI_INPUT_START_TIMER},
+        {12345, LIGHTS, MASK_RED},
+        {13000, LIGHTS, 0},
+        {14000, REMOTE, UI_INPUT_INCR_SCORE_LEFT},
+        {15001, REMOTE, UI_INPUT_TOGGLE_TIMER},
+        {40007, LIGHTS, MASK_GREEN | MASK_BUZZ},
+        {41000, LIGHTS, 0},
+        {41500, REMOTE, UI_INPUT_INCR_SCORE_RIGHT},
+        {42000, REMOTE, UI_INPUT_YELLOW_CARD_RIGHT},
+        {43000, REMOTE, UI_INPUT_RED_CARD_LEFT},
+        {44000, REMOTE, UI_INPUT_START_TIMER},
+        {190003, REMOTE, UI_INPUT_PRIO},
+        {195000, REMOTE, UI_INPUT_START_TIMER}},
+       200000},
+      {"cyrano_and_sets",
+       {{0, CYRANO, EVENT_CYRANO_STATE_UNLOCKED},
+        {500, CYRANO_TEXT, 0, Disp("2:30", "4", "3", "1")},
+        {1000, SET, EVENT_SCORE_LEFT | 5},
+        {1000, SET, EVENT_YELLOW_CARD_RIGHT | 1},
+        {1200, SET, EVENT_PRIO | PRIO_RIGHT},
+        {1500, SET_CLOCK, 95000},
+        {1500, SET_UW2F, 42000},
+        {1600, SET, Event::PCards(1, 1)},
+        {2000, REMOTE, UI_INPUT_START_TIMER},
+        {9000, CYRANO, EVENT_CYRANO_STATE_LOCKED},
+        {9500, REMOTE, UI_INPUT_INCR_SCORE_RIGHT}, // ignored while locked
+        {10000, REMOTE, UI_INPUT_STOP_TIMER},      // ignored while locked
+        {30000, CYRANO, EVENT_CYRANO_STATE_UNLOCKED},
+        {30001, REMOTE, UI_INPUT_STOP_TIMER},
+        {31000, CYRANO_TEXT, 0, Disp("1:00", "", "7", "2")},
+        {32000, REMOTE, UI_INPUT_START_TIMER}},
+       100000},
+      {"hits_and_uw2f",
+       {{0, REMOTE, UI_INPUT_RESET},
+        {10, SET, EVENT_SCORE_RIGHT | 2},
+        {1000, REMOTE, UI_INPUT_START_TIMER},
+        {8765, HIT, MASK_RED | MASK_BUZZ},
+        {10765, HIT, 0},
+        {11000, REMOTE, UI_INPUT_INCR_SCORE_LEFT},
+        {12000, REMOTE, UI_INPUT_START_TIMER},
+        {75000, REMOTE, UI_INPUT_STOP_TIMER},
+        {76000, REMOTE, UI_INPUT_P_CARD},
+        {77000, REMOTE, UI_INPUT_P_CARD_UNDO},
+        {78000, REMOTE, UI_INPUT_RESTORE_UW2F_TIMER},
+        {79000, REMOTE, UI_INPUT_START_TIMER},
+        {90000, HIT, MASK_RED | MASK_GREEN | MASK_BUZZ},
+        {90040, HIT, MASK_GREEN | MASK_RED},
+        {92000, HIT, 0}},
+       95000},
+  };
+}
+
+// A run's output, handed from the child process to the parent
+struct RunResult {
+  std::string journal; // serialized chunk (record run)
+  std::string trace;
+  uint32_t entries = 0; // journaled during the run
+};
+
+static void PutField(std::string &out, const std::string &field) {
+  uint32_t size = field.size();
+  out.append((const char *)&size, sizeof(size));
+  out += field;
+}
+
+static bool GetField(const std::string &in, size_t &pos, std::string &field) {
+  uint32_t size;
+  if (in.size() - pos < sizeof(size))
+    return false;
+  memcpy(&size, in.data() + pos, sizeof(size));
+  pos += sizeof(size);
+  if (in.size() - pos < size)
+    return false;
+  field = in.substr(pos, size);
+  pos += size;
+  return true;
+}
+
+// Runs `run` in a child process, which starts with a fresh state machine
+template <class Run> static bool RunInChild(Run run, RunResult &result) {
+  int fds[2];
+  if (pipe(fds))
+    return false;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    RunResult r = run();
+    std::string out;
+    PutField(out, r.journal);
+    PutField(out, r.trace);
+    PutField(out, std::string((const char *)&r.entries, sizeof(r.entries)));
+    for (size_t done = 0; done < out.size();) {
+      ssize_t n = write(fds[1], out.data() + done, out.size() - done);
+      if (n <= 0)
+        _exit(1);
+      done += n;
+    }
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string in;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    in.append(buffer, n);
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  size_t pos = 0;
+  std::string entries;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) ||
+      !GetField(in, pos, result.journal) || !GetField(in, pos, result.trace) ||
+      !GetField(in, pos, entries) || entries.size() != sizeof(result.entries))
+    return false;
+  memcpy(&result.entries, entries.data(), sizeof(result.entries));
+  return true;
+}
+
+// Entries journaled and not serialized yet, serialized
+static std::string TakeJournal(uint32_t &entries) {
+  std::string journal(InputJournal::pendingSize(), '\0');
+  journal.resize(
+      InputJournal::serialize((uint8_t *)&journal[0], journal.size()));
+  entries = journal.empty() ? 0
+                            : (journal.size() - sizeof(InputJournal::Header)) /
+                                  sizeof(InputJournal::Entry);
+  return journal;
+}
+
+static RunResult Record(const ReplayCase &c) {
+  RunResult r;
+  InputJournal::enable(4096);
+  StateMachineTask task(SESSION_START_US);
+  Tracer tracer(SESSION_START_US);
+  HitEvent lastHit = {};
+  for (const Step &step : c.steps) {
+    task.runUntil(SESSION_START_US + step.at_ms * 1000);
+    Apply(step, lastHit);
+    task.wake();
+  }
+  task.runUntil(SESSION_START_US + c.end_ms * 1000);
+  tracer.finish();
+  tracer.add(HitLine(lastHit));
+  r.trace = tracer.text();
+  r.journal = TakeJournal(r.entries);
+  return r;
+}
+
+// Entries of serialized chunks, in order. Returns false if the data is not
+// a sequence of chunks; lost counts the entries the chunks report lost.
+static bool Decode(const std::string &data,
+                   std::vector<InputJournal::Entry> &entries,
+                   uint32_t &lost) {
+  size_t pos = 0;
+  lost = 0;
+  while (pos < data.size()) {
+    InputJournal::Header header;
+    if (data.size() - pos < sizeof(header))
+      return false;
+    memcpy(&header, data.data() + pos, sizeof(header));
+    if (memcmp(header.magic, "OIJ1", 4) ||
+        header.header_size < sizeof(header) ||
+        header.entry_size < sizeof(InputJournal::Entry))
+      return false;
+    pos += header.header_size;
+    if ((data.size() - pos) / header.entry_size < header.count)
+      return false;
+    for (uint32_t i = 0; i < header.count; i++) {
+      InputJournal::Entry e;
+      memcpy(&e, data.data() + pos, sizeof(e));
+      entries.push_back(e);
+      pos += header.entry_size;
+    }
+    lost += header.lost;
+  }
+  return true;
+}
+
+// The journal's times are the low 32 bits of esp_timer_get_time(); the
+// replay starts at the first one and follows the differences, so it stays
+// on the recorded times across a wrap.
+static RunResult Replay(const std::vector<InputJournal::Entry> &entries,
+                        int64_t end_after_first_us) {
+  RunResult r;
+  InputJournal::enable(4096);
+  int64_t start = entries.empty() ? 0 : entries[0].time_us;
+  StateMachineTask task(start);
+  Tracer tracer(start);
+  FencingStateMachine &fsm = FencingStateMachine::getInstance();
+  for (const InputJournal::Entry &e : entries) {
+    task.runUntil(start + (uint32_t)(e.time_us - entries[0].time_us));
+    fsm.ReplayInput(e);
+    task.wake();
+  }
+  task.runUntil(s_Now > start + end_after_first_us
+                    ? s_Now
+                    : start + end_after_first_us);
+  tracer.finish();
+  tracer.add(HitLine(fsm.GetLastHitEvent()));
+  r.trace = tracer.text();
+  TakeJournal(r.entries);
+  return r;
+}
+
+// First line where two traces differ
+static void PrintDifference(const std::string &want, const std::string &got) {
+  size_t line = 0, start = 0;
+  while (true) {
+    size_t a = want.find('\n', start), b = got.find('\n', start);
+    std::string wantLine = want.substr(start, a - start);
+    std::string gotLine = got.substr(start, b - start);
+    if (wantLine != gotLine || a == std::string::npos) {
+      printf("  line %zu: recorded \"%s\", replayed \"%s\"\n", line + 1,
+             wantLine.c_str(), gotLine.c_str());
+      return;
+    }
+    start = a + 1;
+    line++;
+  }
+}
+
+static bool RunReplayCase(const ReplayCase &c) {
+  RunResult recorded, replayed;
+  if (!RunInChild([&] { return Record(c); }, recorded)) {
+    printf("  %s: recording crashed\n", c.name);
+    return false;
+  }
+  std::vector<InputJournal::Entry> entries;
+  uint32_t lost;
+  if (!Decode(recorded.journal, entries, lost) || lost ||
+      entries.size() != recorded.entries) {
+    printf("  %s: journal does not decode\n", c.name);
+    return false;
+  }
+  if (!RunInChild([&] { return Replay(entries, c.end_ms * 1000); },
+                  replayed)) {
+    printf("  %s: replay crashed\n", c.name);
+    return false;
+  }
+  bool ok = true;
+  if (replayed.trace != recorded.trace) {
+    PrintDifference(recorded.trace, replayed.trace);
+    ok = false;
+  }
+  if (replayed.entries) {
+    printf("  %s: the replay journaled %u entries again\n", c.name,
+           replayed.entries);
+    ok = false;
+  }
+  size_t events = 0;
+  for (char ch : recorded.trace)
+    events += ch == '\n';
+  printf("%-16s %s: %u entries, %zu events\n", c.name, ok ? "ok" : "FAILED",
+         recorded.entries, events - 2);
+  return ok;
+}
+
+static int ReplayFile(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    printf("cannot open %s\n", path);
+    return 1;
+  }
+  std::string data;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    data.append(buffer, n);
+  fclose(f);
+  std::vector<InputJournal::Entry> entries;
+  uint32_t lost;
+  if (!Decode(data, entries, lost) || entries.empty()) {
+    printf("%s: no input journal chunks\n", path);
+    return 1;
+  }
+  if (lost)
+    printf("%u entries were lost: the replay may not match the session\n",
+           lost);
+  RunResult r = Replay(entries, 0);
+  printf("%zu entries replayed, events (ms from the first entry, event):\n%s",
+         entries.size(), r.trace.c_str());
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    return ReplayFile(argv[1]);
+  int failed = 0, total = 0;
+  for (const ReplayCase &c : ReplayCases()) {
+    total++;
+    failed += !RunReplayCase(c);
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,474 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Regression suite for LongHitDetector and DoubleHitDetector.
+//
+//   hit_regression                    run all cases, print throughput
+//   hit_regression --replay FILE      run a RawCapture dump through the scan
+//                                     and print what it produces
+//   --long-ms N --min-ms N --max-ms N --gap-ms N
+//                                     detector timing for the replay, as the
+//                                     LONGHIT_MS / DBLHIT_* NVS keys
+//
+// Detector cases feed contact timelines straight into fresh detectors at
+// scanloop_us ticks. Scan cases script the connector lines in SensorSim and
+// check the lights and the detector events the full scan produces. Expected
+// times are checked to within one millisecond. The round trip case records
+// a scan case with RawCapture and replays the dump, which is the path a
+// capture taken on a box goes through.
+#include "EventDefinitions.h"
+#include "SensorSim.h"
+#include "TimingConstants.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum Contact : uint8_t { VL = 1, VR = 2, IL = 4, IR = 8 };
+
+struct Press {
+  int from_ms;
+  int to_ms;
+  uint8_t contacts;
+};
+
+struct Expected {
+  int at_ms;
+  uint32_t event;
+};
+
+struct DetectorCase {
+  const char *name;
+  int end_ms;
+  std::vector<Press> presses;
+  std::vector<Expected> expected;
+};
+
+static constexpr uint32_t LONG_VL = EVENT_LONGHIT | LONGHIT_VALID_LEFT;
+static constexpr uint32_t LONG_VR = EVENT_LONGHIT | LONGHIT_VALID_RIGHT;
+static constexpr uint32_t LONG_DOUBLE = LONGHIT_IS_DOUBLE;
+static constexpr uint32_t TAP_VL = EVENT_DOUBLEHIT | DOUBLEHIT_VALID_LEFT;
+static constexpr uint32_t TAP_IL = EVENT_DOUBLEHIT | DOUBLEHIT_INVALID_LEFT;
+
+// Default timing: long hit 3 s; tap 5..500 ms, gap up to 400 ms.
+static const DetectorCase DetectorCases[] = {
+    {"long_left", 3500, {{100, 3300, VL}}, {{3100, LONG_VL}}},
+    {"long_released_early", 3500, {{100, 2000, VL}}, {}},
+    {"long_both_same_tick",
+     3500,
+     {{100, 3300, VL | VR}},
+     {{3100, LONG_VL | LONG_VR | LONG_DOUBLE}}},
+    // right is pressing when left fires: wait, right fires too -> double
+    {"long_both_overlapping",
+     5000,
+     {{100, 4800, VL}, {1000, 4500, VR}},
+     {{4000, LONG_VL | LONG_VR | LONG_DOUBLE}}},
+    // right is pressing when left fires, then lets go -> single for left
+    {"long_other_side_releases",
+     4500,
+     {{100, 4000, VL}, {2000, 3500, VR}},
+     {{3500, LONG_VL}}},
+    // single for left, right reaches 3 s while left still holds -> double
+    {"long_single_then_double",
+     7000,
+     {{100, 6500, VL}, {3200, 6500, VR}},
+     {{3100, LONG_VL}, {6200, LONG_VL | LONG_VR | LONG_DOUBLE}}},
+    {"tap_tap_left",
+     1000,
+     {{100, 150, VL}, {300, 350, VL}},
+     {{350, TAP_VL}}},
+    {"tap_tap_cross_side", 1000, {{100, 150, VL}, {300, 350, VR}}, {}},
+    {"tap_gap_too_long", 1200, {{100, 150, VL}, {600, 650, VL}}, {}},
+    {"tap_first_too_short", 1000, {{100, 103, VL}, {200, 250, VL}}, {}},
+    {"tap_first_held_too_long", 1200, {{100, 700, VL}, {800, 850, VL}}, {}},
+    {"tap_second_too_short", 1000, {{100, 150, VL}, {300, 303, VL}}, {}},
+    {"tap_second_held_too_long", 1500, {{100, 150, VL}, {300, 900, VL}}, {}},
+    {"tap_tap_off_target",
+     1000,
+     {{100, 150, IL}, {300, 350, IL}},
+     {{350, TAP_IL}}},
+};
+
+class Recorder : public Observer<LongHitDetector>,
+                 public Observer<DoubleHitDetector> {
+public:
+  void update(LongHitDetector *, uint32_t eventtype) override {
+    events.push_back({now, eventtype});
+  }
+  void update(DoubleHitDetector *, uint32_t eventtype) override {
+    events.push_back({now, eventtype});
+  }
+  int64_t now = 0;
+  std::vector<SensorSim::DetectorEvent> events;
+};
+
+static uint8_t ContactsAt(const std::vector<Press> &presses, int64_t t_us) {
+  uint8_t contacts = 0;
+  for (const Press &press : presses) {
+    if (t_us >= press.from_ms * 1000LL && t_us < press.to_ms * 1000LL)
+      contacts |= press.contacts;
+  }
+  return contacts;
+}
+
+static bool Matches(const char *name, const std::vector<Expected> &expected,
+                    const std::vector<SensorSim::DetectorEvent> &got) {
+  bool ok = expected.size() == got.size();
+  for (size_t i = 0; ok && i < got.size(); i++) {
+    int64_t diff = got[i].time_us - expected[i].at_ms * 1000LL;
+    ok = got[i].event == expected[i].event && diff > -1000 && diff < 1000;
+  }
+  if (ok)
+    return true;
+  printf("FAIL %s\n  expected:\n", name);
+  for (const Expected &e : expected)
+    printf("  %8d ms  0x%08x\n", e.at_ms, (unsigned)e.event);
+  printf("  got:\n");
+  for (const SensorSim::DetectorEvent &e : got)
+    printf("  %8.2f ms  0x%08x\n", e.time_us / 1000.0, (unsigned)e.event);
+  return false;
+}
+
+// Time 0 is tick 0; the detectors never see now == 0, which DebounceTimer
+// reserves for "no contact".
+static void RunDetectors(const DetectorCase &c, LongHitDetector &longHit,
+                         DoubleHitDetector &doubleHit, Recorder &recorder) {
+  const int64_t offset = scanloop_us;
+  for (int64_t t = 0; t < c.end_ms * 1000LL; t += scanloop_us) {
+    uint8_t contacts = ContactsAt(c.presses, t);
+    recorder.now = t;
+    bool vl = contacts & VL, vr = contacts & VR;
+    bool il = contacts & IL, ir = contacts & IR;
+    longHit.update(t + offset, vl, vr, il, ir);
+    doubleHit.update(t + offset, vl, vr, il, ir);
+  }
+}
+
+static bool RunDetectorCase(const DetectorCase &c, uint64_t &ticks) {
+  LongHitDetector longHit;
+  DoubleHitDetector doubleHit;
+  Recorder recorder;
+  longHit.attach(recorder);
+  doubleHit.attach(recorder);
+  RunDetectors(c, longHit, doubleHit, recorder);
+  ticks += c.end_ms * 1000LL / scanloop_us;
+  return Matches(c.name, c.expected, recorder.events);
+}
+
+// Every detector case back to back, repeated, into one pair of detectors:
+// ticks per second of the two update() calls.
+static void DetectorThroughput() {
+  LongHitDetector longHit;
+  DoubleHitDetector doubleHit;
+  Recorder recorder;
+  longHit.attach(recorder);
+  doubleHit.attach(recorder);
+  const int rounds = 100;
+  uint64_t ticks = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (const DetectorCase &c : DetectorCases) {
+      RunDetectors(c, longHit, doubleHit, recorder);
+      ticks += c.end_ms * 1000LL / scanloop_us;
+    }
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+  printf("detectors: %llu ticks in %.3f s = %.0f ticks/s (%.1f ns/tick)\n",
+         (unsigned long long)ticks, s, ticks / s, s * 1e9 / ticks);
+}
+
+// Scan cases: lights (HitEvent words) and detector events of the full scan.
+
+struct Step {
+  int at_ms;
+  SimLine a, b;
+  float ohms; // < 0: disconnect
+};
+
+struct ScanCase {
+  const char *name;
+  weapon_t weapon;
+  int end_ms;
+  std::vector<Step> steps;
+  std::vector<Expected> lights;
+  std::vector<Expected> detectors;
+};
+
+static constexpr float OPEN = -1;
+static constexpr uint32_t LIGHTS = EVENT_LIGHTS;
+
+// Epee: tip closes A-C; the hit counts after EpeeContactTime_us (6 ms), the
+// lockout is 45 ms, the lights stay 2 s, the buzzer stops 45 ms earlier and
+// the reset follows 500 ms later. Foil: tip opens A-B (closed < 300 Ohm).
+static const ScanCase ScanCases[] = {
+    {"epee_double",
+     EPEE,
+     3000,
+     {{100, AL, CL, 20}, {120, AR, CR, 20}, {140, AL, CL, OPEN},
+      {140, AR, CR, OPEN}},
+     {{106, LIGHTS | MASK_RED | MASK_BUZZ},
+      {126, LIGHTS | MASK_RED | MASK_GREEN | MASK_BUZZ},
+      {2106, LIGHTS | MASK_RED | MASK_GREEN},
+      {2606, LIGHTS}},
+     {}},
+    {"epee_after_lockout",
+     EPEE,
+     3000,
+     {{100, AL, CL, 20}, {160, AR, CR, 20}, {180, AL, CL, OPEN},
+      {180, AR, CR, OPEN}},
+     {{106, LIGHTS | MASK_RED | MASK_BUZZ},
+      {2106, LIGHTS | MASK_RED},
+      {2606, LIGHTS}},
+     {}},
+    {"epee_on_guard",
+     EPEE,
+     1000,
+     {{100, AL, CL, 20}, {100, AL, BR, 10}, {130, AL, CL, OPEN},
+      {130, AL, BR, OPEN}},
+     {},
+     {}},
+    {"epee_tap_tap",
+     EPEE,
+     3000,
+     {{100, AL, CL, 20}, {130, AL, CL, OPEN}, {250, AL, CL, 20},
+      {280, AL, CL, OPEN}},
+     {{106, LIGHTS | MASK_RED | MASK_BUZZ},
+      {2106, LIGHTS | MASK_RED},
+      {2606, LIGHTS}},
+     {{280, TAP_VL}}},
+    // still pressed after the reset at 2606 ms: a new hit 6 ms later
+    {"epee_long_hit",
+     EPEE,
+     4000,
+     {{100, AL, CL, 20}, {3300, AL, CL, OPEN}},
+     {{106, LIGHTS | MASK_RED | MASK_BUZZ},
+      {2106, LIGHTS | MASK_RED},
+      {2606, LIGHTS},
+      {2612, LIGHTS | MASK_RED | MASK_BUZZ}},
+     {{3100, LONG_VL}}},
+    {"foil_valid_then_off_target",
+     FOIL,
+     3000,
+     {{0, AL, BL, 5}, {0, AR, BR, 5}, {100, AL, BL, OPEN}, {100, AL, CR, 50},
+      {120, AR, BR, OPEN}, {140, AL, BL, 5}, {140, AR, BR, 5},
+      {140, AL, CR, OPEN}},
+     {{114, LIGHTS | MASK_RED | MASK_BUZZ},
+      {134, LIGHTS | MASK_RED | MASK_WHITE_R | MASK_BUZZ},
+      {2114, LIGHTS | MASK_RED | MASK_WHITE_R},
+      {2614, LIGHTS}},
+     {}},
+};
+
+static std::vector<SensorSim::DetectorEvent>
+LightsOf(const std::vector<HitEvent> &events) {
+  std::vector<SensorSim::DetectorEvent> lights;
+  for (const HitEvent &event : events)
+    lights.push_back({event.time_us, event.event});
+  return lights;
+}
+
+static bool RunScanCase(const ScanCase &c, uint64_t &scans) {
+  SensorSim sim(c.weapon);
+  for (const Step &step : c.steps) {
+    sim.runUntil(step.at_ms * 1000LL);
+    if (step.ohms < 0)
+      SensorSim::disconnect(step.a, step.b);
+    else
+      SensorSim::connect(step.a, step.b, step.ohms);
+  }
+  sim.runUntil(c.end_ms * 1000LL);
+  scans += sim.scans();
+  std::string name = c.name;
+  bool ok = Matches((name + " lights").c_str(), c.lights, LightsOf(sim.events()));
+  ok &= Matches((name + " detectors").c_str(), c.detectors,
+                sim.detectorEvents());
+  return ok;
+}
+
+// Records epee_double with RawCapture, replays the dump through a new
+// SensorSim and expects the same lights inside the captured window.
+static bool ReplayRoundTrip(uint64_t &scans) {
+  const ScanCase &c = ScanCases[0];
+  RawCapture::enable();
+  {
+    SensorSim sim(c.weapon);
+    for (const Step &step : c.steps) {
+      sim.runUntil(step.at_ms * 1000LL);
+      if (step.ohms < 0)
+        SensorSim::disconnect(step.a, step.b);
+      else
+        SensorSim::connect(step.a, step.b, step.ohms);
+    }
+    sim.runUntil(500000);
+    scans += sim.scans();
+  }
+  std::vector<uint8_t> dump(RawCapture::serializedSize());
+  bool frozen = RawCapture::isFrozen() &&
+                RawCapture::serialize(dump.data(), dump.size()) == dump.size();
+  RawCapture::disable();
+  weapon_t weapon;
+  int64_t span_us;
+  if (!frozen ||
+      !SensorSim::replay(dump.data(), dump.size(), weapon, span_us) ||
+      weapon != c.weapon) {
+    printf("FAIL replay_round_trip: no capture\n");
+    return false;
+  }
+  SensorSim replay(weapon);
+  replay.runUntil(span_us + scanloop_us);
+  scans += replay.scans();
+  const uint32_t expected[] = {c.lights[0].event, c.lights[1].event};
+  bool ok = replay.events().size() == 2;
+  for (size_t i = 0; ok && i < 2; i++)
+    ok = replay.events()[i].event == expected[i];
+  if (!ok) {
+    printf("FAIL replay_round_trip\n");
+    replay.printEvents();
+  }
+  return ok;
+}
+
+static int Replay(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    data.insert(data.end(), buffer, buffer + n);
+  fclose(f);
+
+  weapon_t weapon;
+  int64_t span_us;
+  if (!SensorSim::replay(data.data(), data.size(), weapon, span_us)) {
+    fprintf(stderr, "%s: not a raw capture\n", path);
+    return 1;
+  }
+  SensorSim sim(weapon);
+  auto start = std::chrono::steady_clock::now();
+  sim.runUntil(span_us + scanloop_us);
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+  printf("%s: weapon %d, %.2f ms\nlights:\n", path, (int)weapon,
+         span_us / 1000.0);
+  sim.printEvents();
+  printf("detectors:\n");
+  if (sim.detectorEvents().empty())
+    printf("  none\n");
+  sim.printDetectorEvents();
+  printf("scan: %llu scans in %.3f s = %.0f scans/s\n",
+         (unsigned long long)sim.scans(), s, sim.scans() / s);
+  return 0;
+}
+
+// What one timestamp per scan saves: the scan cases are run again counting
+// the reads of the scan timestamp, each of which used to be a timer read of
+// its own, and once more taking the host time at each of those reads to see
+// how far apart they were within one scan (the spread includes those clock
+// reads, as the old code paid for its own). A timer read is costed as the
+// host's steady_clock (and TSC cycles on x86); esp_timer_get_time() on the
+// box costs differently, but the read count and the spread carry over.
+static void TimestampBenchmark() {
+  const int reads = 1000000;
+  volatile int64_t sink = 0;
+  double read_cycles = 0; // 0: no cycle counter
+  auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+  uint64_t tsc = __rdtsc();
+#endif
+  for (int i = 0; i < reads; i++)
+    sink = std::chrono::steady_clock::now().time_since_epoch().count();
+  (void)sink;
+#if defined(__x86_64__) || defined(__i386__)
+  read_cycles = (double)(__rdtsc() - tsc) / reads;
+#endif
+  double read_ns = std::chrono::duration<double, std::nano>(
+                       std::chrono::steady_clock::now() - start)
+                       .count() /
+                   reads;
+
+  uint64_t scans = 0;
+  SensorSim::resetTimestampUse(false);
+  for (const ScanCase &c : ScanCases)
+    RunScanCase(c, scans);
+  SensorSim::TimestampUse use = SensorSim::timestampUse();
+  double saved = (double)use.reads / use.scans - 1; // one read remains
+
+  SensorSim::resetTimestampUse(true);
+  for (const ScanCase &c : ScanCases)
+    RunScanCase(c, scans);
+  SensorSim::TimestampUse skew = SensorSim::timestampUse();
+  SensorSim::resetTimestampUse(false);
+
+  printf("scan timestamp: %.1f timer reads/scan saved, %.0f ns/scan on the "
+         "host (%.1f ns/read)\n",
+         saved, saved * read_ns, read_ns);
+  if (read_cycles > 0)
+    printf("  %.0f TSC cycles/scan saved (%.0f cycles/read)\n",
+           saved * read_cycles, read_cycles);
+  printf("  intra-scan skew removed, first to last read: %.0f ns mean, "
+         "%.0f ns p99, %.0f ns max\n",
+         skew.spread_mean_ns, skew.spread_p99_ns, skew.spread_max_ns);
+}
+
+int main(int argc, char **argv) {
+  SensorSim::setDefaultThresholds();
+  MultiWeaponSensor &sensor = MultiWeaponSensor::getInstance();
+  const char *replay = nullptr;
+  for (int i = 1; i < argc; i++) {
+    int64_t ms = i + 1 < argc ? atoll(argv[i + 1]) : 0;
+    if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+      replay = argv[++i];
+    else if (!strcmp(argv[i], "--long-ms") && ms > 0 && ++i)
+      sensor.getLongHitDetector().setDurationUs(ms * 1000);
+    else if (!strcmp(argv[i], "--min-ms") && ms > 0 && ++i)
+      sensor.getDoubleHitDetector().setMinHitUs(ms * 1000);
+    else if (!strcmp(argv[i], "--max-ms") && ms > 0 && ++i)
+      sensor.getDoubleHitDetector().setMaxHitUs(ms * 1000);
+    else if (!strcmp(argv[i], "--gap-ms") && ms > 0 && ++i)
+      sensor.getDoubleHitDetector().setMaxGapUs(ms * 1000);
+    else {
+      fprintf(stderr, "usage: %s [--replay FILE] [--long-ms N] [--min-ms N] "
+                      "[--max-ms N] [--gap-ms N]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (replay)
+    return Replay(replay);
+
+  int failed = 0, total = 0;
+  uint64_t ticks = 0;
+  for (const DetectorCase &c : DetectorCases) {
+    total++;
+    failed += !RunDetectorCase(c, ticks);
+  }
+  uint64_t scans = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const ScanCase &c : ScanCases) {
+    total++;
+    failed += !RunScanCase(c, scans);
+  }
+  total++;
+  failed += !ReplayRoundTrip(scans);
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+  printf("%d of %d cases passed\n", total - failed, total);
+  DetectorThroughput();
+  printf("scan: %llu scans in %.3f s = %.0f scans/s (%.2f us/scan, budget "
+         "%d us on the box)\n",
+         (unsigned long long)scans, s, scans / s, s * 1e6 / scans,
+         scanloop_us);
+  TimestampBenchmark();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,311 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Checks and benchmarks the NeoPixelRMT encoder against the per-bit loop it
+// replaced.
+//
+//   neopixel_encode    run all cases, print per-bit vs table timing
+//
+// Every case paints a sequence of frames into a 128-pixel NeoPixelRMT, the
+// size of the scoring lights, and calls show(). The frame show() hands to
+// the RMT driver is compared item for item with the frame the old encoder
+// builds from the same colours: palette pre-scaled with Color(r, g, b,
+// brightness), then one branch per bit. Partial updates exercise the dirty
+// regions of both buffers; a frame that did not change must not be sent.
+#include "NeoPixelRMT.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static constexpr int NUM_PIXELS = 128;
+static constexpr int BITS_PER_PIXEL = 24;
+
+// Last frame show() handed to the driver; copied only while checking
+static bool s_Capture = true;
+static std::vector<rmt_item32_t> s_Sent;
+static int s_Writes = 0;
+static uint32_t s_Checksum = 0;
+
+esp_err_t rmt_write_items(rmt_channel_t, const rmt_item32_t *items,
+                          int item_num, bool) {
+  s_Writes++;
+  if (s_Capture)
+    s_Sent.assign(items, items + item_num);
+  else
+    s_Checksum += items[0].val + items[item_num - 2].val;
+  return ESP_OK;
+}
+
+class Random {
+public:
+  explicit Random(uint32_t seed) : m_State(seed * 2654435761u + 1) {}
+  uint32_t next() {
+    m_State ^= m_State << 13;
+    m_State ^= m_State >> 17;
+    m_State ^= m_State << 5;
+    return m_State;
+  }
+
+private:
+  uint32_t m_State;
+};
+
+// The encoder before the nibble tables, timing values as in NeoPixelRMT.h
+static void LegacyEncodePixel(rmt_item32_t *item, uint32_t color) {
+  for (int bit = 23; bit >= 0; bit--) {
+    bool bitIsSet = color & (1 << bit);
+    if (bitIsSet) {
+      item->duration0 = 28;
+      item->level0 = 1;
+      item->duration1 = 24;
+      item->level1 = 0;
+    } else {
+      item->duration0 = 14;
+      item->level0 = 1;
+      item->duration1 = 38;
+      item->level1 = 0;
+    }
+    item++;
+  }
+}
+
+// The whole frame the old code sent for these RGB colours at brightness
+static void LegacyFrame(const std::vector<uint32_t> &rgb, uint8_t brightness,
+                        std::vector<rmt_item32_t> &frame) {
+  frame.assign(rgb.size() * BITS_PER_PIXEL + 1, rmt_item32_t());
+  for (size_t i = 0; i < rgb.size(); i++) {
+    uint32_t c = NeoPixelRMT::Color((rgb[i] >> 16) & 0xFF,
+                                    (rgb[i] >> 8) & 0xFF, rgb[i] & 0xFF,
+                                    brightness);
+    uint32_t grb = (c & 0xFF00) << 8 | (c >> 8 & 0xFF00) | (c & 0xFF);
+    LegacyEncodePixel(&frame[i * BITS_PER_PIXEL], grb);
+  }
+  rmt_item32_t &reset = frame[rgb.size() * BITS_PER_PIXEL];
+  reset.duration0 = 80 * 40;
+}
+
+// WS2812B_LedStrip's palette
+static const uint32_t kPalette[] = {
+    0xFF0000, 0x00FF00, 0xC8C8C8, 0xA03C00, 0xCCA800, 0x0000FF, 0xAA4600, 0};
+
+struct Strip {
+  NeoPixelRMT pixels{NUM_PIXELS, GPIO_NUM_NC};
+  std::vector<uint32_t> rgb = std::vector<uint32_t>(NUM_PIXELS, 0);
+  uint8_t brightness = 255;
+  bool changed = true; // rgb or brightness differs from the last frame sent
+  bool ok = true;
+  int frames = 0;
+
+  void set(int idx, uint32_t color) {
+    pixels.setPixelColor(idx, color);
+    changed |= rgb[idx] != color;
+    rgb[idx] = color;
+  }
+  void fill(uint32_t color, int start, int count) {
+    pixels.fill(color, start, count);
+    for (int i = start; i < start + count && i < NUM_PIXELS; i++) {
+      changed |= rgb[i] != color;
+      rgb[i] = color;
+    }
+  }
+  void setBrightness(uint8_t value) {
+    pixels.setBrightness(value);
+    changed |= brightness != value;
+    brightness = value;
+  }
+  // show(), then compare the frame sent with the old encoder's. A frame is
+  // sent exactly when something changed since the last one.
+  void show(const char *name) {
+    int writes = s_Writes;
+    pixels.show();
+    frames++;
+    bool sent = s_Writes != writes;
+    if (sent != changed) {
+      if (ok)
+        printf("  %s frame %d: %s\n", name, frames,
+               changed ? "not sent" : "sent unchanged");
+      ok = false;
+      return;
+    }
+    changed = false;
+    std::vector<rmt_item32_t> expected;
+    LegacyFrame(rgb, brightness, expected);
+    if (s_Sent.size() != expected.size()) {
+      if (ok)
+        printf("  %s frame %d: %zu items, expected %zu\n", name, frames,
+               s_Sent.size(), expected.size());
+      ok = false;
+      return;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+      if (s_Sent[i].val != expected[i].val) {
+        if (ok)
+          printf("  %s frame %d: pixel %zu bit %zu is %08x, expected %08x\n",
+                 name, frames, i / BITS_PER_PIXEL, i % BITS_PER_PIXEL,
+                 s_Sent[i].val, expected[i].val);
+        ok = false;
+        return;
+      }
+    }
+  }
+};
+
+// Random full frames at full brightness
+static bool FullFrames(const char *name, Random &rnd) {
+  Strip s;
+  for (int f = 0; f < 50; f++) {
+    for (int i = 0; i < NUM_PIXELS; i++)
+      s.set(i, rnd.next() & 0xFFFFFF);
+    s.show(name);
+  }
+  return s.ok;
+}
+
+// One random frame shown at every brightness, up and down again
+static bool BrightnessLevels(const char *name, Random &rnd) {
+  Strip s;
+  for (int i = 0; i < NUM_PIXELS; i++)
+    s.set(i, rnd.next() & 0xFFFFFF);
+  for (int b = 255; b >= 0; b--) {
+    s.setBrightness(b);
+    s.show(name);
+  }
+  for (int b = 1; b < 256; b += 7) {
+    s.setBrightness(b);
+    s.show(name);
+  }
+  return s.ok;
+}
+
+// The palette panels at the four brightness steps of the strip
+static bool PalettePanels(const char *name, Random &rnd) {
+  static const uint8_t kBrightness[] = {15, 30, 75, 125};
+  Strip s;
+  for (uint8_t b : kBrightness) {
+    s.setBrightness(b);
+    for (uint32_t left : kPalette) {
+      s.fill(left, 0, 64);
+      s.fill(kPalette[rnd.next() % 8], 64, 64);
+      s.show(name);
+    }
+  }
+  return s.ok;
+}
+
+// A few pixels change per frame, so each buffer re-encodes only its dirty
+// regions, which differ from the other buffer's
+static bool PartialUpdates(const char *name, Random &rnd) {
+  Strip s;
+  s.fill(kPalette[6], 0, NUM_PIXELS);
+  s.show(name);
+  for (int f = 0; f < 400; f++) {
+    int changes = 1 + rnd.next() % 4;
+    for (int c = 0; c < changes; c++)
+      s.set(rnd.next() % NUM_PIXELS, kPalette[rnd.next() % 8]);
+    if (f % 50 == 49)
+      s.setBrightness(rnd.next() & 0xFF);
+    s.show(name);
+  }
+  return s.ok;
+}
+
+// Repainting the same colours or brightness, or nothing at all, sends
+// nothing; clear() sends black
+static bool UnchangedFrame(const char *name, Random &rnd) {
+  Strip s;
+  s.fill(kPalette[0], 0, 64);
+  s.fill(kPalette[1], 64, 64);
+  s.show(name);
+  s.show(name);
+  s.fill(kPalette[0], 0, 64);
+  s.set(100, kPalette[1]);
+  s.show(name);
+  s.setBrightness(255);
+  s.show(name);
+  s.set(100, kPalette[2]);
+  s.show(name);
+  s.pixels.clear();
+  s.rgb.assign(NUM_PIXELS, 0);
+  s.changed = true;
+  s.show(name);
+  s.show(name);
+  return s.ok;
+}
+
+struct EncodeCase {
+  const char *name;
+  bool (*run)(const char *name, Random &rnd);
+};
+
+static const EncodeCase EncodeCases[] = {
+    {"full_frames", FullFrames},       {"brightness", BrightnessLevels},
+    {"palette_panels", PalettePanels}, {"partial_updates", PartialUpdates},
+    {"unchanged_frame", UnchangedFrame},
+};
+
+// Full-frame encode: the per-bit loop over every pixel against show() with
+// every pixel changed. show() also walks the dirty regions, so the table
+// encoder carries a little bookkeeping the per-bit loop does not.
+static void Benchmark() {
+  const int repeats = 20000;
+  std::vector<uint32_t> grb[2];
+  Random rnd(7);
+  for (int f = 0; f < 2; f++)
+    for (int i = 0; i < NUM_PIXELS; i++)
+      grb[f].push_back(rnd.next() & 0xFFFFFF);
+  std::vector<rmt_item32_t> frame(NUM_PIXELS * BITS_PER_PIXEL + 1);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    const std::vector<uint32_t> &colors = grb[r & 1];
+    for (int i = 0; i < NUM_PIXELS; i++)
+      LegacyEncodePixel(&frame[i * BITS_PER_PIXEL], colors[i]);
+    s_Checksum += frame[r % frame.size()].val;
+  }
+  double perBit = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  // Both frames differ in every pixel, so every show() encodes all of them
+  NeoPixelRMT pixels(NUM_PIXELS, GPIO_NUM_NC);
+  pixels.setBrightness(128);
+  s_Capture = false;
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    const std::vector<uint32_t> &colors = grb[r & 1];
+    for (int i = 0; i < NUM_PIXELS; i++)
+      pixels.setPixelColor(i, colors[i]);
+    pixels.show();
+  }
+  double table = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  // One pixel per frame: only its region of 8 pixels is re-encoded
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    pixels.setPixelColor(r % NUM_PIXELS, grb[0][r % NUM_PIXELS] ^ r);
+    pixels.show();
+  }
+  double onePixel = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  s_Capture = true;
+
+  printf("%d pixels per frame (checksum %08x)\n", NUM_PIXELS, s_Checksum);
+  printf("per-bit encode:        %.0f ns/frame\n", perBit * 1e9 / repeats);
+  printf("paint + show():        %.0f ns/frame (%.1fx)\n",
+         table * 1e9 / repeats, perBit / table);
+  printf("one pixel + show():    %.0f ns/frame\n", onePixel * 1e9 / repeats);
+}
+
+int main() {
+  int failed = 0, total = 0;
+  for (const EncodeCase &c : EncodeCases) {
+    Random rnd(++total);
+    bool ok = c.run(c.name, rnd);
+    printf("%-16s %s\n", c.name, ok ? "ok" : "FAILED");
+    failed += !ok;
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+  Benchmark();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Runs the sensor scan on the host against scripted contacts and prints the
+// lights it publishes. Usage: sensor_sim [scenario], without argument all.
+#include "SensorSim.h"
+#include <cstdio>
+#include <cstring>
+
+static void EpeeDouble() {
+  SensorSim sim(EPEE);
+  sim.runUntil(100000);
+  SensorSim::connect(AL, CL, 20); // left tip
+  sim.runUntil(120000);
+  SensorSim::connect(AR, CR, 20); // right tip, inside the 45 ms lockout
+  sim.runUntil(140000);
+  SensorSim::disconnectAll();
+  sim.runUntil(3000000);
+  sim.printEvents();
+}
+
+static void EpeeTooShort() {
+  SensorSim sim(EPEE);
+  sim.runUntil(100000);
+  SensorSim::connect(AL, CL, 20); // shorter than EpeeContactTime_us
+  sim.runUntil(103000);
+  SensorSim::disconnectAll();
+  sim.runUntil(3000000);
+  sim.printEvents();
+}
+
+static void EpeeOnGuard() {
+  SensorSim sim(EPEE);
+  sim.runUntil(100000);
+  SensorSim::connect(AL, CL, 20);
+  SensorSim::connect(AL, BR, 10); // tip on the opponent's guard
+  sim.runUntil(130000);
+  SensorSim::disconnectAll();
+  sim.runUntil(3000000);
+  sim.printEvents();
+}
+
+static void FoilValidAndOffTarget() {
+  SensorSim sim(FOIL);
+  SensorSim::connect(AL, BL, 5); // tip circuits closed
+  SensorSim::connect(AR, BR, 5);
+  sim.runUntil(100000);
+  SensorSim::disconnect(AL, BL); // left tip pressed on the right lame
+  SensorSim::connect(AL, CR, 50);
+  sim.runUntil(120000);
+  SensorSim::disconnect(AR, BR); // right tip pressed off target
+  sim.runUntil(140000);
+  SensorSim::connect(AL, BL, 5);
+  SensorSim::connect(AR, BR, 5);
+  SensorSim::disconnect(AL, CR);
+  sim.runUntil(3000000);
+  sim.printEvents();
+}
+
+static void SabreHit() {
+  SensorSim sim(SABRE);
+  SensorSim::connect(AL, BL, 5);
+  SensorSim::connect(AR, BR, 5);
+  sim.runUntil(100000);
+  SensorSim::connect(BL, CR, 20); // left blade on the right mask
+  sim.runUntil(101000);
+  SensorSim::disconnect(BL, CR);
+  sim.runUntil(3000000);
+  sim.printEvents();
+}
+
+static const struct {
+  const char *name;
+  void (*run)();
+} Scenarios[] = {
+    {"epee_double", EpeeDouble},
+    {"epee_too_short", EpeeTooShort},
+    {"epee_on_guard", EpeeOnGuard},
+    {"foil_valid_and_off_target", FoilValidAndOffTarget},
+    {"sabre_hit", SabreHit},
+};
+
+int main(int argc, char **argv) {
+  SensorSim::setDefaultThresholds();
+  bool found = false;
+  for (const auto &scenario : Scenarios) {
+    if (argc > 1 && strcmp(argv[1], scenario.name))
+      continue;
+    printf("%s\n", scenario.name);
+    scenario.run();
+    found = true;
+  }
+  if (!found) {
+    fprintf(stderr, "unknown scenario %s\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
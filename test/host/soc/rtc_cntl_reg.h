@@ -0,0 +1,4 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+#pragma once
+
+// Host stand-in: FlashWriteGuard.h includes it, no register is touched
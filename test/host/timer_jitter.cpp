@@ -0,0 +1,212 @@
+// Copyright (c) Piet Wauters 2026 <piet.wauters@gmail.com>
+// Checks that FencingTimer keeps match time however its ticks arrive.
+//
+//   timer_jitter       run all cases
+//
+// Each case runs a 3:00 period on a virtual clock (esp_timer_get_time()),
+// ticking the timer the way the state machine does, every 10 ms, but with
+// ticks jittered, stalled or the clock stopped and restarted. Every tick
+// checks that the running time plus the remaining time is exactly the
+// period, to the microsecond (no drift), and that the display shows the
+// remaining time rounded up. The tick that reaches zero must be the first
+// one at or after the moment the running time adds up to the period.
+#include "FencingTimer.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static int64_t s_Now = 1000000;
+
+int64_t esp_timer_get_time() { return s_Now; }
+
+static constexpr int64_t PERIOD_US = 180000000;
+static constexpr int64_t TICK_US = 10000;
+
+class Random {
+public:
+  explicit Random(uint32_t seed) : m_State(seed * 2654435761u + 1) {}
+  uint32_t next() {
+    m_State ^= m_State << 13;
+    m_State ^= m_State >> 17;
+    m_State ^= m_State << 5;
+    return m_State;
+  }
+  // uniform in [-range, range]
+  int64_t jitter(int64_t range) {
+    return (int64_t)(next() % (2 * range + 1)) - range;
+  }
+
+private:
+  uint32_t m_State;
+};
+
+struct Schedule {
+  int64_t jitter_us;   // each tick interval TICK_US +- this
+  int64_t stall_at_us; // running time of a stall, 0 for none
+  int64_t stall_us;    // ticks missing for this long
+  int pauses;          // stop/start cycles at random running times
+  bool esp_overloads;  // DoTick()/StartTimer()/StopTimer() without nowUs
+};
+
+struct Result {
+  bool ok = true;
+  int64_t ticks = 0;
+  int64_t changes = 0;
+  int64_t max_late_us = 0; // zero shown after the period ran out
+  int64_t paused_us = 0;
+};
+
+static void Fail(Result &r, const char *name, const char *what,
+                 int64_t running, int64_t remaining) {
+  if (r.ok)
+    printf("  %s at %.6f s running: %s (remaining %lld us)\n", name,
+           running / 1e6, what, (long long)remaining);
+  r.ok = false;
+}
+
+// What the display must show for remaining: whole seconds rounded up above
+// 10 s, hundredths rounded up to the resolution below
+static int64_t ShownHundredths(int64_t remaining, int resolution) {
+  int64_t h = (remaining + 9999) / 10000;
+  if (h >= 1000)
+    return (h + 99) / 100 * 100;
+  return (h + resolution - 1) / resolution * resolution;
+}
+
+static Result RunPeriod(const char *name, const Schedule &s, uint32_t seed) {
+  Random rnd(seed);
+  FencingTimer timer;
+  timer.SetMinutes(3);
+  Result r;
+
+  // running time at which each pause starts, and how long it lasts
+  std::vector<int64_t> pauseAt(s.pauses), pauseFor(s.pauses);
+  for (int i = 0; i < s.pauses; i++) {
+    pauseAt[i] = (int64_t)(rnd.next() % 175) * 1000000 + rnd.next() % 1000000;
+    pauseFor[i] = 100000 + rnd.next() % 30000000;
+  }
+  std::sort(pauseAt.begin(), pauseAt.end());
+  int nextPause = 0;
+
+  int64_t running = 0; // time the timer has been running
+  int64_t startedAt = s_Now;
+  if (s.esp_overloads)
+    timer.StartTimer();
+  else
+    timer.StartTimer(s_Now);
+  bool stalled = false;
+  while (true) {
+    int64_t step = TICK_US + (s.jitter_us ? rnd.jitter(s.jitter_us) : 0);
+    if (s.stall_us && !stalled && running + step >= s.stall_at_us) {
+      step += s.stall_us;
+      stalled = true;
+    }
+    // A pause between this tick and the next: stop at the chosen running
+    // time, keep the clock going, start again
+    for (int i = 0; i < s.pauses; i++) {
+      if (pauseAt[i] > running && pauseAt[i] <= running + step &&
+          i >= nextPause) {
+        int64_t before = pauseAt[i] - running;
+        s_Now += before;
+        running += before;
+        step -= before;
+        if (s.esp_overloads)
+          timer.StopTimer();
+        else
+          timer.StopTimer(s_Now);
+        int64_t remaining = timer.GetRemainingUs(s_Now);
+        if (running + remaining != PERIOD_US)
+          Fail(r, name, "stop lost or added time", running, remaining);
+        s_Now += pauseFor[i];
+        r.paused_us += pauseFor[i];
+        if (timer.DoTick(s_Now) || timer.GetRemainingUs(s_Now) != remaining)
+          Fail(r, name, "stopped timer moved", running, remaining);
+        if (s.esp_overloads)
+          timer.StartTimer();
+        else
+          timer.StartTimer(s_Now);
+        nextPause = i + 1;
+      }
+    }
+    s_Now += step;
+    running += step;
+    r.ticks++;
+
+    bool changed = s.esp_overloads ? timer.DoTick() : timer.DoTick(s_Now);
+    r.changes += changed;
+    int64_t remaining = timer.GetRemainingUs(s_Now);
+    int64_t expected = PERIOD_US - running;
+    if (expected < 0)
+      expected = 0;
+    if (remaining != expected)
+      Fail(r, name, "drift: running + remaining != period", running,
+           remaining);
+    int64_t shown = (int64_t)timer.GetMinutes() * 6000 +
+                    timer.GetSeconds() * 100 + timer.GetHundredths();
+    if (shown != ShownHundredths(remaining, 2))
+      Fail(r, name, "display is not the remaining time rounded up", running,
+           remaining);
+    if (timer.ReachedZero()) {
+      r.max_late_us = running - PERIOD_US;
+      if (running < PERIOD_US)
+        Fail(r, name, "zero before the period ran out", running, remaining);
+      if (running - step >= PERIOD_US)
+        Fail(r, name, "zero not on the first tick after the end", running,
+             remaining);
+      if (timer.IsRunning() || !changed)
+        Fail(r, name, "still running at zero", running, remaining);
+      break;
+    }
+    if (running > PERIOD_US + 1000000) {
+      Fail(r, name, "never reached zero", running, remaining);
+      break;
+    }
+  }
+  // wall time = running time + pauses: nothing was lost in the pauses
+  if (s_Now - startedAt != running + r.paused_us)
+    Fail(r, name, "clock and running time disagree", running, 0);
+  return r;
+}
+
+struct TimerCase {
+  const char *name;
+  Schedule schedule;
+  int seeds;
+};
+
+static const TimerCase TimerCases[] = {
+    {"steady_10ms", {0, 0, 0, 0, false}, 1},
+    {"jitter_2ms", {2000, 0, 0, 0, false}, 20},
+    {"stall_300ms", {0, 60000000, 300000, 0, false}, 1},
+    {"stall_300ms_at_9s", {2000, 170950000, 300000, 0, false}, 10},
+    {"stall_near_zero", {2000, 179850000, 300000, 0, false}, 10},
+    {"pauses", {0, 0, 0, 6, false}, 20},
+    {"pauses_jitter_stall", {2000, 100000000, 300000, 6, false}, 20},
+    {"esp_timer_overloads", {2000, 90000000, 300000, 3, true}, 5},
+};
+
+int main() {
+  int failed = 0, total = 0;
+  for (const TimerCase &c : TimerCases) {
+    total++;
+    bool ok = true;
+    int64_t ticks = 0, changes = 0, late = 0, paused = 0;
+    for (int seed = 1; seed <= c.seeds; seed++) {
+      Result r = RunPeriod(c.name, c.schedule, seed);
+      ok &= r.ok;
+      ticks += r.ticks;
+      changes += r.changes;
+      paused += r.paused_us;
+      if (r.max_late_us > late)
+        late = r.max_late_us;
+    }
+    printf("%-22s %s: %d run(s), %lld ticks, %lld display changes, zero at "
+           "most %.1f ms after the end, %.1f s paused\n",
+           c.name, ok ? "ok" : "FAILED", c.seeds, (long long)ticks,
+           (long long)changes, late / 1000.0, paused / 1e6);
+    failed += !ok;
+  }
+  printf("%d of %d cases passed\n", total - failed, total);
+  return failed ? 1 : 0;
+}